@@ -0,0 +1,232 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Churn adaptive update interval benchmark.
+ *
+ * A share of the nodes moves with RandomDirection2d while the others stay in
+ * place.  The IARP bytes sent are counted from the Tx trace, and every second
+ * after the warm-up the zone table of every node is compared against the zone
+ * computed from the node positions.  A known member that is no longer within
+ * the zone radius is stale, a true member that is not known is missing.  The
+ * result is printed as one CSV line:
+ *
+ *   mobileFraction,speed,adaptive,linkState,iarpBytes,stale,missing,meanInterval(s)
+ *
+ * Compare the fixed and the adaptive interval, and the link-state zone
+ * engine, with e.g.
+ *
+ *   for s in 1 5 15; do
+ *     ./waf --run "shingo-churn-bench --speed=$s --adaptive=0"
+ *     ./waf --run "shingo-churn-bench --speed=$s --adaptive=1"
+ *     ./waf --run "shingo-churn-bench --speed=$s --linkState=1"
+ *   done
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoChurnBench");
+
+static NodeContainer g_nodes;
+static double g_range;
+static uint32_t g_zoneRadius;
+static uint64_t g_iarpBytes = 0;
+static uint64_t g_known = 0;
+static uint64_t g_stale = 0;
+static uint64_t g_expected = 0;
+static uint64_t g_missing = 0;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  shingo::TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  if (tHeader.Get () == shingo::SHINGO_IARP || tHeader.Get () == shingo::SHINGO_ZONE_SOLICIT
+      || tHeader.Get () == shingo::SHINGO_NEIGHBOR_SET)
+    {
+      g_iarpBytes += packet->GetSize ();
+    }
+}
+
+static Ipv4Address
+GetAddress (uint32_t n)
+{
+  return g_nodes.Get (n)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+}
+
+static void
+CheckZones ()
+{
+  uint32_t nodes = g_nodes.GetN ();
+  for (uint32_t n = 0; n < nodes; ++n)
+    {
+      // True hop counts up to the zone radius: breadth first search on the unit disk graph
+      std::vector<uint32_t> hops (nodes, 0);
+      std::queue<uint32_t> frontier;
+      frontier.push (n);
+      while (!frontier.empty ())
+        {
+          uint32_t u = frontier.front ();
+          frontier.pop ();
+          if (u != n && hops[u] >= g_zoneRadius)
+            {
+              continue;
+            }
+          Ptr<MobilityModel> mu = g_nodes.Get (u)->GetObject<MobilityModel> ();
+          for (uint32_t v = 0; v < nodes; ++v)
+            {
+              if (v == n || hops[v] != 0)
+                {
+                  continue;
+                }
+              if (mu->GetDistanceFrom (g_nodes.Get (v)->GetObject<MobilityModel> ()) <= g_range)
+                {
+                  hops[v] = hops[u] + 1;
+                  frontier.push (v);
+                }
+            }
+        }
+      Ptr<shingo::RoutingProtocol> routing = g_nodes.Get (n)->GetObject<shingo::RoutingProtocol> ();
+      for (uint32_t v = 0; v < nodes; ++v)
+        {
+          if (v == n)
+            {
+              continue;
+            }
+          bool known = routing->GetZoneHopCount (GetAddress (v)) != 0;
+          if (known)
+            {
+              g_known++;
+              if (hops[v] == 0)
+                {
+                  g_stale++;
+                }
+            }
+          if (hops[v] != 0)
+            {
+              g_expected++;
+              if (!known)
+                {
+                  g_missing++;
+                }
+            }
+        }
+    }
+  Simulator::Schedule (Seconds (1), &CheckZones);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 60;
+  double areaPerNode = 2500; // m^2
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  double mobileFraction = 0.5;
+  double speed = 5;
+  bool adaptive = false;
+  bool linkState = false;
+  double warmUp = 30;
+  double simTime = 300;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("areaPerNode", "Area per node in square meters", areaPerNode);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Zone radius in hops", zoneRadius);
+  cmd.AddValue ("mobileFraction", "Share of the nodes that move", mobileFraction);
+  cmd.AddValue ("speed", "Speed of the mobile nodes in m/s", speed);
+  cmd.AddValue ("adaptive", "Enable the churn adaptive periodic update interval", adaptive);
+  cmd.AddValue ("linkState", "Use the link-state zone engine instead of IARP", linkState);
+  cmd.AddValue ("warmUp", "Time before the zone tables are checked in seconds", warmUp);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+  g_range = range;
+  g_zoneRadius = zoneRadius;
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  uint32_t mobile = std::floor (nodes * mobileFraction);
+  NodeContainer fixed;
+  NodeContainer moving;
+  fixed.Create (nodes - mobile);
+  moving.Create (mobile);
+  g_nodes.Add (fixed);
+  g_nodes.Add (moving);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, g_nodes);
+
+  double side = std::sqrt (nodes * areaPerNode);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0|Max=" << side << "]";
+  std::ostringstream velocity;
+  velocity << "ns3::ConstantRandomVariable[Constant=" << speed << "]";
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue (bound.str ()),
+                                 "Y", StringValue (bound.str ()));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (fixed);
+  mobility.SetMobilityModel ("ns3::RandomDirection2dMobilityModel",
+                             "Bounds", RectangleValue (Rectangle (0, side, 0, side)),
+                             "Speed", StringValue (velocity.str ()),
+                             "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.3]"));
+  mobility.Install (moving);
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("EnableAdaptiveUpdateInterval", BooleanValue (adaptive));
+  shingo.SetAttribute ("ZoneEngine", EnumValue (linkState ? shingo::ZONE_ENGINE_LINK_STATE : shingo::ZONE_ENGINE_IARP));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (g_nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+
+  Simulator::Schedule (Seconds (warmUp), &CheckZones);
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+  double meanInterval = 0;
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      meanInterval += g_nodes.Get (i)->GetObject<shingo::RoutingProtocol> ()->GetPeriodicUpdateInterval ().GetSeconds ();
+    }
+  meanInterval /= nodes;
+  Simulator::Destroy ();
+
+  std::cout << mobileFraction << "," << speed << "," << adaptive << "," << linkState << "," << g_iarpBytes << ","
+            << (g_known ? double (g_stale) / g_known : 0) << ","
+            << (g_expected ? double (g_missing) / g_expected : 0) << "," << meanInterval << std::endl;
+  return 0;
+}
@@ -0,0 +1,240 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Congestion benchmark.
+ *
+ * As in test.cc, node 0 is a sink at the center of a disc of static nodes
+ * and every source sends a CBR flow to it, so that the nodes around the
+ * sink carry every flow.  With load balancing every node advertises how
+ * full its MAC queue and its routing buffers are in its IARP updates; a
+ * busy neighbor costs more in the link metric, so that the routes go
+ * through idle neighbors of paths as short, and a busy node re-broadcasts
+ * the RREQs late, so that the copies over idle nodes win the discovery.
+ * The sending time of every data packet gives its end to end delay; the
+ * throughput counts the payload received after the warm-up.  The result is
+ * printed as one CSV line:
+ *
+ *   nodes,sources,loadBalancing,multipath,sent,received,pdr,throughput(kbps),delay(ms),p95Delay(ms),p99Delay(ms),rreqTx
+ *
+ * Compare the throughput and the tail delay with and without load
+ * balancing as the sources add up, e.g.
+ *
+ *   for s in 6 10 20 30 40 50; do
+ *     ./waf --run "shingo-load-bench --sources=$s --loadBalancing=0"
+ *     ./waf --run "shingo-load-bench --sources=$s --loadBalancing=1"
+ *     ./waf --run "shingo-load-bench --sources=$s --loadBalancing=1 --multipath=1"
+ *   done
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoLoadBench");
+
+static uint32_t g_rreqTx = 0;
+static uint32_t g_sent = 0;
+static uint32_t g_received = 0;
+static uint64_t g_receivedBytes = 0;
+static std::map<uint64_t, Time> g_sendTime;
+static std::vector<double> g_delays;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  shingo::TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  if (tHeader.Get () == shingo::SHINGO_RREQ)
+    {
+      g_rreqTx++;
+    }
+}
+
+static void
+GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval)
+{
+  if (pktCount > 0)
+    {
+      Ptr<Packet> packet = Create<Packet> (pktSize);
+      g_sendTime[packet->GetUid ()] = Simulator::Now ();
+      socket->Send (packet);
+      g_sent++;
+      Simulator::Schedule (pktInterval, &GenerateTraffic, socket, pktSize, pktCount - 1, pktInterval);
+    }
+  else
+    {
+      socket->Close ();
+    }
+}
+
+static void
+ReceivePacket (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      std::map<uint64_t, Time>::iterator i = g_sendTime.find (packet->GetUid ());
+      if (i == g_sendTime.end ())
+        {
+          continue;
+        }
+      g_received++;
+      g_receivedBytes += packet->GetSize ();
+      g_delays.push_back ((Simulator::Now () - i->second).GetSeconds () * 1000);
+      g_sendTime.erase (i);
+    }
+}
+
+/**
+ * \param delays the sorted delays
+ * \param q the quantile
+ * \returns the delay the fraction q of the delays is at most
+ */
+static double
+Quantile (std::vector<double> const & delays, double q)
+{
+  if (delays.empty ())
+    {
+      return 0;
+    }
+  return delays[std::min<size_t> (delays.size () - 1, size_t (q * delays.size ()))];
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 100;
+  double radius = 310;
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  uint32_t sources = 6;
+  bool loadBalancing = false;
+  bool multipath = false;
+  uint32_t packetSize = 512;
+  double interval = 0.25;
+  double warmUp = 20;
+  double simTime = 120;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes, the sink included", nodes);
+  cmd.AddValue ("radius", "Radius of the disc around the sink in meters", radius);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Zone radius in hops", zoneRadius);
+  cmd.AddValue ("sources", "Number of concurrent CBR sources sending to the sink", sources);
+  cmd.AddValue ("loadBalancing", "Steer the routes and the route discoveries around busy nodes", loadBalancing);
+  cmd.AddValue ("multipath", "Spread the flows over several paths", multipath);
+  cmd.AddValue ("packetSize", "Data packet size in bytes", packetSize);
+  cmd.AddValue ("interval", "Interval between data packets in seconds", interval);
+  cmd.AddValue ("warmUp", "Time before the flows start in seconds", warmUp);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+  sources = std::min (sources, nodes - 1);
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  NodeContainer n;
+  n.Create (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, n);
+
+  // The sink at the center, the other nodes around it
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> center = CreateObject<ListPositionAllocator> ();
+  center->Add (Vector (radius, radius, 0));
+  mobility.SetPositionAllocator (center);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (n.Get (0));
+  std::ostringstream x;
+  x << radius;
+  std::ostringstream rho;
+  rho << "ns3::UniformRandomVariable[Min=11|Max=" << radius << "]";
+  mobility.SetPositionAllocator ("ns3::RandomDiscPositionAllocator",
+                                 "X", StringValue (x.str ()),
+                                 "Y", StringValue (x.str ()),
+                                 "Rho", StringValue (rho.str ()));
+  for (uint32_t i = 1; i < nodes; ++i)
+    {
+      mobility.Install (n.Get (i));
+    }
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("EnableLoadBalancing", BooleanValue (loadBalancing));
+  shingo.SetAttribute ("EnableMultipath", BooleanValue (multipath));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (n);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Socket> sink = Socket::CreateSocket (n.Get (0), tid);
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&ReceivePacket));
+
+  // Distinct random sources for the whole run after the warm-up
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable> ();
+  std::vector<uint32_t> candidates;
+  for (uint32_t i = 1; i < nodes; ++i)
+    {
+      candidates.push_back (i);
+    }
+  uint32_t packetsPerFlow = (simTime - warmUp - 5) / interval;
+  for (uint32_t f = 0; f < sources; ++f)
+    {
+      uint32_t k = pick->GetInteger (f, candidates.size () - 1);
+      std::swap (candidates[f], candidates[k]);
+      uint32_t src = candidates[f];
+      Ptr<Socket> source = Socket::CreateSocket (n.Get (src), tid);
+      source->Connect (InetSocketAddress (interfaces.GetAddress (0), 9));
+      Simulator::ScheduleWithContext (src, Seconds (warmUp + pick->GetValue (0, 1)), &GenerateTraffic,
+                                      source, packetSize, packetsPerFlow, Seconds (interval));
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::sort (g_delays.begin (), g_delays.end ());
+  double delay = 0;
+  for (std::vector<double>::const_iterator i = g_delays.begin (); i != g_delays.end (); ++i)
+    {
+      delay += *i;
+    }
+  std::cout << nodes << "," << sources << "," << loadBalancing << "," << multipath << "," << g_sent << "," << g_received << ","
+            << (g_sent ? double (g_received) / g_sent : 0) << ","
+            << g_receivedBytes * 8 / (simTime - warmUp) / 1000 << ","
+            << (g_delays.empty () ? 0 : delay / g_delays.size ()) << ","
+            << Quantile (g_delays, 0.95) << "," << Quantile (g_delays, 0.99) << "," << g_rreqTx << std::endl;
+  return 0;
+}
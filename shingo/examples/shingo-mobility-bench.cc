@@ -0,0 +1,274 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Route maintenance benchmark.
+ *
+ * Every node moves with RandomDirection2d while long CBR flows run between
+ * random pairs, so that the IERP routes of the flows break while they are
+ * in use.  Without route errors, a source keeps sending into a route whose
+ * next hop left until the route times out, and the MAC drops every packet;
+ * with them, the node upstream of the break tells the precursors of the
+ * route, the source invalidates it and discovers a new one.  With local
+ * repair the node upstream of the break buffers the packets and looks for a
+ * new route with a small ring RREQ first.  The hellos find the lost
+ * neighbors, the next hops of idle routes and the zone neighbors included,
+ * within AllowedHelloLoss hello intervals.  With link quality the routes
+ * go over the links whose broadcasts, hellos included, got through best
+ * instead of the fewest hops.  With link expiration the hellos advertise
+ * the motion of the nodes and a source looks for a new route before the
+ * first link of its route leaves the range.  The RERRs, RREQs and hellos sent
+ * are counted from the Tx trace.  A gap of more than two packet intervals
+ * between the packets a flow delivers is an outage; its length less one
+ * interval is the recovery latency of the flow.  The LocalRepair trace gives
+ * the local repairs, those that found a route and how long these took.  The
+ * result is printed as one CSV line:
+ *
+ *   nodes,speed,routeErrors,localRepair,hello,linkQuality,linkExpiration,routeRefresh,multipath,sent,
+ *   received,pdr,rerrTx,rreqTx,helloTx,outages,recovery(ms),repairs,repaired,repairDelay(ms)
+ *
+ * The packets the route errors saved from the broken routes are the
+ * difference of the received packets with and without them, e.g.
+ *
+ *   for s in 1 5 10 20; do
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=0 --localRepair=0"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=0"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=1"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=1 --hello=0"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=1 --linkQuality=1"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=1 --linkExpiration=1"
+ *     ./waf --run "shingo-mobility-bench --speed=$s --routeErrors=1 --localRepair=1 --multipath=1"
+ *   done
+ *
+ * The sources refresh the routes of their flows before these expire unless
+ * --routeRefresh=0; the flows only stall on expired routes when their packets
+ * are further apart than ActiveRouteTimeout, e.g. --interval=4.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoMobilityBench");
+
+static uint32_t g_rerrTx = 0;
+static uint32_t g_rreqTx = 0;
+static uint32_t g_helloTx = 0;
+static uint32_t g_sent = 0;
+static uint32_t g_received = 0;
+static double g_interval;
+static std::vector<Time> g_lastReceived;
+static uint32_t g_outages = 0;
+static double g_recovery = 0;
+static uint32_t g_repairs = 0;
+static uint32_t g_repaired = 0;
+static double g_repairDelay = 0;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  shingo::TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  if (tHeader.Get () == shingo::SHINGO_RERR)
+    {
+      g_rerrTx++;
+    }
+  else if (tHeader.Get () == shingo::SHINGO_RREQ)
+    {
+      g_rreqTx++;
+    }
+  else if (tHeader.Get () == shingo::SHINGO_RREP)
+    {
+      Ptr<Packet> copy = packet->Copy ();
+      copy->RemoveHeader (tHeader);
+      shingo::RrepHeader rrepHeader;
+      copy->PeekHeader (rrepHeader);
+      if (rrepHeader.GetDst () == rrepHeader.GetOrigin ())
+        {
+          g_helloTx++;
+        }
+    }
+}
+
+static void
+LocalRepair (Ipv4Address /*dst*/, Time delay, bool repaired)
+{
+  g_repairs++;
+  if (repaired)
+    {
+      g_repaired++;
+      g_repairDelay += delay.GetMilliSeconds ();
+    }
+}
+
+static void
+GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval)
+{
+  if (pktCount > 0)
+    {
+      socket->Send (Create<Packet> (pktSize));
+      g_sent++;
+      Simulator::Schedule (pktInterval, &GenerateTraffic, socket, pktSize, pktCount - 1, pktInterval);
+    }
+  else
+    {
+      socket->Close ();
+    }
+}
+
+static void
+ReceivePacket (uint32_t flow, Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+      Time gap = Simulator::Now () - g_lastReceived[flow];
+      if (!g_lastReceived[flow].IsNegative () && gap > Seconds (2 * g_interval))
+        {
+          g_outages++;
+          g_recovery += (gap - Seconds (g_interval)).GetMilliSeconds ();
+        }
+      g_lastReceived[flow] = Simulator::Now ();
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 50;
+  double areaPerNode = 2500; // m^2
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  double speed = 5;
+  bool routeErrors = true;
+  bool localRepair = true;
+  bool hello = true;
+  bool linkQuality = false;
+  bool linkExpiration = false;
+  bool routeRefresh = true;
+  bool multipath = false;
+  uint32_t flows = 10;
+  uint32_t packetSize = 512;
+  double interval = 0.25;
+  double warmUp = 20;
+  double simTime = 200;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("areaPerNode", "Area per node in square meters", areaPerNode);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Zone radius in hops", zoneRadius);
+  cmd.AddValue ("speed", "Speed of the nodes in m/s", speed);
+  cmd.AddValue ("routeErrors", "Send RERRs to the precursors of the routes a link break cuts", routeErrors);
+  cmd.AddValue ("localRepair", "Repair the broken routes of the other nodes with a small ring RREQ", localRepair);
+  cmd.AddValue ("hello", "Detect the lost neighbors with hello messages", hello);
+  cmd.AddValue ("linkQuality", "Select the routes by the ETX of their links instead of their hop count", linkQuality);
+  cmd.AddValue ("linkExpiration", "Replace the routes before their links are predicted to leave the range", linkExpiration);
+  cmd.AddValue ("routeRefresh", "Look for a new route for the active flows before their route expires", routeRefresh);
+  cmd.AddValue ("multipath", "Spread the flows over several paths and fail over to them on a link break", multipath);
+  cmd.AddValue ("flows", "Number of CBR flows", flows);
+  cmd.AddValue ("packetSize", "Data packet size in bytes", packetSize);
+  cmd.AddValue ("interval", "Interval between data packets in seconds", interval);
+  cmd.AddValue ("warmUp", "Time before the flows start in seconds", warmUp);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+  g_interval = interval;
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  NodeContainer n;
+  n.Create (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, n);
+
+  double side = std::sqrt (nodes * areaPerNode);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0|Max=" << side << "]";
+  std::ostringstream velocity;
+  velocity << "ns3::ConstantRandomVariable[Constant=" << speed << "]";
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue (bound.str ()),
+                                 "Y", StringValue (bound.str ()));
+  mobility.SetMobilityModel ("ns3::RandomDirection2dMobilityModel",
+                             "Bounds", RectangleValue (Rectangle (0, side, 0, side)),
+                             "Speed", StringValue (velocity.str ()),
+                             "Pause", StringValue ("ns3::ConstantRandomVariable[Constant=0.3]"));
+  mobility.Install (n);
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("EnableRouteErrors", BooleanValue (routeErrors));
+  shingo.SetAttribute ("EnableLocalRepair", BooleanValue (localRepair));
+  shingo.SetAttribute ("EnableHello", BooleanValue (hello));
+  shingo.SetAttribute ("EnableLinkQuality", BooleanValue (linkQuality));
+  shingo.SetAttribute ("EnableLinkExpiration", BooleanValue (linkExpiration));
+  shingo.SetAttribute ("TransmissionRange", DoubleValue (range));
+  shingo.SetAttribute ("EnableRouteRefresh", BooleanValue (routeRefresh));
+  shingo.SetAttribute ("EnableMultipath", BooleanValue (multipath));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (n);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/LocalRepair", MakeCallback (&LocalRepair));
+
+  // Flows between random pairs for the whole run after the warm-up
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable> ();
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  uint32_t packetsPerFlow = (simTime - warmUp - 5) / interval;
+  g_lastReceived.resize (flows, Seconds (-1));
+  for (uint32_t f = 0; f < flows; ++f)
+    {
+      uint32_t src = pick->GetInteger (0, nodes - 1);
+      uint32_t dst = pick->GetInteger (0, nodes - 1);
+      if (src == dst)
+        {
+          dst = (dst + 1) % nodes;
+        }
+      Ptr<Socket> sink = Socket::CreateSocket (n.Get (dst), tid);
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9 + f));
+      sink->SetRecvCallback (MakeBoundCallback (&ReceivePacket, f));
+      Ptr<Socket> source = Socket::CreateSocket (n.Get (src), tid);
+      source->Connect (InetSocketAddress (interfaces.GetAddress (dst), 9 + f));
+      Simulator::ScheduleWithContext (src, Seconds (warmUp + pick->GetValue (0, 1)), &GenerateTraffic,
+                                      source, packetSize, packetsPerFlow, Seconds (interval));
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << nodes << "," << speed << "," << routeErrors << "," << localRepair << "," << hello << "," << linkQuality << "," << linkExpiration << "," << routeRefresh << "," << multipath << "," << g_sent << "," << g_received << ","
+            << (g_sent ? double (g_received) / g_sent : 0) << "," << g_rerrTx << "," << g_rreqTx << "," << g_helloTx << ","
+            << g_outages << "," << (g_outages ? g_recovery / g_outages : 0) << ","
+            << g_repairs << "," << g_repaired << "," << (g_repaired ? g_repairDelay / g_repaired : 0) << std::endl;
+  return 0;
+}
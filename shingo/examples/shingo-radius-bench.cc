@@ -0,0 +1,193 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Zone radius benchmark.
+ *
+ * Random static nodes exchange CBR flows between random pairs.  The control
+ * bytes sent by the protocol are split into IARP (zone maintenance), RREQ and
+ * other IERP messages and printed with the packet delivery ratio as one CSV
+ * line:
+ *
+ *   areaPerNode,zoneRadius,adaptive,iarpBytes,rreqBytes,otherBytes,pdr,meanRadius
+ *
+ * Sweep the radius against the density with e.g.
+ *
+ *   for a in 1000 2500 6000; do
+ *     for r in 0 1 2 3 4; do
+ *       ./waf --run "shingo-radius-bench --areaPerNode=$a --zoneRadius=$r"
+ *     done
+ *     ./waf --run "shingo-radius-bench --areaPerNode=$a --adaptive=1"
+ *   done
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <cmath>
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoRadiusBench");
+
+static uint64_t g_iarpBytes = 0;
+static uint64_t g_rreqBytes = 0;
+static uint64_t g_otherBytes = 0;
+static uint32_t g_sent = 0;
+static uint32_t g_received = 0;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  shingo::TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  switch (tHeader.Get ())
+    {
+    case shingo::SHINGO_IARP:
+    case shingo::SHINGO_ZONE_SOLICIT:
+    case shingo::SHINGO_NEIGHBOR_SET:
+      g_iarpBytes += packet->GetSize ();
+      break;
+    case shingo::SHINGO_RREQ:
+      g_rreqBytes += packet->GetSize ();
+      break;
+    default:
+      g_otherBytes += packet->GetSize ();
+    }
+}
+
+static void
+GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval)
+{
+  if (pktCount > 0)
+    {
+      socket->Send (Create<Packet> (pktSize));
+      g_sent++;
+      Simulator::Schedule (pktInterval, &GenerateTraffic, socket, pktSize, pktCount - 1, pktInterval);
+    }
+  else
+    {
+      socket->Close ();
+    }
+}
+
+static void
+ReceivePacket (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 100;
+  double areaPerNode = 2500; // m^2
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  bool adaptive = false;
+  uint32_t flows = 10;
+  uint32_t packetSize = 512;
+  double interval = 0.5;
+  double simTime = 60;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("areaPerNode", "Area per node in square meters", areaPerNode);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Initial zone radius in hops", zoneRadius);
+  cmd.AddValue ("adaptive", "Enable the adaptive zone radius", adaptive);
+  cmd.AddValue ("flows", "Number of CBR flows", flows);
+  cmd.AddValue ("packetSize", "Data packet size in bytes", packetSize);
+  cmd.AddValue ("interval", "Interval between data packets in seconds", interval);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  NodeContainer n;
+  n.Create (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, n);
+
+  double side = std::sqrt (nodes * areaPerNode);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0|Max=" << side << "]";
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue (bound.str ()),
+                                 "Y", StringValue (bound.str ()));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (n);
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("EnableAdaptiveZoneRadius", BooleanValue (adaptive));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (n);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+
+  // Flows between random pairs, started after the first zone exchanges
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable> ();
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  uint32_t pktCount = (simTime - 10) / interval;
+  for (uint32_t f = 0; f < flows; ++f)
+    {
+      uint32_t src = pick->GetInteger (0, nodes - 1);
+      uint32_t dst = pick->GetInteger (0, nodes - 1);
+      if (src == dst)
+        {
+          dst = (dst + 1) % nodes;
+        }
+      Ptr<Socket> sink = Socket::CreateSocket (n.Get (dst), tid);
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9 + f));
+      sink->SetRecvCallback (MakeCallback (&ReceivePacket));
+      Ptr<Socket> source = Socket::CreateSocket (n.Get (src), tid);
+      source->Connect (InetSocketAddress (interfaces.GetAddress (dst), 9 + f));
+      Simulator::ScheduleWithContext (src, Seconds (5 + pick->GetValue (0, 1)), &GenerateTraffic,
+                                      source, packetSize, pktCount, Seconds (interval));
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+
+  double meanRadius = 0;
+  for (uint32_t i = 0; i < nodes; ++i)
+    {
+      meanRadius += n.Get (i)->GetObject<shingo::RoutingProtocol> ()->GetZoneRadius ();
+    }
+  meanRadius /= nodes;
+  Simulator::Destroy ();
+
+  std::cout << areaPerNode << "," << zoneRadius << "," << adaptive << ","
+            << g_iarpBytes << "," << g_rreqBytes << "," << g_otherBytes << ","
+            << (g_sent ? double (g_received) / g_sent : 0) << "," << meanRadius << std::endl;
+  return 0;
+}
@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Route discovery benchmark.
+ *
+ * Random static nodes start short CBR flows between random pairs at random
+ * times, so that most flows need a route discovery beyond the zone.  Every
+ * RREQ sent is counted from the Tx trace; a RREQ with hop count 0 is a
+ * discovery started by its origin, the others are relays.  The Rx trace
+ * gives the share of the other nodes each discovery reached.  Every ring of
+ * the expanding ring search is a discovery of its own, so rreqPerFlow gives
+ * the cost of finding a route.  The delay from the start of a flow to its
+ * first packet received measures the route discovery latency; laterDelay
+ * only counts the flows to a destination an earlier flow already used.
+ * With --sink every flow goes to node 0, and with --sinkTree node 0 also
+ * roots the collection tree, whose beacons are counted in beaconTx.  With
+ * --sinks=N every flow goes to an anycast group of nodes 0 to N-1 and is
+ * delivered to the nearest of them.  --rreqDestinations bounds the
+ * destinations one RREQ asks for, 1 sends a RREQ per destination, and
+ * --requestMerging lets the relays hold the RREQs for a destination another
+ * discovery looks for.  The result is printed as one CSV line:
+ *
+ *   nodes,areaPerNode,zoneRadius,dissemination,queryDetection,zoneRing,proxyReply,routeCache,sink,sinkTree,sinks,rreqDestinations,requestMerging,
+ *   discoveries,rreqTx,rreqPerDiscovery,rreqPerFlow,reach,pdr,firstPacketDelay(ms),laterDelay(ms),beaconTx
+ *
+ * Compare query detection, bordercasting, multipoint relays and gossip
+ * against plain flooding of the RREQs with e.g.
+ *
+ *   for r in 1 2 3; do
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --queryDetection=0"
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --queryDetection=1"
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --dissemination=Bordercast"
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --dissemination=Mpr"
+ *   done
+ *   for r in 1 2 3; do
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --zoneRing=0"
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --zoneRing=1"
+ *   done
+ *   for r in 1 2 3; do
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --proxyReply=0"
+ *     ./waf --run "shingo-rreq-bench --zoneRadius=$r --proxyReply=1"
+ *   done
+ *   ./waf --run "shingo-rreq-bench --sink=1 --routeCache=0"
+ *   ./waf --run "shingo-rreq-bench --sink=1 --routeCache=1"
+ *   ./waf --run "shingo-rreq-bench --sink=1 --sinkTree=1"
+ *   for s in 1 2 4; do
+ *     ./waf --run "shingo-rreq-bench --sinks=$s"
+ *   done
+ *   ./waf --run "shingo-rreq-bench --flows=200 --rreqDestinations=1"
+ *   ./waf --run "shingo-rreq-bench --flows=200 --rreqDestinations=8"
+ *   ./waf --run "shingo-rreq-bench --sink=1 --routeCache=0 --requestMerging=0"
+ *   ./waf --run "shingo-rreq-bench --sink=1 --routeCache=0 --requestMerging=1"
+ *   for a in 1000 2500 6000; do
+ *     ./waf --run "shingo-rreq-bench --areaPerNode=$a --dissemination=Gossip"
+ *     ./waf --run "shingo-rreq-bench --areaPerNode=$a --dissemination=Gossip --gossipNeighbors=6"
+ *   done
+ *
+ * --nodes=576 --areaPerNode=525 gives about the density of the 576 node
+ * field of test.cc.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoRreqBench");
+
+static NodeContainer g_nodes;
+static std::map<std::pair<Ipv4Address, uint32_t>, std::set<uint32_t> > g_reached;
+static uint32_t g_discoveries = 0;
+static uint32_t g_rreqTx = 0;
+static uint32_t g_beaconTx = 0;
+static uint32_t g_sent = 0;
+static uint32_t g_received = 0;
+static std::vector<Time> g_flowStart;
+static std::vector<Time> g_firstReceived;
+static std::vector<uint32_t> g_flowDst;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  shingo::TypeHeader tHeader;
+  copy->RemoveHeader (tHeader);
+  if (tHeader.Get () == shingo::SHINGO_SINK_BEACON)
+    {
+      g_beaconTx++;
+    }
+  if (tHeader.Get () != shingo::SHINGO_RREQ)
+    {
+      return;
+    }
+  shingo::RreqHeader rreqHeader;
+  copy->PeekHeader (rreqHeader);
+  g_rreqTx++;
+  if (rreqHeader.GetHopCount () == 0)
+    {
+      g_discoveries++;
+      g_reached[std::make_pair (rreqHeader.GetOrigin (), rreqHeader.GetId ())];
+    }
+}
+
+static void
+ControlRx (std::string context, Ptr<const Packet> packet)
+{
+  Ptr<Packet> copy = packet->Copy ();
+  shingo::TypeHeader tHeader;
+  copy->RemoveHeader (tHeader);
+  if (tHeader.Get () != shingo::SHINGO_RREQ)
+    {
+      return;
+    }
+  shingo::RreqHeader rreqHeader;
+  copy->PeekHeader (rreqHeader);
+  std::map<std::pair<Ipv4Address, uint32_t>, std::set<uint32_t> >::iterator i =
+    g_reached.find (std::make_pair (rreqHeader.GetOrigin (), rreqHeader.GetId ()));
+  // "/NodeList/<id>/..."
+  uint32_t node = std::atoi (context.c_str () + 10);
+  if (i != g_reached.end ()
+      && g_nodes.Get (node)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal () != rreqHeader.GetOrigin ())
+    {
+      i->second.insert (node);
+    }
+}
+
+static void
+GenerateTraffic (Ptr<Socket> socket, uint32_t pktSize, uint32_t pktCount, Time pktInterval)
+{
+  if (pktCount > 0)
+    {
+      socket->Send (Create<Packet> (pktSize));
+      g_sent++;
+      Simulator::Schedule (pktInterval, &GenerateTraffic, socket, pktSize, pktCount - 1, pktInterval);
+    }
+  else
+    {
+      socket->Close ();
+    }
+}
+
+static void
+ReceivePacket (uint32_t flow, Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    {
+      g_received++;
+      if (g_firstReceived[flow].IsNegative ())
+        {
+          g_firstReceived[flow] = Simulator::Now ();
+        }
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 100;
+  double areaPerNode = 2500; // m^2
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  std::string dissemination ("Flood");
+  bool queryDetection = true;
+  uint32_t gossipNeighbors = 0;
+  bool zoneRing = true;
+  bool proxyReply = true;
+  bool routeCache = true;
+  bool sinkOnly = false;
+  bool sinkTree = false;
+  uint32_t sinks = 0;
+  uint32_t rreqDestinations = 8;
+  bool requestMerging = true;
+  uint32_t flows = 40;
+  uint32_t packetsPerFlow = 5;
+  uint32_t packetSize = 512;
+  double interval = 0.5;
+  double simTime = 120;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("areaPerNode", "Area per node in square meters", areaPerNode);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Zone radius in hops", zoneRadius);
+  cmd.AddValue ("dissemination", "RREQ dissemination: Flood, Bordercast, Mpr or Gossip", dissemination);
+  cmd.AddValue ("queryDetection", "Enable query detection", queryDetection);
+  cmd.AddValue ("gossipNeighbors", "Neighbor count beyond which a gossiping node re-broadcasts with a probability", gossipNeighbors);
+  cmd.AddValue ("zoneRing", "Start the expanding ring search beyond the zone", zoneRing);
+  cmd.AddValue ("proxyReply", "Answer RREQs for destinations in the zone", proxyReply);
+  cmd.AddValue ("routeCache", "Keep the routes to the hot destinations to answer RREQs", routeCache);
+  cmd.AddValue ("sink", "Send every flow to node 0", sinkOnly);
+  cmd.AddValue ("sinkTree", "Root the collection tree at node 0", sinkTree);
+  cmd.AddValue ("sinks", "Send every flow to an anycast group of nodes 0 to sinks-1; 0 disables anycast", sinks);
+  cmd.AddValue ("rreqDestinations", "Maximum number of destinations one RREQ asks for", rreqDestinations);
+  cmd.AddValue ("requestMerging", "Hold the RREQs for a destination another relayed discovery looks for", requestMerging);
+  cmd.AddValue ("flows", "Number of CBR flows", flows);
+  cmd.AddValue ("packetsPerFlow", "Number of data packets per flow", packetsPerFlow);
+  cmd.AddValue ("packetSize", "Data packet size in bytes", packetSize);
+  cmd.AddValue ("interval", "Interval between data packets in seconds", interval);
+  cmd.AddValue ("simTime", "Simulation time in seconds", simTime);
+  cmd.Parse (argc, argv);
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  NodeContainer n;
+  n.Create (nodes);
+  g_nodes = n;
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, n);
+
+  double side = std::sqrt (nodes * areaPerNode);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0|Max=" << side << "]";
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue (bound.str ()),
+                                 "Y", StringValue (bound.str ()));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (n);
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("RreqDissemination", StringValue (dissemination));
+  shingo.SetAttribute ("EnableQueryDetection", BooleanValue (queryDetection));
+  shingo.SetAttribute ("GossipNeighbors", UintegerValue (gossipNeighbors));
+  shingo.SetAttribute ("EnableZoneRing", BooleanValue (zoneRing));
+  shingo.SetAttribute ("EnableProxyReply", BooleanValue (proxyReply));
+  shingo.SetAttribute ("EnableRouteCache", BooleanValue (routeCache));
+  shingo.SetAttribute ("MaxRreqDestinations", UintegerValue (rreqDestinations));
+  shingo.SetAttribute ("EnableRequestMerging", BooleanValue (requestMerging));
+  if (sinkTree)
+    {
+      // The first address the helper below assigns
+      shingo.SetAttribute ("Sink", Ipv4AddressValue (Ipv4Address ("10.0.0.1")));
+    }
+  // A group address outside the range the helper below assigns
+  Ipv4Address group ("10.0.255.254");
+  if (sinks > 0)
+    {
+      std::ostringstream members;
+      for (uint32_t s = 0; s < sinks; ++s)
+        {
+          members << "10.0.0." << s + 1 << " ";
+        }
+      shingo.SetAttribute ("AnycastGroup", Ipv4AddressValue (group));
+      shingo.SetAttribute ("AnycastMembers", StringValue (members.str ()));
+    }
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (n);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+  Config::Connect ("/NodeList/*/$ns3::shingo::RoutingProtocol/Rx", MakeCallback (&ControlRx));
+
+  // Short flows between random pairs, spread over the run once the zones are built
+  Ptr<UniformRandomVariable> pick = CreateObject<UniformRandomVariable> ();
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  double last = simTime - packetsPerFlow * interval - 5;
+  g_flowStart.resize (flows);
+  g_firstReceived.resize (flows, Seconds (-1));
+  g_flowDst.resize (flows);
+  for (uint32_t f = 0; f < flows; ++f)
+    {
+      uint32_t src = pick->GetInteger (sinks, nodes - 1);
+      uint32_t dst = sinkOnly || sinks > 0 ? 0 : pick->GetInteger (0, nodes - 1);
+      if (src == dst)
+        {
+          src = (src + 1) % nodes;
+        }
+      g_flowDst[f] = dst;
+      // Every member of the anycast group listens to every flow
+      for (uint32_t s = dst; s == dst || s < sinks; ++s)
+        {
+          Ptr<Socket> sink = Socket::CreateSocket (n.Get (s), tid);
+          sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9 + f));
+          sink->SetRecvCallback (MakeBoundCallback (&ReceivePacket, f));
+        }
+      Ptr<Socket> source = Socket::CreateSocket (n.Get (src), tid);
+      source->Connect (InetSocketAddress (sinks > 0 ? group : interfaces.GetAddress (dst), 9 + f));
+      g_flowStart[f] = Seconds (pick->GetValue (20, last));
+      Simulator::ScheduleWithContext (src, g_flowStart[f], &GenerateTraffic,
+                                      source, packetSize, packetsPerFlow, Seconds (interval));
+    }
+
+  Simulator::Stop (Seconds (simTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double reach = 0;
+  for (std::map<std::pair<Ipv4Address, uint32_t>, std::set<uint32_t> >::const_iterator i = g_reached.begin ();
+       i != g_reached.end (); ++i)
+    {
+      reach += double (i->second.size ()) / (nodes - 1);
+    }
+  double firstPacketDelay = 0;
+  uint32_t reachedFlows = 0;
+  double laterDelay = 0;
+  uint32_t laterFlows = 0;
+  for (uint32_t f = 0; f < flows; ++f)
+    {
+      if (g_firstReceived[f].IsNegative ())
+        {
+          continue;
+        }
+      double delay = (g_firstReceived[f] - g_flowStart[f]).GetMilliSeconds ();
+      firstPacketDelay += delay;
+      reachedFlows++;
+      bool later = false;
+      for (uint32_t e = 0; e < flows && !later; ++e)
+        {
+          later = g_flowDst[e] == g_flowDst[f] && g_flowStart[e] < g_flowStart[f];
+        }
+      if (later)
+        {
+          laterDelay += delay;
+          laterFlows++;
+        }
+    }
+  std::cout << nodes << "," << areaPerNode << "," << zoneRadius << "," << dissemination << "," << queryDetection << ","
+            << zoneRing << "," << proxyReply << "," << routeCache << "," << sinkOnly << "," << sinkTree << "," << sinks << "," << rreqDestinations << "," << requestMerging << "," << g_discoveries << "," << g_rreqTx << ","
+            << (g_discoveries ? double (g_rreqTx) / g_discoveries : 0) << ","
+            << double (g_rreqTx) / flows << ","
+            << (g_reached.empty () ? 0 : reach / g_reached.size ()) << ","
+            << (g_sent ? double (g_received) / g_sent : 0) << ","
+            << (reachedFlows ? firstPacketDelay / reachedFlows : 0) << ","
+            << (laterFlows ? laterDelay / laterFlows : 0) << "," << g_beaconTx << std::endl;
+  return 0;
+}
@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/*
+ * Zone convergence benchmark.
+ *
+ * Static nodes are dropped at a constant density, so the zone size does not
+ * depend on the node count.  Every CheckInterval the zone (IARP) table of
+ * every node is compared against the two-hop neighborhood computed from the
+ * node positions, and the times at which 90% and 100% of the expected zone
+ * entries are known are printed as one CSV line, with the zone maintenance
+ * bytes sent until then:
+ *
+ *   nodes,zoneSolicit,linkState,t90(s),t100(s),coverage,zoneBytes
+ *
+ * Sweep the node count with e.g.
+ *
+ *   for n in 25 50 100 200 400; do
+ *     ./waf --run "shingo-zone-bench --nodes=$n --zoneSolicit=0"
+ *     ./waf --run "shingo-zone-bench --nodes=$n --zoneSolicit=1"
+ *     ./waf --run "shingo-zone-bench --nodes=$n --linkState=1"
+ *   done
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/shingo-helper.h"
+#include "ns3/shingo.h"
+#include "ns3/shingo-packet.h"
+
+#include <cmath>
+#include <iostream>
+#include <queue>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("ShingoZoneBench");
+
+/// Expected zone members (node index, hop count) of every node
+static std::vector<std::vector<std::pair<uint32_t, uint32_t> > > g_expected;
+static NodeContainer g_nodes;
+static Time g_checkInterval;
+static double g_t90 = -1;
+static double g_t100 = -1;
+static double g_coverage = 0;
+static uint64_t g_zoneBytes = 0;
+
+static void
+ControlTx (Ptr<const Packet> packet)
+{
+  shingo::TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  if (tHeader.Get () == shingo::SHINGO_IARP || tHeader.Get () == shingo::SHINGO_ZONE_SOLICIT
+      || tHeader.Get () == shingo::SHINGO_NEIGHBOR_SET)
+    {
+      g_zoneBytes += packet->GetSize ();
+    }
+}
+
+static Ipv4Address
+GetAddress (uint32_t n)
+{
+  return g_nodes.Get (n)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ();
+}
+
+static void
+CheckZones ()
+{
+  uint32_t expected = 0;
+  uint32_t known = 0;
+  for (uint32_t n = 0; n < g_nodes.GetN (); ++n)
+    {
+      Ptr<shingo::RoutingProtocol> routing = g_nodes.Get (n)->GetObject<shingo::RoutingProtocol> ();
+      for (uint32_t k = 0; k < g_expected[n].size (); ++k)
+        {
+          expected++;
+          if (routing->GetZoneHopCount (GetAddress (g_expected[n][k].first)) != 0)
+            {
+              known++;
+            }
+        }
+    }
+  g_coverage = expected ? double (known) / expected : 1.0;
+  if (g_t90 < 0 && g_coverage >= 0.9)
+    {
+      g_t90 = Simulator::Now ().GetSeconds ();
+    }
+  if (g_coverage >= 1.0)
+    {
+      g_t100 = Simulator::Now ().GetSeconds ();
+      Simulator::Stop ();
+      return;
+    }
+  Simulator::Schedule (g_checkInterval, &CheckZones);
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nodes = 50;
+  double areaPerNode = 2500; // m^2, about 12 neighbors with a 100 m range
+  double range = 100;
+  uint32_t zoneRadius = 2;
+  bool zoneSolicit = true;
+  bool linkState = false;
+  double stopTime = 60;
+  double checkInterval = 0.01;
+
+  CommandLine cmd;
+  cmd.AddValue ("nodes", "Number of nodes", nodes);
+  cmd.AddValue ("areaPerNode", "Area per node in square meters", areaPerNode);
+  cmd.AddValue ("range", "Radio range in meters", range);
+  cmd.AddValue ("zoneRadius", "Zone radius in hops used for the expected zones", zoneRadius);
+  cmd.AddValue ("zoneSolicit", "Enable the zone solicit bootstrap", zoneSolicit);
+  cmd.AddValue ("linkState", "Use the link-state zone engine instead of IARP", linkState);
+  cmd.AddValue ("stopTime", "Give up after this many seconds", stopTime);
+  cmd.AddValue ("checkInterval", "Interval between two zone checks in seconds", checkInterval);
+  cmd.Parse (argc, argv);
+  g_checkInterval = Seconds (checkInterval);
+
+  std::string phyMode ("DsssRate1Mbps");
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue (phyMode));
+
+  g_nodes.Create (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::FixedRssLossModel", "Rss", DoubleValue (-80));
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (range));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue (phyMode),
+                                "ControlMode", StringValue (phyMode));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, g_nodes);
+
+  double side = std::sqrt (nodes * areaPerNode);
+  std::ostringstream bound;
+  bound << "ns3::UniformRandomVariable[Min=0|Max=" << side << "]";
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::RandomRectanglePositionAllocator",
+                                 "X", StringValue (bound.str ()),
+                                 "Y", StringValue (bound.str ()));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (g_nodes);
+
+  ShingoHelper shingo;
+  shingo.SetAttribute ("EnableZoneSolicit", BooleanValue (zoneSolicit));
+  shingo.SetAttribute ("ZoneRadius", UintegerValue (zoneRadius));
+  shingo.SetAttribute ("ZoneEngine", EnumValue (linkState ? shingo::ZONE_ENGINE_LINK_STATE : shingo::ZONE_ENGINE_IARP));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (shingo);
+  internet.Install (g_nodes);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.0.0.0", "255.255.0.0");
+  ipv4.Assign (devices);
+
+  Config::ConnectWithoutContext ("/NodeList/*/$ns3::shingo::RoutingProtocol/Tx", MakeCallback (&ControlTx));
+
+  // Expected zones: breadth first search on the unit disk graph
+  g_expected.assign (nodes, std::vector<std::pair<uint32_t, uint32_t> > ());
+  for (uint32_t n = 0; n < nodes; ++n)
+    {
+      std::vector<uint32_t> hops (nodes, 0);
+      std::queue<uint32_t> frontier;
+      frontier.push (n);
+      while (!frontier.empty ())
+        {
+          uint32_t u = frontier.front ();
+          frontier.pop ();
+          if (u != n && hops[u] >= zoneRadius)
+            {
+              continue;
+            }
+          Ptr<MobilityModel> mu = g_nodes.Get (u)->GetObject<MobilityModel> ();
+          for (uint32_t v = 0; v < nodes; ++v)
+            {
+              if (v == n || hops[v] != 0)
+                {
+                  continue;
+                }
+              if (mu->GetDistanceFrom (g_nodes.Get (v)->GetObject<MobilityModel> ()) <= range)
+                {
+                  hops[v] = hops[u] + 1;
+                  g_expected[n].push_back (std::make_pair (v, hops[v]));
+                  frontier.push (v);
+                }
+            }
+        }
+    }
+
+  Simulator::Schedule (g_checkInterval, &CheckZones);
+  Simulator::Stop (Seconds (stopTime));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << nodes << "," << zoneSolicit << "," << linkState << "," << g_t90 << "," << g_t100 << ","
+            << g_coverage << "," << g_zoneBytes << std::endl;
+  return 0;
+}
@@ -0,0 +1,54 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-blacklist.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+
+namespace ns3 {
+namespace shingo {
+
+void
+LinkBlacklist::Insert (Ipv4Address neighbor, Time timeout)
+{
+  Time & expire = m_neighbors[neighbor];
+  expire = std::max (expire, Simulator::Now () + timeout);
+}
+
+bool
+LinkBlacklist::Remove (Ipv4Address neighbor)
+{
+  return m_neighbors.erase (neighbor) > 0;
+}
+
+bool
+LinkBlacklist::IsBlacklisted (Ipv4Address neighbor)
+{
+  Purge ();
+  return m_neighbors.find (neighbor) != m_neighbors.end ();
+}
+
+void
+LinkBlacklist::Purge ()
+{
+  for (std::map<Ipv4Address, Time>::iterator i = m_neighbors.begin (); i != m_neighbors.end (); )
+    {
+      if (i->second < Simulator::Now ())
+        {
+          m_neighbors.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+uint32_t
+LinkBlacklist::GetSize ()
+{
+  Purge ();
+  return m_neighbors.size ();
+}
+
+}
+}
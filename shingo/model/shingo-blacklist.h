@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_BLACKLIST_H
+#define SHINGO_BLACKLIST_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Neighbors over unidirectional links.
+ *
+ * A neighbor that misses several RREP-ACKs in a row, each within
+ * NextHopWait, can be heard but does not hear this node.  It stays
+ * blacklisted for the blacklist timeout: its RREQs are ignored, so that no
+ * reverse route goes over the link, and the zone engine neither learns
+ * routes from it, advertises it as a neighbor nor uses the zone routes
+ * through it.  A RREP-ACK from the neighbor clears it.
+ */
+class LinkBlacklist
+{
+public:
+  /**
+   * Blacklist a neighbor, or extend its blacklisting
+   * \param neighbor the neighbor
+   * \param timeout the time the neighbor stays blacklisted
+   */
+  void Insert (Ipv4Address neighbor, Time timeout);
+  /**
+   * Clear a neighbor whose link proved bidirectional
+   * \param neighbor the neighbor
+   * \returns true if the neighbor was blacklisted
+   */
+  bool Remove (Ipv4Address neighbor);
+  /**
+   * \param neighbor the neighbor
+   * \returns true if the link to the neighbor is blacklisted
+   */
+  bool IsBlacklisted (Ipv4Address neighbor);
+  /// Remove all expired neighbors
+  void Purge ();
+  /**
+   * \returns number of blacklisted neighbors
+   */
+  uint32_t GetSize ();
+
+private:
+  /// Blacklisted neighbors and the time they are cleared
+  std::map<Ipv4Address, Time> m_neighbors;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_BLACKLIST_H */
@@ -0,0 +1,114 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-damping.h"
+#include "ns3/simulator.h"
+#include <cmath>
+
+namespace ns3 {
+namespace shingo {
+
+const double FlapDamping::FLAP_PENALTY = 1000;
+
+FlapDamping::FlapDamping (Time halfLife, double suppressThreshold, double reuseThreshold)
+  : m_halfLife (halfLife),
+    m_suppressThreshold (suppressThreshold),
+    m_reuseThreshold (reuseThreshold)
+{
+}
+
+void
+FlapDamping::Decay (History & h) const
+{
+  Time elapsed = Simulator::Now () - h.m_updated;
+  if (elapsed.IsStrictlyPositive () && m_halfLife.IsStrictlyPositive ())
+    {
+      h.m_penalty *= std::pow (0.5, elapsed.GetSeconds () / m_halfLife.GetSeconds ());
+    }
+  h.m_updated = Simulator::Now ();
+  if (h.m_suppressed && h.m_penalty < m_reuseThreshold)
+    {
+      h.m_suppressed = false;
+    }
+}
+
+bool
+FlapDamping::RecordFlap (Ipv4Address dst)
+{
+  std::map<Ipv4Address, History>::iterator i = m_history.find (dst);
+  if (i == m_history.end ())
+    {
+      History h = { 0, Simulator::Now (), false };
+      i = m_history.insert (std::make_pair (dst, h)).first;
+    }
+  Decay (i->second);
+  i->second.m_penalty += FLAP_PENALTY;
+  if (i->second.m_penalty > m_suppressThreshold)
+    {
+      i->second.m_suppressed = true;
+    }
+  return i->second.m_suppressed;
+}
+
+bool
+FlapDamping::IsSuppressed (Ipv4Address dst)
+{
+  std::map<Ipv4Address, History>::iterator i = m_history.find (dst);
+  if (i == m_history.end ())
+    {
+      return false;
+    }
+  Decay (i->second);
+  return i->second.m_suppressed;
+}
+
+double
+FlapDamping::GetPenalty (Ipv4Address dst)
+{
+  std::map<Ipv4Address, History>::iterator i = m_history.find (dst);
+  if (i == m_history.end ())
+    {
+      return 0;
+    }
+  Decay (i->second);
+  return i->second.m_penalty;
+}
+
+Time
+FlapDamping::GetReuseDelay (Ipv4Address dst)
+{
+  if (!IsSuppressed (dst))
+    {
+      return Seconds (0);
+    }
+  double penalty = m_history[dst].m_penalty;
+  // Rounded up, so that the route is reusable when the delay has elapsed
+  double seconds = m_halfLife.GetSeconds () * std::log (penalty / m_reuseThreshold) / std::log (2.0);
+  return MilliSeconds (std::ceil (seconds * 1000) + 1);
+}
+
+void
+FlapDamping::Purge ()
+{
+  for (std::map<Ipv4Address, History>::iterator i = m_history.begin (); i != m_history.end (); )
+    {
+      Decay (i->second);
+      if (!i->second.m_suppressed && i->second.m_penalty < 1)
+        {
+          m_history.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+uint32_t
+FlapDamping::GetSize ()
+{
+  Purge ();
+  return m_history.size ();
+}
+
+}
+}
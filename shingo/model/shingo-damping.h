@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_DAMPING_H
+#define SHINGO_DAMPING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup iarp
+ *
+ * \brief Route flap damping for the triggered IARP updates.
+ *
+ * Every flap of the route to a destination adds a fixed penalty, and the
+ * penalty decays exponentially with the configured half-life.  Once it
+ * exceeds the suppress threshold, changes of that route are left to the
+ * periodic updates until it has decayed below the reuse threshold.
+ */
+class FlapDamping
+{
+public:
+  /**
+   * constructor
+   * \param halfLife time for the penalty to decay to half its value
+   * \param suppressThreshold penalty above which a route is suppressed
+   * \param reuseThreshold penalty below which a suppressed route is advertised again
+   */
+  FlapDamping (Time halfLife = Seconds (15), double suppressThreshold = 2000, double reuseThreshold = 750);
+  /**
+   * Charge a flap of the route to dst
+   * \param dst the destination
+   * \returns true if the route is suppressed afterwards
+   */
+  bool RecordFlap (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns true if changes of the route to dst are not to be triggered
+   */
+  bool IsSuppressed (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns the penalty of dst decayed to now
+   */
+  double GetPenalty (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns the time until dst is reused, zero if it is not suppressed
+   */
+  Time GetReuseDelay (Ipv4Address dst);
+  /// Forget the destinations whose penalty has decayed away
+  void Purge ();
+  /**
+   * \returns number of destinations with a penalty
+   */
+  uint32_t GetSize ();
+
+  /**
+   * Set the half-life of the penalty
+   * \param halfLife the half-life
+   */
+  void SetHalfLife (Time halfLife)
+  {
+    m_halfLife = halfLife;
+  }
+  /**
+   * Set the suppress threshold
+   * \param threshold the penalty above which a route is suppressed
+   */
+  void SetSuppressThreshold (double threshold)
+  {
+    m_suppressThreshold = threshold;
+  }
+  /**
+   * Set the reuse threshold
+   * \param threshold the penalty below which a suppressed route is advertised again
+   */
+  void SetReuseThreshold (double threshold)
+  {
+    m_reuseThreshold = threshold;
+  }
+
+  /// Penalty charged for one flap
+  static const double FLAP_PENALTY;
+
+private:
+  /// Damping state of one destination
+  struct History
+  {
+    /// Penalty at m_updated
+    double m_penalty;
+    /// Time the penalty was last decayed
+    Time m_updated;
+    /// Whether the route is suppressed
+    bool m_suppressed;
+  };
+  /**
+   * Decay the penalty of a destination to now and lift the suppression below the reuse threshold
+   * \param h the damping state
+   */
+  void Decay (History & h) const;
+  /// Damping state per destination
+  std::map<Ipv4Address, History> m_history;
+  /// Half-life of the penalty
+  Time m_halfLife;
+  /// Penalty above which a route is suppressed
+  double m_suppressThreshold;
+  /// Penalty below which a suppressed route is advertised again
+  double m_reuseThreshold;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_DAMPING_H */
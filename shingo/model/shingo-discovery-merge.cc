@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-discovery-merge.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+namespace shingo {
+
+void
+DiscoveryMerge::Record (RreqHeader const & rreqHeader, Time lifetime)
+{
+  Discovery & discovery = m_discoveries[rreqHeader.GetDst ()];
+  discovery.m_origin = rreqHeader.GetOrigin ();
+  discovery.m_ttl = rreqHeader.GetTtl ();
+  discovery.m_answered = false;
+  discovery.m_expire = Simulator::Now () + lifetime;
+}
+
+bool
+DiscoveryMerge::Hold (RreqHeader const & rreqHeader)
+{
+  std::map<Ipv4Address, Discovery>::iterator i = m_discoveries.find (rreqHeader.GetDst ());
+  // A new RREQ of the same origin is a retry: the discovery in flight failed
+  if (i == m_discoveries.end () || i->second.m_answered || i->second.m_expire <= Simulator::Now ()
+      || i->second.m_origin == rreqHeader.GetOrigin () || rreqHeader.GetTtl () > i->second.m_ttl)
+    {
+      return false;
+    }
+  std::vector<RreqHeader> & held = i->second.m_held;
+  for (std::vector<RreqHeader>::iterator j = held.begin (); j != held.end (); ++j)
+    {
+      if (j->GetOrigin () == rreqHeader.GetOrigin ())
+        {
+          *j = rreqHeader;
+          return true;
+        }
+    }
+  held.push_back (rreqHeader);
+  return true;
+}
+
+std::vector<RreqHeader>
+DiscoveryMerge::TakeAnswered (Ipv4Address dst, uint32_t dstSeqNo)
+{
+  std::vector<RreqHeader> answered;
+  std::map<Ipv4Address, Discovery>::iterator i = m_discoveries.find (dst);
+  if (i == m_discoveries.end ())
+    {
+      return answered;
+    }
+  i->second.m_answered = true;
+  std::vector<RreqHeader> & held = i->second.m_held;
+  for (std::vector<RreqHeader>::iterator j = held.begin (); j != held.end (); )
+    {
+      if (j->GetUnknownSeqno () || int32_t (dstSeqNo) - int32_t (j->GetDstSeqno ()) >= 0)
+        {
+          answered.push_back (*j);
+          j = held.erase (j);
+        }
+      else
+        {
+          ++j;
+        }
+    }
+  return answered;
+}
+
+std::vector<RreqHeader>
+DiscoveryMerge::Release (Ipv4Address dst)
+{
+  std::vector<RreqHeader> held;
+  std::map<Ipv4Address, Discovery>::iterator i = m_discoveries.find (dst);
+  if (i != m_discoveries.end () && i->second.m_expire <= Simulator::Now ())
+    {
+      held.swap (i->second.m_held);
+      m_discoveries.erase (i);
+    }
+  return held;
+}
+
+}
+}
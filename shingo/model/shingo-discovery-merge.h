@@ -0,0 +1,83 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_DISCOVERY_MERGE_H
+#define SHINGO_DISCOVERY_MERGE_H
+
+#include "shingo-packet.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <vector>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Route discoveries in flight through a relay.
+ *
+ * Remembers, per destination, the last RREQ this node relayed.  A RREQ of
+ * another origin for the same destination, asking for no wider ring, is held
+ * instead of flooded again: the RREP of the discovery in flight is copied
+ * along the reverse route of every held RREQ it is fresh enough for.  The
+ * RREQs no RREP answered are released when the discovery expires.
+ */
+class DiscoveryMerge
+{
+public:
+  /**
+   * Record a RREQ relayed for its destination
+   * \param rreqHeader the RREQ as relayed
+   * \param lifetime the time the RREP is expected back within
+   */
+  void Record (RreqHeader const & rreqHeader, Time lifetime);
+  /**
+   * Hold a RREQ the discovery in flight for its destination may answer
+   * \param rreqHeader the RREQ as it would be relayed
+   * \returns true if the RREQ was held, false if it must be relayed
+   */
+  bool Hold (RreqHeader const & rreqHeader);
+  /**
+   * Take the held RREQs a RREP answers; later RREQs for dst are no longer held
+   * \param dst the destination of the RREP
+   * \param dstSeqNo the destination sequence number of the RREP
+   * \returns the held RREQs asking for no fresher sequence number
+   */
+  std::vector<RreqHeader> TakeAnswered (Ipv4Address dst, uint32_t dstSeqNo);
+  /**
+   * Forget the discovery for dst if it expired
+   * \param dst the destination
+   * \returns the RREQs still held for dst, to be relayed
+   */
+  std::vector<RreqHeader> Release (Ipv4Address dst);
+  /**
+   * \returns number of discoveries in flight
+   */
+  uint32_t GetSize () const
+  {
+    return m_discoveries.size ();
+  }
+
+private:
+  /// Discovery in flight
+  struct Discovery
+  {
+    /// Origin of the RREQ relayed
+    Ipv4Address m_origin;
+    /// TTL the RREQ was relayed with
+    uint8_t m_ttl;
+    /// Whether a RREP for the destination came back
+    bool m_answered;
+    /// When the discovery expires
+    Time m_expire;
+    /// RREQs of other origins waiting for the RREP
+    std::vector<RreqHeader> m_held;
+  };
+  /// Discoveries in flight by destination
+  std::map<Ipv4Address, Discovery> m_discoveries;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_DISCOVERY_MERGE_H */
@@ -0,0 +1,56 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-hello.h"
+#include <algorithm>
+
+namespace ns3 {
+namespace shingo {
+
+HelloSchedule::HelloSchedule (Time interval, Time minInterval, Time maxInterval,
+                              uint32_t churnThreshold, uint16_t allowedLoss)
+  : m_interval (interval),
+    m_minInterval (minInterval),
+    m_maxInterval (maxInterval),
+    m_churnThreshold (churnThreshold),
+    m_allowedLoss (allowedLoss),
+    m_changes (0)
+{
+}
+
+bool
+HelloSchedule::Adapt ()
+{
+  Time previous = m_interval;
+  // A churning neighborhood is probed quickly, a stable one rarely
+  if (m_changes >= m_churnThreshold)
+    {
+      m_interval = std::max (m_minInterval, Time (m_interval / 2));
+    }
+  else if (m_changes == 0)
+    {
+      m_interval = std::min (m_maxInterval, Time (2 * m_interval));
+    }
+  m_changes = 0;
+  return m_interval > previous;
+}
+
+Time
+HelloSchedule::GetSuppressDelay (Time lastBroadcast, Time now, bool urgent) const
+{
+  // Any control broadcast keeps the neighbors' links to this node open like a hello
+  Time offset = now - lastBroadcast;
+  if (urgent || !lastBroadcast.IsStrictlyPositive () || offset >= m_interval)
+    {
+      return Seconds (0);
+    }
+  return m_interval - offset;
+}
+
+Time
+HelloSchedule::GetLifetime () const
+{
+  return Time (m_allowedLoss * m_interval);
+}
+
+}  // namespace shingo
+}  // namespace ns3
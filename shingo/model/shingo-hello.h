@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_HELLO_H
+#define SHINGO_HELLO_H
+
+#include "ns3/nstime.h"
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup iarp
+ *
+ * \brief Hello interval adapted to the neighbor churn.
+ *
+ * Counts the neighbors opened or lost since the hello timer last expired.
+ * A hello interval with at least the churn threshold of changes halves the
+ * interval, one without any change doubles it, always within the minimum
+ * and maximum interval.  A hello is skipped while another control broadcast
+ * sent less than one interval ago stands in for it, and advertises that the
+ * link stays alive for the allowed hello loss times the interval.
+ */
+class HelloSchedule
+{
+public:
+  /**
+   * constructor
+   * \param interval the initial hello interval
+   * \param minInterval the shortest interval the adaptation may choose
+   * \param maxInterval the longest interval the adaptation may choose
+   * \param churnThreshold neighbor changes per interval from which the interval is halved
+   * \param allowedLoss number of hellos which may be lost for a valid link
+   */
+  HelloSchedule (Time interval = Seconds (1), Time minInterval = MilliSeconds (500), Time maxInterval = Seconds (2),
+                 uint32_t churnThreshold = 2, uint16_t allowedLoss = 2);
+  /// Count a neighbor opened or lost
+  void RecordChange ()
+  {
+    m_changes++;
+  }
+  /**
+   * \returns the neighbor changes since the last adaptation
+   */
+  uint32_t GetChanges () const
+  {
+    return m_changes;
+  }
+  /**
+   * Adapt the interval to the neighbor changes counted since the last adaptation, and restart the count
+   * \returns true if the interval grew
+   */
+  bool Adapt ();
+  /**
+   * \param lastBroadcast time this node last sent a control broadcast, zero if never
+   * \param now the current time
+   * \param urgent whether the hello carries news the neighbors need at once, e.g. a longer interval
+   * \returns the time after which the hello is due again, zero if it is to be sent now
+   */
+  Time GetSuppressDelay (Time lastBroadcast, Time now, bool urgent) const;
+  /**
+   * \returns the time the neighbors keep the link alive after a hello
+   */
+  Time GetLifetime () const;
+  /**
+   * \returns the hello interval currently in use
+   */
+  Time GetInterval () const
+  {
+    return m_interval;
+  }
+
+  /**
+   * Set the hello interval currently in use
+   * \param interval the interval
+   */
+  void SetInterval (Time interval)
+  {
+    m_interval = interval;
+  }
+  /**
+   * Set the shortest interval
+   * \param interval the shortest interval the adaptation may choose
+   */
+  void SetMinInterval (Time interval)
+  {
+    m_minInterval = interval;
+  }
+  /**
+   * Set the longest interval
+   * \param interval the longest interval the adaptation may choose
+   */
+  void SetMaxInterval (Time interval)
+  {
+    m_maxInterval = interval;
+  }
+  /**
+   * Set the churn threshold
+   * \param threshold neighbor changes per interval from which the interval is halved
+   */
+  void SetChurnThreshold (uint32_t threshold)
+  {
+    m_churnThreshold = threshold;
+  }
+  /**
+   * Set the allowed hello loss
+   * \param allowedLoss number of hellos which may be lost for a valid link
+   */
+  void SetAllowedLoss (uint16_t allowedLoss)
+  {
+    m_allowedLoss = allowedLoss;
+  }
+
+private:
+  /// Hello interval currently in use
+  Time m_interval;
+  /// Shortest interval the adaptation may choose
+  Time m_minInterval;
+  /// Longest interval the adaptation may choose
+  Time m_maxInterval;
+  /// Neighbor changes per interval from which the interval is halved
+  uint32_t m_churnThreshold;
+  /// Number of hellos which may be lost for a valid link
+  uint16_t m_allowedLoss;
+  /// Neighbors opened or lost since the last adaptation
+  uint32_t m_changes;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_HELLO_H */
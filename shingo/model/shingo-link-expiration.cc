@@ -0,0 +1,68 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-link-expiration.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+namespace shingo {
+
+LinkExpiration::LinkExpiration (double range)
+  : m_range (range)
+{
+}
+
+void
+LinkExpiration::Update (Ipv4Address neighbor, Vector position, Vector velocity)
+{
+  Motion & motion = m_neighbors[neighbor];
+  motion.m_position = position;
+  motion.m_velocity = velocity;
+  motion.m_time = Simulator::Now ();
+}
+
+void
+LinkExpiration::Remove (Ipv4Address neighbor)
+{
+  m_neighbors.erase (neighbor);
+}
+
+Time
+LinkExpiration::GetExpirationTime (Ipv4Address neighbor, Vector position, Vector velocity) const
+{
+  std::map<Ipv4Address, Motion>::const_iterator i = m_neighbors.find (neighbor);
+  if (i == m_neighbors.end ())
+    {
+      return Time::Max ();
+    }
+  double elapsed = (Simulator::Now () - i->second.m_time).GetSeconds ();
+  Vector otherPosition (i->second.m_position.x + i->second.m_velocity.x * elapsed,
+                        i->second.m_position.y + i->second.m_velocity.y * elapsed, 0);
+  return Predict (position, velocity, otherPosition, i->second.m_velocity, m_range);
+}
+
+Time
+LinkExpiration::Predict (Vector position, Vector velocity, Vector otherPosition, Vector otherVelocity, double range)
+{
+  double a = velocity.x - otherVelocity.x;
+  double b = position.x - otherPosition.x;
+  double c = velocity.y - otherVelocity.y;
+  double d = position.y - otherPosition.y;
+  double speed2 = a * a + c * c;
+  if (speed2 == 0)
+    {
+      return b * b + d * d > range * range ? Seconds (0) : Time::Max ();
+    }
+  double discriminant = speed2 * range * range - (a * d - b * c) * (a * d - b * c);
+  if (discriminant < 0)
+    {
+      return Seconds (0);
+    }
+  // The later root of |relative position + t * relative velocity| = range
+  double t = (-(a * b + c * d) + std::sqrt (discriminant)) / speed2;
+  return Seconds (std::max (0.0, t));
+}
+
+}
+}
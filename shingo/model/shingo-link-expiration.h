@@ -0,0 +1,96 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_LINK_EXPIRATION_H
+#define SHINGO_LINK_EXPIRATION_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup iarp
+ *
+ * \brief Link expiration time prediction from the motion of the neighbors.
+ *
+ * Keeps the position and velocity the neighbors last advertised and
+ * extrapolates them, so that the time two nodes moving on straight lines
+ * stay within the transmission range of each other follows from their
+ * relative motion (Su, Lee and Gerla, "Mobility prediction and routing in
+ * ad hoc wireless networks").
+ */
+class LinkExpiration
+{
+public:
+  /**
+   * constructor
+   * \param range the transmission range in meters
+   */
+  LinkExpiration (double range = 100);
+  /**
+   * Record the motion a neighbor advertised
+   * \param neighbor the neighbor
+   * \param position the position of the neighbor
+   * \param velocity the velocity of the neighbor
+   */
+  void Update (Ipv4Address neighbor, Vector position, Vector velocity);
+  /**
+   * Forget a lost neighbor
+   * \param neighbor the neighbor
+   */
+  void Remove (Ipv4Address neighbor);
+  /**
+   * \param neighbor the neighbor
+   * \param position the position of this node
+   * \param velocity the velocity of this node
+   * \returns the time left until the link to the neighbor breaks, Time::Max () if the motion of the neighbor
+   * is unknown or the link never breaks
+   */
+  Time GetExpirationTime (Ipv4Address neighbor, Vector position, Vector velocity) const;
+  /**
+   * \param position the position of a node
+   * \param velocity the velocity of the node
+   * \param otherPosition the position of the other node
+   * \param otherVelocity the velocity of the other node
+   * \param range the transmission range in meters
+   * \returns the time left until the nodes are out of range, Time::Max () if never
+   */
+  static Time Predict (Vector position, Vector velocity, Vector otherPosition, Vector otherVelocity, double range);
+  /**
+   * \returns number of neighbors with known motion
+   */
+  uint32_t GetSize () const
+  {
+    return m_neighbors.size ();
+  }
+  /**
+   * \param range the transmission range in meters
+   */
+  void SetRange (double range)
+  {
+    m_range = range;
+  }
+
+private:
+  /// Motion advertised by a neighbor
+  struct Motion
+  {
+    /// Position when advertised
+    Vector m_position;
+    /// Velocity
+    Vector m_velocity;
+    /// Time the motion was advertised
+    Time m_time;
+  };
+  /// Motion of the neighbors
+  std::map<Ipv4Address, Motion> m_neighbors;
+  /// Transmission range in meters
+  double m_range;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_LINK_EXPIRATION_H */
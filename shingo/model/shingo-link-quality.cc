@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-link-quality.h"
+#include "ns3/simulator.h"
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+namespace shingo {
+
+LinkQuality::LinkQuality (Time window)
+  : m_window (window)
+{
+}
+
+void
+LinkQuality::Receive (Ipv4Address neighbor, Time interval)
+{
+  std::map<Ipv4Address, Link>::iterator i = m_links.find (neighbor);
+  if (i == m_links.end ())
+    {
+      Link link;
+      link.m_first = Simulator::Now ();
+      i = m_links.insert (std::make_pair (neighbor, link)).first;
+    }
+  Link & link = i->second;
+  link.m_interval = interval;
+  if (!link.m_heard.empty () && Simulator::Now () - link.m_heard.back () < interval / 2)
+    {
+      return;
+    }
+  link.m_heard.push_back (Simulator::Now ());
+}
+
+void
+LinkQuality::Remove (Ipv4Address neighbor)
+{
+  m_links.erase (neighbor);
+}
+
+double
+LinkQuality::GetDeliveryRatio (Ipv4Address neighbor)
+{
+  std::map<Ipv4Address, Link>::iterator i = m_links.find (neighbor);
+  if (i == m_links.end () || !i->second.m_interval.IsStrictlyPositive ())
+    {
+      return 1;
+    }
+  Link & link = i->second;
+  while (!link.m_heard.empty () && link.m_heard.front () < Simulator::Now () - m_window)
+    {
+      link.m_heard.pop_front ();
+    }
+  Time span = std::min (m_window, Simulator::Now () - link.m_first);
+  double expected = std::max (1.0, std::floor (span.GetSeconds () / link.m_interval.GetSeconds ()));
+  // A link this bad is as good as lost, and keeps the cost within the metric
+  return std::max (0.1, std::min (1.0, link.m_heard.size () / expected));
+}
+
+uint16_t
+LinkQuality::GetLinkCost (Ipv4Address neighbor)
+{
+  double d = GetDeliveryRatio (neighbor);
+  return uint16_t (std::floor (PERFECT_LINK / (d * d) + 0.5));
+}
+
+uint16_t
+LinkQuality::Accumulate (uint16_t path, uint16_t link)
+{
+  return uint16_t (std::min (uint32_t (0xffff), uint32_t (path) + link));
+}
+
+}
+}
@@ -0,0 +1,99 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_LINK_QUALITY_H
+#define SHINGO_LINK_QUALITY_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <deque>
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup iarp
+ *
+ * \brief Delivery ratio and ETX cost of the links to the neighbors.
+ *
+ * A neighbor broadcasts at least once per hello interval, a hello or a
+ * control message that stood in for it, so the broadcasts heard from it in
+ * a sliding window against the hello intervals the window spans give the
+ * delivery ratio d of the link.  Broadcasts closer than half an interval
+ * count once.  The cost of the link is its expected transmission count
+ * 1 / (d_f * d_r) scaled by 100; only the reverse ratio is measured, so
+ * the forward one is taken equal to it.
+ */
+class LinkQuality
+{
+public:
+  /**
+   * constructor
+   * \param window the span of the sliding window
+   */
+  LinkQuality (Time window = Seconds (10));
+  /// Cost of a perfect link
+  static const uint16_t PERFECT_LINK = 100;
+  /**
+   * Record a broadcast heard from a neighbor
+   * \param neighbor the neighbor
+   * \param interval the hello interval of the neighbor
+   */
+  void Receive (Ipv4Address neighbor, Time interval);
+  /**
+   * Forget a lost neighbor
+   * \param neighbor the neighbor
+   */
+  void Remove (Ipv4Address neighbor);
+  /**
+   * \param neighbor the neighbor
+   * \returns the delivery ratio of the link from the neighbor, 1 if nothing was heard yet
+   */
+  double GetDeliveryRatio (Ipv4Address neighbor);
+  /**
+   * \param neighbor the neighbor
+   * \returns the ETX of the link to the neighbor scaled by 100
+   */
+  uint16_t GetLinkCost (Ipv4Address neighbor);
+  /**
+   * Add the cost of a link to the cost of a path
+   * \param path the cost of the path
+   * \param link the cost of the link
+   * \returns the sum, saturated at the largest metric
+   */
+  static uint16_t Accumulate (uint16_t path, uint16_t link);
+  /**
+   * \returns number of neighbors measured
+   */
+  uint32_t GetSize () const
+  {
+    return m_links.size ();
+  }
+  /**
+   * \param window the span of the sliding window
+   */
+  void SetWindow (Time window)
+  {
+    m_window = window;
+  }
+
+private:
+  /// Broadcasts heard from a neighbor
+  struct Link
+  {
+    /// Time the first broadcast was heard
+    Time m_first;
+    /// Hello interval of the neighbor
+    Time m_interval;
+    /// Times of the broadcasts heard in the window
+    std::deque<Time> m_heard;
+  };
+  /// Links to the neighbors
+  std::map<Ipv4Address, Link> m_links;
+  /// Span of the sliding window
+  Time m_window;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_LINK_QUALITY_H */
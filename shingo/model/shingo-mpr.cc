@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-mpr.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+namespace shingo {
+
+MprSelection::MprSelection ()
+  : m_changed (true)
+{
+}
+
+void
+MprSelection::AddLink (Ipv4Address neighbor, Ipv4Address twoHop, Time expire)
+{
+  std::map<Ipv4Address, Time> & links = m_links[neighbor];
+  m_changed = m_changed || links.find (twoHop) == links.end ();
+  links[twoHop] = expire;
+}
+
+void
+MprSelection::RemoveLink (Ipv4Address neighbor, Ipv4Address twoHop)
+{
+  std::map<Ipv4Address, std::map<Ipv4Address, Time> >::iterator i = m_links.find (neighbor);
+  if (i != m_links.end () && i->second.erase (twoHop) > 0)
+    {
+      m_changed = true;
+    }
+}
+
+void
+MprSelection::SetLinks (Ipv4Address neighbor, std::set<Ipv4Address> const & twoHops, Time expire)
+{
+  std::map<Ipv4Address, Time> & links = m_links[neighbor];
+  std::map<Ipv4Address, Time> updated;
+  for (std::set<Ipv4Address>::const_iterator j = twoHops.begin (); j != twoHops.end (); ++j)
+    {
+      m_changed = m_changed || links.find (*j) == links.end ();
+      updated[*j] = expire;
+    }
+  m_changed = m_changed || links.size () != updated.size ();
+  links.swap (updated);
+}
+
+void
+MprSelection::Purge ()
+{
+  for (std::map<Ipv4Address, std::map<Ipv4Address, Time> >::iterator i = m_links.begin (); i != m_links.end (); )
+    {
+      for (std::map<Ipv4Address, Time>::iterator j = i->second.begin (); j != i->second.end (); )
+        {
+          if (j->second < Simulator::Now ())
+            {
+              i->second.erase (j++);
+              m_changed = true;
+            }
+          else
+            {
+              ++j;
+            }
+        }
+      if (i->second.empty ())
+        {
+          m_links.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+bool
+MprSelection::IsLink (Ipv4Address neighbor, Ipv4Address twoHop) const
+{
+  std::map<Ipv4Address, std::map<Ipv4Address, Time> >::const_iterator i = m_links.find (neighbor);
+  return i != m_links.end () && i->second.find (twoHop) != i->second.end ();
+}
+
+std::set<Ipv4Address> const &
+MprSelection::Compute (std::set<Ipv4Address> const & neighbors,
+                       std::map<Ipv4Address, Ipv4Address> const & twoHops)
+{
+  Purge ();
+  if (!m_changed && neighbors == m_neighbors && twoHops == m_twoHops)
+    {
+      return m_mprs;
+    }
+  m_changed = false;
+  m_neighbors = neighbors;
+  m_twoHops = twoHops;
+  m_mprs.clear ();
+
+  // Neighbors covering every strict two-hop neighbor, the next hop of its zone route included
+  std::map<Ipv4Address, std::set<Ipv4Address> > coverage;
+  for (std::map<Ipv4Address, Ipv4Address>::const_iterator t = twoHops.begin (); t != twoHops.end (); ++t)
+    {
+      if (neighbors.count (t->first))
+        {
+          continue;
+        }
+      std::set<Ipv4Address> & covering = coverage[t->first];
+      if (neighbors.count (t->second))
+        {
+          covering.insert (t->second);
+        }
+      for (std::set<Ipv4Address>::const_iterator n = neighbors.begin (); n != neighbors.end (); ++n)
+        {
+          if (IsLink (*n, t->first))
+            {
+              covering.insert (*n);
+            }
+        }
+      if (covering.empty ())
+        {
+          coverage.erase (t->first);
+        }
+    }
+
+  // The only neighbor reaching a two-hop neighbor is always selected
+  for (std::map<Ipv4Address, std::set<Ipv4Address> >::const_iterator t = coverage.begin (); t != coverage.end (); ++t)
+    {
+      if (t->second.size () == 1)
+        {
+          m_mprs.insert (*t->second.begin ());
+        }
+    }
+  while (true)
+    {
+      for (std::map<Ipv4Address, std::set<Ipv4Address> >::iterator t = coverage.begin (); t != coverage.end (); )
+        {
+          bool covered = false;
+          for (std::set<Ipv4Address>::const_iterator m = m_mprs.begin (); m != m_mprs.end () && !covered; ++m)
+            {
+              covered = t->second.count (*m) > 0;
+            }
+          if (covered)
+            {
+              coverage.erase (t++);
+            }
+          else
+            {
+              ++t;
+            }
+        }
+      if (coverage.empty ())
+        {
+          break;
+        }
+      // Then the neighbor covering the most two-hop neighbors left
+      std::map<Ipv4Address, uint32_t> reach;
+      for (std::map<Ipv4Address, std::set<Ipv4Address> >::const_iterator t = coverage.begin (); t != coverage.end (); ++t)
+        {
+          for (std::set<Ipv4Address>::const_iterator n = t->second.begin (); n != t->second.end (); ++n)
+            {
+              reach[*n]++;
+            }
+        }
+      std::map<Ipv4Address, uint32_t>::const_iterator best = reach.begin ();
+      for (std::map<Ipv4Address, uint32_t>::const_iterator n = reach.begin (); n != reach.end (); ++n)
+        {
+          if (n->second > best->second)
+            {
+              best = n;
+            }
+        }
+      m_mprs.insert (best->first);
+    }
+  return m_mprs;
+}
+
+}
+}
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_MPR_H
+#define SHINGO_MPR_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <set>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Multipoint relay selection for the RREQ flooding.
+ *
+ * Keeps the links from the one-hop neighbors to the two-hop neighbors, as
+ * learnt from the zone messages of the neighbors, and selects with the
+ * greedy heuristic of OLSR (RFC 3626, 8.3.1) a set of neighbors covering
+ * every two-hop neighbor.  The selection is only computed again when the
+ * links or the neighborhood changed.
+ */
+class MprSelection
+{
+public:
+  MprSelection ();
+  /**
+   * Record a link from a neighbor to a two-hop neighbor
+   * \param neighbor the one-hop neighbor
+   * \param twoHop the node the neighbor hears
+   * \param expire the time the link is forgotten
+   */
+  void AddLink (Ipv4Address neighbor, Ipv4Address twoHop, Time expire);
+  /**
+   * Forget a link from a neighbor to a two-hop neighbor
+   * \param neighbor the one-hop neighbor
+   * \param twoHop the node the neighbor no longer hears
+   */
+  void RemoveLink (Ipv4Address neighbor, Ipv4Address twoHop);
+  /**
+   * Replace all links of a neighbor
+   * \param neighbor the one-hop neighbor
+   * \param twoHops the nodes the neighbor hears
+   * \param expire the time the links are forgotten
+   */
+  void SetLinks (Ipv4Address neighbor, std::set<Ipv4Address> const & twoHops, Time expire);
+  /**
+   * Select the multipoint relays
+   * \param neighbors the one-hop neighbors
+   * \param twoHops the two-hop neighbors and the neighbor the zone route to each goes through
+   * \returns the neighbors selected as relays
+   */
+  std::set<Ipv4Address> const & Compute (std::set<Ipv4Address> const & neighbors,
+                                         std::map<Ipv4Address, Ipv4Address> const & twoHops);
+  /**
+   * \returns number of neighbors with known links
+   */
+  uint32_t GetSize () const
+  {
+    return m_links.size ();
+  }
+
+private:
+  /// Forget the expired links
+  void Purge ();
+  /**
+   * \param neighbor the one-hop neighbor
+   * \param twoHop the two-hop neighbor
+   * \returns true if a link from neighbor to twoHop is known
+   */
+  bool IsLink (Ipv4Address neighbor, Ipv4Address twoHop) const;
+  /// Links of every neighbor and the time they expire
+  std::map<Ipv4Address, std::map<Ipv4Address, Time> > m_links;
+  /// Whether the links changed since the last selection
+  bool m_changed;
+  /// Neighbors of the last selection
+  std::set<Ipv4Address> m_neighbors;
+  /// Two-hop neighbors of the last selection
+  std::map<Ipv4Address, Ipv4Address> m_twoHops;
+  /// Last selection
+  std::set<Ipv4Address> m_mprs;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_MPR_H */
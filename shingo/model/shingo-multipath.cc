@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-multipath.h"
+#include "ns3/simulator.h"
+#include "ns3/hash.h"
+
+namespace ns3 {
+namespace shingo {
+
+MultipathTable::MultipathTable (uint32_t maxPaths)
+  : m_maxPaths (maxPaths)
+{
+}
+
+void
+MultipathTable::SetPrimary (Ipv4Address dst, Ipv4Address nextHop, Ipv4Address lastHop)
+{
+  Paths & paths = m_table[dst];
+  paths.m_nextHop = nextHop;
+  paths.m_lastHop = lastHop;
+  Path primary;
+  primary.m_nextHop = nextHop;
+  primary.m_lastHop = lastHop;
+  for (std::map<Ipv4Address, Path>::iterator i = paths.m_paths.begin (); i != paths.m_paths.end (); )
+    {
+      if (IsJoint (i->second, primary))
+        {
+          paths.m_paths.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+bool
+MultipathTable::AddPath (Ipv4Address dst, Path const & path)
+{
+  if (m_maxPaths < 2)
+    {
+      return false;
+    }
+  Paths & paths = m_table[dst];
+  Purge (paths);
+  Path primary;
+  primary.m_nextHop = paths.m_nextHop;
+  primary.m_lastHop = paths.m_lastHop;
+  if (IsJoint (path, primary))
+    {
+      return false;
+    }
+  for (std::map<Ipv4Address, Path>::const_iterator i = paths.m_paths.begin (); i != paths.m_paths.end (); ++i)
+    {
+      if (i->first != path.m_nextHop && IsJoint (path, i->second))
+        {
+          return false;
+        }
+    }
+  paths.m_paths[path.m_nextHop] = path;
+  if (paths.m_paths.size () < m_maxPaths)
+    {
+      return true;
+    }
+  std::map<Ipv4Address, Path>::iterator worst = paths.m_paths.begin ();
+  for (std::map<Ipv4Address, Path>::iterator i = paths.m_paths.begin (); i != paths.m_paths.end (); ++i)
+    {
+      if (i->second.m_metric > worst->second.m_metric
+          || (i->second.m_metric == worst->second.m_metric && i->second.m_hops > worst->second.m_hops))
+        {
+          worst = i;
+        }
+    }
+  bool kept = worst->first != path.m_nextHop;
+  paths.m_paths.erase (worst);
+  return kept;
+}
+
+void
+MultipathTable::RemovePath (Ipv4Address dst, Ipv4Address nextHop)
+{
+  std::map<Ipv4Address, Paths>::iterator i = m_table.find (dst);
+  if (i != m_table.end ())
+    {
+      i->second.m_paths.erase (nextHop);
+    }
+}
+
+void
+MultipathTable::Clear (Ipv4Address dst)
+{
+  m_table.erase (dst);
+}
+
+void
+MultipathTable::RemoveNextHop (Ipv4Address neighbor)
+{
+  for (std::map<Ipv4Address, Paths>::iterator i = m_table.begin (); i != m_table.end (); ++i)
+    {
+      i->second.m_paths.erase (neighbor);
+    }
+}
+
+bool
+MultipathTable::TakeBestPath (Ipv4Address dst, Path & path)
+{
+  std::map<Ipv4Address, Paths>::iterator i = m_table.find (dst);
+  if (i == m_table.end ())
+    {
+      return false;
+    }
+  Purge (i->second);
+  if (i->second.m_paths.empty ())
+    {
+      return false;
+    }
+  std::map<Ipv4Address, Path>::iterator best = i->second.m_paths.begin ();
+  for (std::map<Ipv4Address, Path>::iterator j = i->second.m_paths.begin (); j != i->second.m_paths.end (); ++j)
+    {
+      if (j->second.m_metric < best->second.m_metric
+          || (j->second.m_metric == best->second.m_metric && j->second.m_hops < best->second.m_hops))
+        {
+          best = j;
+        }
+    }
+  path = best->second;
+  i->second.m_paths.erase (best);
+  i->second.m_nextHop = path.m_nextHop;
+  i->second.m_lastHop = path.m_lastHop;
+  return true;
+}
+
+Ipv4Address
+MultipathTable::Select (Ipv4Address dst, Ipv4Address primary, uint32_t flow)
+{
+  std::map<Ipv4Address, Paths>::iterator i = m_table.find (dst);
+  if (i == m_table.end ())
+    {
+      return primary;
+    }
+  Purge (i->second);
+  // Every flow goes over the path its hash with the next hop is the highest for
+  uint8_t buf[8];
+  buf[0] = flow >> 24;
+  buf[1] = flow >> 16;
+  buf[2] = flow >> 8;
+  buf[3] = flow;
+  primary.Serialize (buf + 4);
+  Ipv4Address selected = primary;
+  uint32_t highest = Hash32 ((char const *) buf, sizeof (buf));
+  for (std::map<Ipv4Address, Path>::const_iterator j = i->second.m_paths.begin (); j != i->second.m_paths.end (); ++j)
+    {
+      j->first.Serialize (buf + 4);
+      uint32_t weight = Hash32 ((char const *) buf, sizeof (buf));
+      if (weight > highest && j->first != primary)
+        {
+          highest = weight;
+          selected = j->first;
+        }
+    }
+  return selected;
+}
+
+uint32_t
+MultipathTable::GetPathCount (Ipv4Address dst)
+{
+  std::map<Ipv4Address, Paths>::iterator i = m_table.find (dst);
+  if (i == m_table.end ())
+    {
+      return 0;
+    }
+  Purge (i->second);
+  return i->second.m_paths.size ();
+}
+
+uint32_t
+MultipathTable::GetFlowHash (Ipv4Address src, Ipv4Address dst, uint8_t protocol, uint16_t srcPort, uint16_t dstPort)
+{
+  uint8_t buf[13];
+  src.Serialize (buf);
+  dst.Serialize (buf + 4);
+  buf[8] = protocol;
+  buf[9] = srcPort >> 8;
+  buf[10] = srcPort;
+  buf[11] = dstPort >> 8;
+  buf[12] = dstPort;
+  return Hash32 ((char const *) buf, sizeof (buf));
+}
+
+void
+MultipathTable::Purge (Paths & paths)
+{
+  for (std::map<Ipv4Address, Path>::iterator i = paths.m_paths.begin (); i != paths.m_paths.end (); )
+    {
+      if (i->second.m_expire < Simulator::Now ())
+        {
+          paths.m_paths.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+bool
+MultipathTable::IsJoint (Path const & a, Path const & b)
+{
+  return a.m_nextHop == b.m_nextHop
+         || (a.m_lastHop != Ipv4Address () && a.m_lastHop == b.m_lastHop);
+}
+
+}
+}
@@ -0,0 +1,135 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_MULTIPATH_H
+#define SHINGO_MULTIPATH_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Alternate paths kept besides the route of a routing table.
+ *
+ * Keeps up to a maximum number of paths per destination besides the one of
+ * the routing table (the primary path).  A path is only kept if it is link
+ * disjoint from the primary path and from the other paths: it leaves this
+ * node through another neighbor and, when the node next to the destination
+ * is known, reaches the destination through another node (AOMDV, Marina and
+ * Das).  The flows are spread over the paths by rendezvous hashing, so that
+ * a flow keeps its path while the paths of the others come and go.
+ */
+class MultipathTable
+{
+public:
+  /// A path to a destination
+  struct Path
+  {
+    Ipv4Address m_nextHop;    ///< Neighbor the path leaves this node through
+    Ipv4Address m_lastHop;    ///< Node next to the destination, Ipv4Address () if unknown
+    uint16_t m_hops;          ///< Hop count
+    uint16_t m_metric;        ///< Path metric
+    Time m_expire;            ///< Time the path is forgotten
+  };
+
+  /**
+   * constructor
+   * \param maxPaths the maximum number of paths kept per destination, the primary path included
+   */
+  MultipathTable (uint32_t maxPaths = 3);
+  /**
+   * Record the primary path to a destination, which the other paths must be disjoint from
+   * \param dst the destination
+   * \param nextHop the next hop of the primary path
+   * \param lastHop the node next to the destination on the primary path, Ipv4Address () if unknown
+   */
+  void SetPrimary (Ipv4Address dst, Ipv4Address nextHop, Ipv4Address lastHop);
+  /**
+   * Record a path to a destination; the worst path is dropped when there are too many
+   * \param dst the destination
+   * \param path the path
+   * \returns true if the path is kept
+   */
+  bool AddPath (Ipv4Address dst, Path const & path);
+  /**
+   * Forget a path to a destination
+   * \param dst the destination
+   * \param nextHop the next hop of the path
+   */
+  void RemovePath (Ipv4Address dst, Ipv4Address nextHop);
+  /**
+   * Forget the paths to a destination
+   * \param dst the destination
+   */
+  void Clear (Ipv4Address dst);
+  /**
+   * Forget the paths through a lost neighbor
+   * \param neighbor the neighbor
+   */
+  void RemoveNextHop (Ipv4Address neighbor);
+  /**
+   * Take the best path to a destination out of the table, to replace a broken primary path
+   * \param dst the destination
+   * \param path the best path
+   * \returns true if a path is known
+   */
+  bool TakeBestPath (Ipv4Address dst, Path & path);
+  /**
+   * Select the next hop of a flow
+   * \param dst the destination
+   * \param primary the next hop of the primary path
+   * \param flow the hash of the flow
+   * \returns the next hop of the path the flow is sent over
+   */
+  Ipv4Address Select (Ipv4Address dst, Ipv4Address primary, uint32_t flow);
+  /**
+   * \param dst the destination
+   * \returns number of paths to the destination besides the primary one
+   */
+  uint32_t GetPathCount (Ipv4Address dst);
+  /**
+   * \param maxPaths the maximum number of paths kept per destination, the primary path included
+   */
+  void SetMaxPaths (uint32_t maxPaths)
+  {
+    m_maxPaths = maxPaths;
+  }
+  /**
+   * \param src the source of the flow
+   * \param dst the destination of the flow
+   * \param protocol the transport protocol
+   * \param srcPort the source port, 0 if unknown
+   * \param dstPort the destination port, 0 if unknown
+   * \returns the hash of the flow
+   */
+  static uint32_t GetFlowHash (Ipv4Address src, Ipv4Address dst, uint8_t protocol, uint16_t srcPort, uint16_t dstPort);
+
+private:
+  /// Paths to a destination
+  struct Paths
+  {
+    Ipv4Address m_nextHop;                  ///< Next hop of the primary path
+    Ipv4Address m_lastHop;                  ///< Last hop of the primary path
+    std::map<Ipv4Address, Path> m_paths;    ///< Other paths by next hop
+  };
+  /// Forget the expired paths to a destination
+  void Purge (Paths & paths);
+  /**
+   * \param a a path
+   * \param b another path
+   * \returns true if the paths share a link
+   */
+  static bool IsJoint (Path const & a, Path const & b);
+  /// Paths by destination
+  std::map<Ipv4Address, Paths> m_table;
+  /// Maximum number of paths per destination, the primary path included
+  uint32_t m_maxPaths;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_MULTIPATH_H */
@@ -114,6 +114,13 @@ struct CloseNeighbor
   }
 };
 
+uint32_t
+Neighbors::GetSize () const
+{
+  CloseNeighbor pred;
+  return m_nb.size () - std::count_if (m_nb.begin (), m_nb.end (), pred);
+}
+
 void
 Neighbors::Purge ()
 {
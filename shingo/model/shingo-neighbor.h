@@ -101,6 +101,10 @@ public:
    * \param expire the expire time for the address
    */
   void Update (Ipv4Address addr, Time expire);
+  /**
+   * \returns the number of neighbors that have not expired
+   */
+  uint32_t GetSize () const;
   /// Remove all expired entries
   void Purge ();
   /// Schedule m_ntimer.
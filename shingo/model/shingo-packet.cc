@@ -1,6 +1,7 @@
 #include "shingo-packet.h"
 #include "ns3/address-utils.h"
 #include "ns3/packet.h"
+#include <algorithm>
 
 namespace ns3
 {
@@ -56,6 +57,10 @@ TypeHeader::Deserialize (Buffer::Iterator start)
     case SHINGO_RREQ:
     case SHINGO_RREP:
     case SHINGO_RREP_ACK:
+    case SHINGO_ZONE_SOLICIT:
+    case SHINGO_NEIGHBOR_SET:
+    case SHINGO_SINK_BEACON:
+    case SHINGO_RERR:
       {
         m_type = (MessageType) type;
         break;
@@ -94,6 +99,26 @@ TypeHeader::Print (std::ostream &os) const
         os << "RREP_ACK";
         break;
       }
+    case SHINGO_ZONE_SOLICIT:
+      {
+        os << "ZONE_SOLICIT";
+        break;
+      }
+    case SHINGO_NEIGHBOR_SET:
+      {
+        os << "NEIGHBOR_SET";
+        break;
+      }
+    case SHINGO_SINK_BEACON:
+      {
+        os << "SINK_BEACON";
+        break;
+      }
+    case SHINGO_RERR:
+      {
+        os << "RERR";
+        break;
+      }
     default:
       os << "UNKNOWN_TYPE";
     }
@@ -115,10 +140,11 @@ operator<< (std::ostream & os, TypeHeader const & h)
 
 NS_OBJECT_ENSURE_REGISTERED (IarpHeader);
 
-IarpHeader::IarpHeader (Ipv4Address dst, uint32_t hopCount, uint32_t dstSeqNo)
+IarpHeader::IarpHeader (Ipv4Address dst, uint32_t hopCount, uint32_t dstSeqNo, uint16_t metric)
   : m_dst (dst),
     m_hopCount (hopCount),
-    m_dstSeqNo (dstSeqNo)
+    m_dstSeqNo (dstSeqNo),
+    m_metric (metric)
 {
 }
 
@@ -153,7 +179,8 @@ void
 IarpHeader::Serialize (Buffer::Iterator i) const //パケットタイプヘッダのカプセル化処理
 {
   WriteTo (i, m_dst);
-  i.WriteHtonU32 (m_hopCount);
+  i.WriteHtonU16 (m_hopCount);
+  i.WriteHtonU16 (m_metric);
   i.WriteHtonU32 (m_dstSeqNo);
 
 }
@@ -164,7 +191,8 @@ IarpHeader::Deserialize (Buffer::Iterator start) //パケットタイプデヘ
   Buffer::Iterator i = start;
 
   ReadFrom (i, m_dst);
-  m_hopCount = i.ReadNtohU32 ();
+  m_hopCount = i.ReadNtohU16 ();
+  m_metric = i.ReadNtohU16 ();
   m_dstSeqNo = i.ReadNtohU32 ();
 
   uint32_t dist = i.GetDistanceFrom (start);
@@ -178,6 +206,7 @@ IarpHeader::Print (std::ostream &os) const
 {
   os << "DestinationIpv4: " << m_dst
      << " Hopcount: " << m_hopCount
+     << " Metric: " << m_metric
      << " SequenceNumber: " << m_dstSeqNo;
 }
 
@@ -188,6 +217,253 @@ operator<< (std::ostream & os, IarpHeader const & h)
   return os;
 }
 
+//-----------------------------------------------------------------------------
+// IARP update
+//-----------------------------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED (IarpUpdateHeader);
+
+IarpUpdateHeader::IarpUpdateHeader (Time holdTime, uint8_t load)
+  : m_holdTime (holdTime.GetMilliSeconds ()),
+    m_load (load)
+{
+}
+
+TypeId
+IarpUpdateHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::IarpUpdateHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<IarpUpdateHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+IarpUpdateHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+IarpUpdateHeader::GetSerializedSize () const
+{
+  return 8;
+}
+
+void
+IarpUpdateHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteHtonU32 (m_holdTime);
+  i.WriteU8 (m_load);
+  i.WriteU8 (0);
+  i.WriteU16 (0);
+}
+
+uint32_t
+IarpUpdateHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  m_holdTime = i.ReadNtohU32 ();
+  m_load = i.ReadU8 ();
+  i.ReadU8 ();
+  i.ReadU16 ();
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+IarpUpdateHeader::Print (std::ostream &os) const
+{
+  os << "HoldTime: " << m_holdTime << "ms Load: " << uint32_t (m_load);
+}
+
+std::ostream &
+operator<< (std::ostream & os, IarpUpdateHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// Neighbor set
+//-----------------------------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED (NeighborSetHeader);
+
+NeighborSetHeader::NeighborSetHeader (Ipv4Address origin, uint32_t seqNo, uint8_t hopsLeft)
+  : m_origin (origin),
+    m_seqNo (seqNo),
+    m_hopsLeft (hopsLeft)
+{
+}
+
+TypeId
+NeighborSetHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::NeighborSetHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<NeighborSetHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+NeighborSetHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+NeighborSetHeader::GetSerializedSize () const
+{
+  return 12 + 4 * m_neighbors.size ();
+}
+
+bool
+NeighborSetHeader::AddNeighbor (Ipv4Address neighbor)
+{
+  if (m_neighbors.size () == 255)
+    {
+      return false;
+    }
+  m_neighbors.push_back (neighbor);
+  return true;
+}
+
+void
+NeighborSetHeader::Serialize (Buffer::Iterator i) const
+{
+  WriteTo (i, m_origin);
+  i.WriteHtonU32 (m_seqNo);
+  i.WriteU8 (m_hopsLeft);
+  i.WriteU8 (m_neighbors.size ());
+  i.WriteU16 (0);
+  for (std::vector<Ipv4Address>::const_iterator j = m_neighbors.begin (); j != m_neighbors.end (); ++j)
+    {
+      WriteTo (i, *j);
+    }
+}
+
+uint32_t
+NeighborSetHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  ReadFrom (i, m_origin);
+  m_seqNo = i.ReadNtohU32 ();
+  m_hopsLeft = i.ReadU8 ();
+  uint8_t count = i.ReadU8 ();
+  i.ReadU16 ();
+  m_neighbors.clear ();
+  for (uint8_t k = 0; k < count; ++k)
+    {
+      Ipv4Address neighbor;
+      ReadFrom (i, neighbor);
+      m_neighbors.push_back (neighbor);
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+NeighborSetHeader::Print (std::ostream &os) const
+{
+  os << "Origin: " << m_origin << " SequenceNumber: " << m_seqNo
+     << " HopsLeft: " << (uint32_t) m_hopsLeft << " Neighbors:";
+  for (std::vector<Ipv4Address>::const_iterator j = m_neighbors.begin (); j != m_neighbors.end (); ++j)
+    {
+      os << " " << *j;
+    }
+}
+
+std::ostream &
+operator<< (std::ostream & os, NeighborSetHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// SINK_BEACON
+//-----------------------------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED (SinkBeaconHeader);
+
+SinkBeaconHeader::SinkBeaconHeader (Ipv4Address sink, uint32_t seqNo, uint8_t hopCount)
+  : m_sink (sink),
+    m_seqNo (seqNo),
+    m_hopCount (hopCount)
+{
+}
+
+TypeId
+SinkBeaconHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::SinkBeaconHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<SinkBeaconHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+SinkBeaconHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SinkBeaconHeader::GetSerializedSize () const
+{
+  return 12;
+}
+
+void
+SinkBeaconHeader::Serialize (Buffer::Iterator i) const
+{
+  WriteTo (i, m_sink);
+  i.WriteHtonU32 (m_seqNo);
+  i.WriteU8 (m_hopCount);
+  i.WriteU8 (0);
+  i.WriteU16 (0);
+}
+
+uint32_t
+SinkBeaconHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  ReadFrom (i, m_sink);
+  m_seqNo = i.ReadNtohU32 ();
+  m_hopCount = i.ReadU8 ();
+  i.ReadU8 ();
+  i.ReadU16 ();
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+SinkBeaconHeader::Print (std::ostream &os) const
+{
+  os << "Sink: " << m_sink << " SequenceNumber: " << m_seqNo
+     << " HopCount: " << (uint32_t) m_hopCount;
+}
+
+std::ostream &
+operator<< (std::ostream & os, SinkBeaconHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
 //-----------------------------------------------------------------------------
 // RREQ
 //-----------------------------------------------------------------------------
@@ -200,7 +476,9 @@ RreqHeader::RreqHeader (uint8_t flags, uint8_t reserved, uint8_t hopCount, uint3
     m_dst (dst),
     m_dstSeqNo (dstSeqNo),
     m_origin (origin),
-    m_originSeqNo (originSeqNo)/*,
+    m_originSeqNo (originSeqNo),
+    m_metric (0),
+    m_firstHop (Ipv4Address ())/*,
     m_rad(rad)*/
 {
 }
@@ -227,13 +505,13 @@ RreqHeader::GetInstanceTypeId () const
 uint32_t
 RreqHeader::GetSerializedSize () const
 {
-  return 23;
+  return 29 + (m_destinations.empty () ? 0 : 4 + 12 * m_destinations.size ());
 }
 
 void
 RreqHeader::Serialize (Buffer::Iterator i) const
 {
-  i.WriteU8 (m_flags);
+  i.WriteU8 (m_destinations.empty () ? m_flags : m_flags | 1);
   i.WriteU8 (m_reserved);
   i.WriteU8 (m_hopCount);
   i.WriteHtonU32 (m_requestID);
@@ -241,7 +519,24 @@ RreqHeader::Serialize (Buffer::Iterator i) const
   i.WriteHtonU32 (m_dstSeqNo);
   WriteTo (i, m_origin);
   i.WriteHtonU32 (m_originSeqNo);
+  i.WriteHtonU16 (m_metric);
+  WriteTo (i, m_firstHop);
   //WriteTo (i, m_rad);
+  if (m_destinations.empty ())
+    {
+      return;
+    }
+  i.WriteU8 (m_destinations.size ());
+  i.WriteU8 (0);
+  i.WriteU16 (0);
+  for (std::vector<Destination>::const_iterator j = m_destinations.begin (); j != m_destinations.end (); ++j)
+    {
+      WriteTo (i, j->m_dst);
+      i.WriteHtonU32 (j->m_dstSeqNo);
+      i.WriteU8 ((j->m_destinationOnly ? (1 << 7) : 0) | (j->m_unknownSeqNo ? (1 << 6) : 0));
+      i.WriteU8 (0);
+      i.WriteU16 (0);
+    }
 }
 
 uint32_t
@@ -256,7 +551,29 @@ RreqHeader::Deserialize (Buffer::Iterator start)
   m_dstSeqNo = i.ReadNtohU32 ();
   ReadFrom (i, m_origin);
   m_originSeqNo = i.ReadNtohU32 ();
+  m_metric = i.ReadNtohU16 ();
+  ReadFrom (i, m_firstHop);
   //ReadFrom (i, m_rad);
+  m_destinations.clear ();
+  if (m_flags & 1)
+    {
+      m_flags &= ~1;
+      uint8_t destinations = i.ReadU8 ();
+      i.ReadU8 ();
+      i.ReadU16 ();
+      for (uint8_t k = 0; k < destinations; ++k)
+        {
+          Destination d;
+          ReadFrom (i, d.m_dst);
+          d.m_dstSeqNo = i.ReadNtohU32 ();
+          uint8_t flags = i.ReadU8 ();
+          d.m_destinationOnly = flags & (1 << 7);
+          d.m_unknownSeqNo = flags & (1 << 6);
+          i.ReadU8 ();
+          i.ReadU16 ();
+          m_destinations.push_back (d);
+        }
+    }
 
   uint32_t dist = i.GetDistanceFrom (start);
   NS_ASSERT (dist == GetSerializedSize ());
@@ -269,9 +586,19 @@ RreqHeader::Print (std::ostream &os) const
   os << "RREQ ID " << m_requestID << " destination: ipv4 " << m_dst
      << " sequence number " << m_dstSeqNo << " source: ipv4 "
      << m_origin << " sequence number " << m_originSeqNo
+     << " TTL " << (uint16_t) m_reserved
+     << " metric " << m_metric
+     << " first hop " << m_firstHop
      << " flags:" << " Gratuitous RREP " << (*this).GetGratuitousRrep ()
      << " Destination only " << (*this).GetDestinationOnly ()
-     << " Unknown sequence number " << (*this).GetUnknownSeqno ();
+     << " Unknown sequence number " << (*this).GetUnknownSeqno ()
+     << " Bordercast " << (*this).GetBordercast ()
+     << " Multipoint relay " << (*this).GetMprFlood ();
+  for (std::vector<Destination>::const_iterator j = m_destinations.begin (); j != m_destinations.end (); ++j)
+    {
+      os << " destination: ipv4 " << j->m_dst << " sequence number " << j->m_dstSeqNo
+         << " Destination only " << j->m_destinationOnly << " Unknown sequence number " << j->m_unknownSeqNo;
+    }
 }
 
 std::ostream &
@@ -338,81 +665,396 @@ RreqHeader::GetUnknownSeqno () const
   return (m_flags & (1 << 3));
 }
 
+void
+RreqHeader::SetBordercast (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 2);
+    }
+  else
+    {
+      m_flags &= ~(1 << 2);
+    }
+}
+
+bool
+RreqHeader::GetBordercast () const
+{
+  return (m_flags & (1 << 2));
+}
+
+void
+RreqHeader::SetMprFlood (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 1);
+    }
+  else
+    {
+      m_flags &= ~(1 << 1);
+    }
+}
+
+bool
+RreqHeader::GetMprFlood () const
+{
+  return (m_flags & (1 << 1));
+}
+
+bool
+RreqHeader::AddDestination (Ipv4Address dst, uint32_t dstSeqNo, bool destinationOnly, bool unknownSeqNo)
+{
+  if (m_destinations.size () == 255)
+    {
+      return false;
+    }
+  Destination d;
+  d.m_dst = dst;
+  d.m_dstSeqNo = dstSeqNo;
+  d.m_destinationOnly = destinationOnly;
+  d.m_unknownSeqNo = unknownSeqNo;
+  m_destinations.push_back (d);
+  return true;
+}
+
 bool
 RreqHeader::operator== (RreqHeader const & o) const
 {
+  if (m_destinations.size () != o.m_destinations.size ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < m_destinations.size (); ++k)
+    {
+      if (m_destinations[k].m_dst != o.m_destinations[k].m_dst || m_destinations[k].m_dstSeqNo != o.m_destinations[k].m_dstSeqNo
+          || m_destinations[k].m_destinationOnly != o.m_destinations[k].m_destinationOnly
+          || m_destinations[k].m_unknownSeqNo != o.m_destinations[k].m_unknownSeqNo)
+        {
+          return false;
+        }
+    }
   return (m_flags == o.m_flags && m_reserved == o.m_reserved
           && m_hopCount == o.m_hopCount && m_requestID == o.m_requestID
           && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
-          && m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo /*&& m_rad == o.m_rad*/);
+          && m_origin == o.m_origin && m_originSeqNo == o.m_originSeqNo && m_metric == o.m_metric
+          && m_firstHop == o.m_firstHop /*&& m_rad == o.m_rad*/);
 }
 
 
 //-----------------------------------------------------------------------------
-// RREP
+// Bordercast
 //-----------------------------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED (BordercastHeader);
 
-RrepHeader::RrepHeader (uint8_t prefixSize, uint8_t hopCount, Ipv4Address dst,
-                        uint32_t dstSeqNo, Ipv4Address origin, Time lifeTime)
-  : m_flags (0),
-    m_prefixSize (prefixSize),
-    m_hopCount (hopCount),
-    m_dst (dst),
-    m_dstSeqNo (dstSeqNo),
-    m_origin (origin)
+BordercastHeader::BordercastHeader (Ipv4Address bordercaster, uint8_t hopsLeft)
+  : m_bordercaster (bordercaster),
+    m_hopsLeft (hopsLeft)
 {
-  m_lifeTime = uint32_t (lifeTime.GetMilliSeconds ());
 }
 
-NS_OBJECT_ENSURE_REGISTERED (RrepHeader);
-
 TypeId
-RrepHeader::GetTypeId ()
+BordercastHeader::GetTypeId ()
 {
-  static TypeId tid = TypeId ("ns3::shingo::RrepHeader")
+  static TypeId tid = TypeId ("ns3::shingo::BordercastHeader")
     .SetParent<Header> ()
     .SetGroupName ("Shingo")
-    .AddConstructor<RrepHeader> ()
+    .AddConstructor<BordercastHeader> ()
   ;
   return tid;
 }
 
 TypeId
-RrepHeader::GetInstanceTypeId () const
+BordercastHeader::GetInstanceTypeId () const
 {
   return GetTypeId ();
 }
 
 uint32_t
-RrepHeader::GetSerializedSize () const
+BordercastHeader::GetSerializedSize () const
 {
-  return 19;
+  return 8 + 4 * (m_targets.size () + m_relays.size ());
 }
 
-void
-RrepHeader::Serialize (Buffer::Iterator i) const
+bool
+BordercastHeader::AddTarget (Ipv4Address target)
 {
-  i.WriteU8 (m_flags);
-  i.WriteU8 (m_prefixSize);
-  i.WriteU8 (m_hopCount);
-  WriteTo (i, m_dst);
-  i.WriteHtonU32 (m_dstSeqNo);
-  WriteTo (i, m_origin);
-  i.WriteHtonU32 (m_lifeTime);
+  if (m_targets.size () == 255)
+    {
+      return false;
+    }
+  m_targets.push_back (target);
+  return true;
 }
 
-uint32_t
-RrepHeader::Deserialize (Buffer::Iterator start)
+bool
+BordercastHeader::AddRelay (Ipv4Address relay)
 {
-  Buffer::Iterator i = start;
+  if (IsRelay (relay))
+    {
+      return true;
+    }
+  if (m_relays.size () == 255)
+    {
+      return false;
+    }
+  m_relays.push_back (relay);
+  return true;
+}
 
-  m_flags = i.ReadU8 ();
+bool
+BordercastHeader::IsTarget (Ipv4Address address) const
+{
+  return std::find (m_targets.begin (), m_targets.end (), address) != m_targets.end ();
+}
+
+bool
+BordercastHeader::IsRelay (Ipv4Address address) const
+{
+  return std::find (m_relays.begin (), m_relays.end (), address) != m_relays.end ();
+}
+
+void
+BordercastHeader::Serialize (Buffer::Iterator i) const
+{
+  WriteTo (i, m_bordercaster);
+  i.WriteU8 (m_hopsLeft);
+  i.WriteU8 (m_targets.size ());
+  i.WriteU8 (m_relays.size ());
+  i.WriteU8 (0);
+  for (std::vector<Ipv4Address>::const_iterator j = m_targets.begin (); j != m_targets.end (); ++j)
+    {
+      WriteTo (i, *j);
+    }
+  for (std::vector<Ipv4Address>::const_iterator j = m_relays.begin (); j != m_relays.end (); ++j)
+    {
+      WriteTo (i, *j);
+    }
+}
+
+uint32_t
+BordercastHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  ReadFrom (i, m_bordercaster);
+  m_hopsLeft = i.ReadU8 ();
+  uint8_t targets = i.ReadU8 ();
+  uint8_t relays = i.ReadU8 ();
+  i.ReadU8 ();
+  m_targets.clear ();
+  for (uint8_t k = 0; k < targets; ++k)
+    {
+      Ipv4Address target;
+      ReadFrom (i, target);
+      m_targets.push_back (target);
+    }
+  m_relays.clear ();
+  for (uint8_t k = 0; k < relays; ++k)
+    {
+      Ipv4Address relay;
+      ReadFrom (i, relay);
+      m_relays.push_back (relay);
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+BordercastHeader::Print (std::ostream &os) const
+{
+  os << "Bordercaster: " << m_bordercaster << " HopsLeft: " << (uint32_t) m_hopsLeft << " Targets:";
+  for (std::vector<Ipv4Address>::const_iterator j = m_targets.begin (); j != m_targets.end (); ++j)
+    {
+      os << " " << *j;
+    }
+  os << " Relays:";
+  for (std::vector<Ipv4Address>::const_iterator j = m_relays.begin (); j != m_relays.end (); ++j)
+    {
+      os << " " << *j;
+    }
+}
+
+std::ostream &
+operator<< (std::ostream & os, BordercastHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// Multipoint relays
+//-----------------------------------------------------------------------------
+NS_OBJECT_ENSURE_REGISTERED (MprSetHeader);
+
+MprSetHeader::MprSetHeader ()
+{
+}
+
+TypeId
+MprSetHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::MprSetHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<MprSetHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MprSetHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+MprSetHeader::GetSerializedSize () const
+{
+  return 4 + 4 * m_relays.size ();
+}
+
+bool
+MprSetHeader::AddRelay (Ipv4Address relay)
+{
+  if (m_relays.size () == 255)
+    {
+      return false;
+    }
+  m_relays.push_back (relay);
+  return true;
+}
+
+bool
+MprSetHeader::IsRelay (Ipv4Address address) const
+{
+  return std::find (m_relays.begin (), m_relays.end (), address) != m_relays.end ();
+}
+
+void
+MprSetHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 (m_relays.size ());
+  i.WriteU8 (0);
+  i.WriteU16 (0);
+  for (std::vector<Ipv4Address>::const_iterator j = m_relays.begin (); j != m_relays.end (); ++j)
+    {
+      WriteTo (i, *j);
+    }
+}
+
+uint32_t
+MprSetHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  uint8_t relays = i.ReadU8 ();
+  i.ReadU8 ();
+  i.ReadU16 ();
+  m_relays.clear ();
+  for (uint8_t k = 0; k < relays; ++k)
+    {
+      Ipv4Address relay;
+      ReadFrom (i, relay);
+      m_relays.push_back (relay);
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+MprSetHeader::Print (std::ostream &os) const
+{
+  os << "Relays:";
+  for (std::vector<Ipv4Address>::const_iterator j = m_relays.begin (); j != m_relays.end (); ++j)
+    {
+      os << " " << *j;
+    }
+}
+
+std::ostream &
+operator<< (std::ostream & os, MprSetHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
+//-----------------------------------------------------------------------------
+// RREP
+//-----------------------------------------------------------------------------
+
+RrepHeader::RrepHeader (uint8_t prefixSize, uint8_t hopCount, Ipv4Address dst,
+                        uint32_t dstSeqNo, Ipv4Address origin, Time lifeTime)
+  : m_flags (0),
+    m_prefixSize (prefixSize),
+    m_hopCount (hopCount),
+    m_dst (dst),
+    m_dstSeqNo (dstSeqNo),
+    m_origin (origin),
+    m_metric (0),
+    m_expiration (0xffff)
+{
+  m_lifeTime = uint32_t (lifeTime.GetMilliSeconds ());
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RrepHeader);
+
+TypeId
+RrepHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::RrepHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<RrepHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RrepHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RrepHeader::GetSerializedSize () const
+{
+  return 23;
+}
+
+void
+RrepHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteU8 (m_flags);
+  i.WriteU8 (m_prefixSize);
+  i.WriteU8 (m_hopCount);
+  WriteTo (i, m_dst);
+  i.WriteHtonU32 (m_dstSeqNo);
+  WriteTo (i, m_origin);
+  i.WriteHtonU32 (m_lifeTime);
+  i.WriteHtonU16 (m_metric);
+  i.WriteHtonU16 (m_expiration);
+}
+
+uint32_t
+RrepHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  m_flags = i.ReadU8 ();
   m_prefixSize = i.ReadU8 ();
   m_hopCount = i.ReadU8 ();
   ReadFrom (i, m_dst);
   m_dstSeqNo = i.ReadNtohU32 ();
   ReadFrom (i, m_origin);
   m_lifeTime = i.ReadNtohU32 ();
+  m_metric = i.ReadNtohU16 ();
+  m_expiration = i.ReadNtohU16 ();
 
   uint32_t dist = i.GetDistanceFrom (start);
   NS_ASSERT (dist == GetSerializedSize ());
@@ -427,10 +1069,23 @@ RrepHeader::Print (std::ostream &os) const
     {
       os << " prefix size " << m_prefixSize;
     }
-  os << " source ipv4 " << m_origin << " lifetime " << m_lifeTime
+  os << " source ipv4 " << m_origin << " lifetime " << m_lifeTime << " metric " << m_metric
+     << " expiration " << m_expiration
      << " acknowledgment required flag " << (*this).GetAckRequired ();
 }
 
+void
+RrepHeader::SetExpiration (Time expiration)
+{
+  m_expiration = expiration < MilliSeconds (0xffff) ? uint16_t (expiration.GetMilliSeconds ()) : 0xffff;
+}
+
+Time
+RrepHeader::GetExpiration () const
+{
+  return m_expiration == 0xffff ? Time::Max () : MilliSeconds (m_expiration);
+}
+
 void
 RrepHeader::SetLifeTime (Time t)
 {
@@ -463,6 +1118,25 @@ RrepHeader::GetAckRequired () const
   return (m_flags & (1 << 6));
 }
 
+void
+RrepHeader::SetMobility (bool f)
+{
+  if (f)
+    {
+      m_flags |= (1 << 5);
+    }
+  else
+    {
+      m_flags &= ~(1 << 5);
+    }
+}
+
+bool
+RrepHeader::GetMobility () const
+{
+  return (m_flags & (1 << 5));
+}
+
 void
 RrepHeader::SetPrefixSize (uint8_t sz)
 {
@@ -480,7 +1154,8 @@ RrepHeader::operator== (RrepHeader const & o) const
 {
   return (m_flags == o.m_flags && m_prefixSize == o.m_prefixSize
           && m_hopCount == o.m_hopCount && m_dst == o.m_dst && m_dstSeqNo == o.m_dstSeqNo
-          && m_origin == o.m_origin && m_lifeTime == o.m_lifeTime);
+          && m_origin == o.m_origin && m_lifeTime == o.m_lifeTime && m_metric == o.m_metric
+          && m_expiration == o.m_expiration);
 }
 
 void
@@ -493,6 +1168,8 @@ RrepHeader::SetHello (Ipv4Address origin, uint32_t srcSeqNo, Time lifetime)
   m_dstSeqNo = srcSeqNo;
   m_origin = origin;
   m_lifeTime = lifetime.GetMilliSeconds ();
+  m_metric = 0;
+  m_expiration = 0xffff;
 }
 
 std::ostream &
@@ -502,6 +1179,92 @@ operator<< (std::ostream & os, RrepHeader const & h)
   return os;
 }
 
+//-----------------------------------------------------------------------------
+// Position
+//-----------------------------------------------------------------------------
+
+PositionHeader::PositionHeader (Vector position, Vector velocity)
+  : m_x (int32_t (position.x * 100)),
+    m_y (int32_t (position.y * 100)),
+    m_vx (int16_t (velocity.x * 100)),
+    m_vy (int16_t (velocity.y * 100))
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (PositionHeader);
+
+TypeId
+PositionHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::PositionHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<PositionHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+PositionHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PositionHeader::GetSerializedSize () const
+{
+  return 12;
+}
+
+void
+PositionHeader::Serialize (Buffer::Iterator i) const
+{
+  i.WriteHtonU32 (uint32_t (m_x));
+  i.WriteHtonU32 (uint32_t (m_y));
+  i.WriteHtonU16 (uint16_t (m_vx));
+  i.WriteHtonU16 (uint16_t (m_vy));
+}
+
+uint32_t
+PositionHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+
+  m_x = int32_t (i.ReadNtohU32 ());
+  m_y = int32_t (i.ReadNtohU32 ());
+  m_vx = int16_t (i.ReadNtohU16 ());
+  m_vy = int16_t (i.ReadNtohU16 ());
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+PositionHeader::Print (std::ostream &os) const
+{
+  os << "Position: " << GetPosition () << " velocity: " << GetVelocity ();
+}
+
+Vector
+PositionHeader::GetPosition () const
+{
+  return Vector (m_x / 100.0, m_y / 100.0, 0);
+}
+
+Vector
+PositionHeader::GetVelocity () const
+{
+  return Vector (m_vx / 100.0, m_vy / 100.0, 0);
+}
+
+std::ostream &
+operator<< (std::ostream & os, PositionHeader const & h)
+{
+  h.Print (os);
+  return os;
+}
+
 
 RrepAckHeader::RrepAckHeader ()
   : m_reserved (0)
@@ -567,6 +1330,174 @@ operator<< (std::ostream & os, RrepAckHeader const & h )
   return os;
 }
 
+//-----------------------------------------------------------------------------
+// RERR
+//-----------------------------------------------------------------------------
+RerrHeader::RerrHeader ()
+  : m_flag (0),
+    m_reserved (0)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (RerrHeader);
+
+TypeId
+RerrHeader::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::shingo::RerrHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Shingo")
+    .AddConstructor<RerrHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+RerrHeader::GetInstanceTypeId () const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+RerrHeader::GetSerializedSize () const
+{
+  return (3 + 8 * GetDestCount ());
+}
+
+void
+RerrHeader::Serialize (Buffer::Iterator i ) const
+{
+  i.WriteU8 (m_flag);
+  i.WriteU8 (m_reserved);
+  i.WriteU8 (GetDestCount ());
+  std::map<Ipv4Address, uint32_t>::const_iterator j;
+  for (j = m_unreachableDstSeqNo.begin (); j != m_unreachableDstSeqNo.end (); ++j)
+    {
+      WriteTo (i, (*j).first);
+      i.WriteHtonU32 ((*j).second);
+    }
+}
+
+uint32_t
+RerrHeader::Deserialize (Buffer::Iterator start )
+{
+  Buffer::Iterator i = start;
+  m_flag = i.ReadU8 ();
+  m_reserved = i.ReadU8 ();
+  uint8_t dest = i.ReadU8 ();
+  m_unreachableDstSeqNo.clear ();
+  Ipv4Address address;
+  uint32_t seqNo;
+  for (uint8_t k = 0; k < dest; ++k)
+    {
+      ReadFrom (i, address);
+      seqNo = i.ReadNtohU32 ();
+      m_unreachableDstSeqNo.insert (std::make_pair (address, seqNo));
+    }
+
+  uint32_t dist = i.GetDistanceFrom (start);
+  NS_ASSERT (dist == GetSerializedSize ());
+  return dist;
+}
+
+void
+RerrHeader::Print (std::ostream &os ) const
+{
+  os << "Unreachable destination (ipv4 address, seq. number):";
+  std::map<Ipv4Address, uint32_t>::const_iterator j;
+  for (j = m_unreachableDstSeqNo.begin (); j != m_unreachableDstSeqNo.end (); ++j)
+    {
+      os << (*j).first << ", " << (*j).second;
+    }
+  os << "No delete flag " << (*this).GetNoDelete ();
+}
+
+void
+RerrHeader::SetNoDelete (bool f )
+{
+  if (f)
+    {
+      m_flag |= (1 << 0);
+    }
+  else
+    {
+      m_flag &= ~(1 << 0);
+    }
+}
+
+bool
+RerrHeader::GetNoDelete () const
+{
+  return (m_flag & (1 << 0));
+}
+
+bool
+RerrHeader::AddUnDestination (Ipv4Address dst, uint32_t seqNo )
+{
+  if (m_unreachableDstSeqNo.find (dst) != m_unreachableDstSeqNo.end ())
+    {
+      return true;
+    }
+
+  if (GetDestCount () == 255) // can't support more than 255 destinations in single RERR
+    {
+      return false;
+    }
+  m_unreachableDstSeqNo.insert (std::make_pair (dst, seqNo));
+  return true;
+}
+
+bool
+RerrHeader::RemoveUnDestination (std::pair<Ipv4Address, uint32_t> & un )
+{
+  if (m_unreachableDstSeqNo.empty ())
+    {
+      return false;
+    }
+  std::map<Ipv4Address, uint32_t>::iterator it = m_unreachableDstSeqNo.begin ();
+  un = *it;
+  m_unreachableDstSeqNo.erase (it);
+  return true;
+}
+
+void
+RerrHeader::Clear ()
+{
+  m_unreachableDstSeqNo.clear ();
+  m_flag = 0;
+  m_reserved = 0;
+}
+
+bool
+RerrHeader::operator== (RerrHeader const & o ) const
+{
+  if (m_flag != o.m_flag || m_reserved != o.m_reserved || GetDestCount () != o.GetDestCount ())
+    {
+      return false;
+    }
+
+  std::map<Ipv4Address, uint32_t>::const_iterator j = m_unreachableDstSeqNo.begin ();
+  std::map<Ipv4Address, uint32_t>::const_iterator k = o.m_unreachableDstSeqNo.begin ();
+  for (uint8_t i = 0; i < GetDestCount (); ++i)
+    {
+      if ((j->first != k->first) || (j->second != k->second))
+        {
+          return false;
+        }
+
+      j++;
+      k++;
+    }
+  return true;
+}
+
+std::ostream &
+operator<< (std::ostream & os, RerrHeader const & h )
+{
+  h.Print (os);
+  return os;
+}
+
 
 
 }
@@ -3,10 +3,12 @@
 
 #include <iostream>
 #include <map>
+#include <vector>
 #include "ns3/header.h"
 #include "ns3/enum.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 namespace shingo {
@@ -17,7 +19,11 @@ enum MessageType
  SHINGO_IARP  = 1,
  SHINGO_RREQ  = 2,
  SHINGO_RREP  = 3,
- SHINGO_RREP_ACK = 4 
+ SHINGO_RREP_ACK = 4,
+ SHINGO_ZONE_SOLICIT = 5, ///< newly started node asks its neighbors for their zone tables
+ SHINGO_NEIGHBOR_SET = 6, ///< one-hop neighbor set of the link-state zone engine
+ SHINGO_SINK_BEACON = 7, ///< gradient beacon flooded by the sink of the collection tree
+ SHINGO_RERR = 8 ///< route error listing the destinations a link break made unreachable
 };
 
 
@@ -81,7 +87,7 @@ private:
  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  |                      Destination Address                      |
  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
- |                            HopCount                           |
+ |           HopCount            |            Metric             |
  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  |                       Sequence Number                         |
  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -97,8 +103,9 @@ class IarpHeader : public Header
    * \param dst destination IP address
    * \param hopcount hop count
    * \param dstSeqNo destination sequence number
+   * \param metric path metric of the advertiser to the destination
    */
-  IarpHeader (Ipv4Address dst = Ipv4Address (), uint32_t hopcount = 0, uint32_t dstSeqNo = 0);
+  IarpHeader (Ipv4Address dst = Ipv4Address (), uint32_t hopcount = 0, uint32_t dstSeqNo = 0, uint16_t metric = 0);
   virtual ~IarpHeader ();
  static  TypeId GetTypeId ();
  TypeId  GetInstanceTypeId () const;
@@ -169,14 +176,306 @@ class IarpHeader : public Header
   {
     return m_dstSeqNo;
   }
+  /**
+   * Set the path metric, the sum of the link costs from the advertiser to the destination
+   * \param metric the path metric
+   */
+  void
+  SetMetric (uint16_t metric)
+  {
+    m_metric = metric;
+  }
+  /**
+   * Get the path metric
+   * \returns the path metric
+   */
+  uint16_t
+  GetMetric () const
+  {
+    return m_metric;
+  }
 
  private:
   Ipv4Address m_dst; ///< Destination IP Address
   uint32_t m_hopCount; ///< Number of Hops
   uint32_t m_dstSeqNo; ///< Destination Sequence Number
+  uint16_t m_metric; ///< Path metric of the advertiser
 };
 std::ostream & operator<< (std::ostream & os, const IarpHeader & packet);
 
+/**
+ * \ingroup iarp
+ * \brief IARP update header, sent once in front of the IarpHeader entries
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Hold Time (ms)                         |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |     Load      |                   Reserved                    |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * The hold time is how long the receivers keep the advertised entries
+ * without hearing from the sender again.  It follows the adaptive periodic
+ * update interval of the sender.  The load is how full the queues of the
+ * sender are, from 0 (empty) to 255 (full).
+ */
+class IarpUpdateHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param holdTime hold time of the advertised entries
+   * \param load load of the sender
+   */
+  IarpUpdateHeader (Time holdTime = MilliSeconds (0), uint8_t load = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * Set the hold time
+   * \param holdTime the hold time
+   */
+  void
+  SetHoldTime (Time holdTime)
+  {
+    m_holdTime = holdTime.GetMilliSeconds ();
+  }
+  /**
+   * Get the hold time
+   * \returns the hold time
+   */
+  Time
+  GetHoldTime () const
+  {
+    return MilliSeconds (m_holdTime);
+  }
+  /**
+   * Set the load
+   * \param load the load of the sender
+   */
+  void
+  SetLoad (uint8_t load)
+  {
+    m_load = load;
+  }
+  /**
+   * Get the load
+   * \returns the load of the sender
+   */
+  uint8_t
+  GetLoad () const
+  {
+    return m_load;
+  }
+
+private:
+  uint32_t m_holdTime; ///< Hold time in milliseconds
+  uint8_t m_load; ///< Load of the sender
+};
+std::ostream & operator<< (std::ostream & os, IarpUpdateHeader const & h);
+
+/**
+ * \ingroup iarp
+ * \brief Neighbor set message of the link-state zone engine
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Origin Address                         |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Sequence Number                        |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |   Hops Left   |   Neighbors   |           Reserved            |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                      Neighbor Address 1                       |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                              ...                              |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * The origin floods its one-hop neighbors to ZoneRadius - 1 hops, so that
+ * every node learns the links of its zone.
+ */
+class NeighborSetHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param origin the node whose neighbors are listed
+   * \param seqNo the sequence number of the origin
+   * \param hopsLeft the number of times the message may still be relayed
+   */
+  NeighborSetHeader (Ipv4Address origin = Ipv4Address (), uint32_t seqNo = 0, uint8_t hopsLeft = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * Get the origin
+   * \returns the origin address
+   */
+  Ipv4Address
+  GetOrigin () const
+  {
+    return m_origin;
+  }
+  /**
+   * Get the sequence number
+   * \returns the sequence number of the origin
+   */
+  uint32_t
+  GetSeqNo () const
+  {
+    return m_seqNo;
+  }
+  /**
+   * Set the number of times the message may still be relayed
+   * \param hopsLeft the hops left
+   */
+  void
+  SetHopsLeft (uint8_t hopsLeft)
+  {
+    m_hopsLeft = hopsLeft;
+  }
+  /**
+   * Get the number of times the message may still be relayed
+   * \returns the hops left
+   */
+  uint8_t
+  GetHopsLeft () const
+  {
+    return m_hopsLeft;
+  }
+  /**
+   * Add a neighbor of the origin
+   * \param neighbor the neighbor address
+   * \returns false if the message is full
+   */
+  bool AddNeighbor (Ipv4Address neighbor);
+  /**
+   * Get the neighbors of the origin
+   * \returns the neighbor addresses
+   */
+  std::vector<Ipv4Address> const &
+  GetNeighbors () const
+  {
+    return m_neighbors;
+  }
+
+private:
+  Ipv4Address m_origin; ///< Node whose neighbors are listed
+  uint32_t m_seqNo; ///< Sequence number of the origin
+  uint8_t m_hopsLeft; ///< Number of times the message may still be relayed
+  std::vector<Ipv4Address> m_neighbors; ///< One-hop neighbors of the origin
+};
+std::ostream & operator<< (std::ostream & os, NeighborSetHeader const & h);
+
+/**
+ * \ingroup ierp
+ * \brief Gradient beacon of the collection tree
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                          Sink Address                         |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Sequence Number                        |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |   Hop Count   |                    Reserved                   |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * The sink floods a beacon with a new sequence number every interval, and
+ * every node forwards each sequence number once with its own hop count.
+ */
+class SinkBeaconHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param sink the sink of the collection tree
+   * \param seqNo the beacon sequence number
+   * \param hopCount the hops from the sink of the sender
+   */
+  SinkBeaconHeader (Ipv4Address sink = Ipv4Address (), uint32_t seqNo = 0, uint8_t hopCount = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * Get the sink
+   * \returns the sink address
+   */
+  Ipv4Address
+  GetSink () const
+  {
+    return m_sink;
+  }
+  /**
+   * Get the sequence number
+   * \returns the beacon sequence number
+   */
+  uint32_t
+  GetSeqNo () const
+  {
+    return m_seqNo;
+  }
+  /**
+   * Set the hop count
+   * \param hopCount the hops from the sink of the sender
+   */
+  void
+  SetHopCount (uint8_t hopCount)
+  {
+    m_hopCount = hopCount;
+  }
+  /**
+   * Get the hop count
+   * \returns the hops from the sink of the sender
+   */
+  uint8_t
+  GetHopCount () const
+  {
+    return m_hopCount;
+  }
+
+private:
+  Ipv4Address m_sink; ///< Sink of the collection tree
+  uint32_t m_seqNo; ///< Beacon sequence number
+  uint8_t m_hopCount; ///< Hops from the sink of the sender
+};
+std::ostream & operator<< (std::ostream & os, SinkBeaconHeader const & h);
+
 /**
 * 
 * \brief   Route Request (RREQ) Message Format
@@ -184,7 +483,7 @@ std::ostream & operator<< (std::ostream & os, const IarpHeader & packet);
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  |     Type      |J|R|G|D|U|   Reserved          |   Hop Count   |
+  |     Type      |J|R|G|D|U|B|M|S|      TTL      |   Hop Count   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                            RREQ ID                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -196,11 +495,38 @@ std::ostream & operator<< (std::ostream & os, const IarpHeader & packet);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                  Originator Sequence Number                   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |            Metric             |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                     First Hop IP Address                      |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+  With the S flag set, the destinations the RREQ also asks for follow:
+  \verbatim
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  | Destinations  |                   Reserved                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                   Destination IP Address 2                    |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                 Destination Sequence Number 2                 |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |D|U|                        Reserved                           |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |                              ...                              |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
 */
 class RreqHeader : public Header
 {
 public:
+  /// Destination a RREQ asks for besides the main one, with its own sequence number and flags
+  struct Destination
+  {
+    Ipv4Address m_dst;        ///< Destination IP Address
+    uint32_t m_dstSeqNo;      ///< Destination Sequence Number
+    bool m_destinationOnly;   ///< Destination only flag
+    bool m_unknownSeqNo;      ///< Unknown sequence number flag
+  };
+
   /**
    * constructor
    *
@@ -246,6 +572,24 @@ public:
   {
     return m_hopCount;
   }
+  /**
+   * \brief Set the TTL, the hops the RREQ may still be re-broadcast.
+   * Every relay sends its own copy, so the IP TTL can not carry the
+   * expanding ring search.
+   * \param ttl the TTL
+   */
+  void SetTtl (uint8_t ttl)
+  {
+    m_reserved = ttl;
+  }
+  /**
+   * \brief Get the TTL
+   * \return the TTL
+   */
+  uint8_t GetTtl () const
+  {
+    return m_reserved;
+  }
   /**
    * \brief Set the request ID
    * \param id the request ID
@@ -326,6 +670,38 @@ public:
   {
     return m_originSeqNo;
   }
+  /**
+   * \brief Set the path metric from the origin to the sender
+   * \param metric the path metric
+   */
+  void SetMetric (uint16_t metric)
+  {
+    m_metric = metric;
+  }
+  /**
+   * \brief Get the path metric from the origin to the sender
+   * \return the path metric
+   */
+  uint16_t GetMetric () const
+  {
+    return m_metric;
+  }
+  /**
+   * \brief Set the first node the RREQ reached from the origin
+   * \param a the first hop IP address
+   */
+  void SetFirstHop (Ipv4Address a)
+  {
+    m_firstHop = a;
+  }
+  /**
+   * \brief Get the first node the RREQ reached from the origin
+   * \return the first hop IP address
+   */
+  Ipv4Address GetFirstHop () const
+  {
+    return m_firstHop;
+  }
 /*
   void SetRad (Ipv4Address a)
   {
@@ -367,6 +743,52 @@ public:
    * \return the unknown sequence number flag
    */
   bool GetUnknownSeqno () const;
+  /**
+   * \brief Set the bordercast flag, telling that a BordercastHeader follows
+   * \param f the bordercast flag
+   */
+  void SetBordercast (bool f);
+  /**
+   * \brief Get the bordercast flag
+   * \return the bordercast flag
+   */
+  bool GetBordercast () const;
+  /**
+   * \brief Set the multipoint relay flag, telling that a MprSetHeader follows
+   * \param f the multipoint relay flag
+   */
+  void SetMprFlood (bool f);
+  /**
+   * \brief Get the multipoint relay flag
+   * \return the multipoint relay flag
+   */
+  bool GetMprFlood () const;
+  /**
+   * \brief Add a destination besides the main one
+   * \param dst the destination address
+   * \param dstSeqNo the destination sequence number
+   * \param destinationOnly the Destination only flag
+   * \param unknownSeqNo the unknown sequence number flag
+   * \returns false if the destination list is full
+   */
+  bool AddDestination (Ipv4Address dst, uint32_t dstSeqNo, bool destinationOnly, bool unknownSeqNo);
+  /**
+   * \brief Get the destinations besides the main one; the S flag is set when there are any
+   * \return the destinations
+   */
+  std::vector<Destination> const &
+  GetDestinations () const
+  {
+    return m_destinations;
+  }
+  /**
+   * \brief Set the destinations besides the main one
+   * \param destinations the destinations
+   */
+  void SetDestinations (std::vector<Destination> const & destinations)
+  {
+    m_destinations = destinations;
+  }
 
   /**
    * \brief Comparison operator
@@ -375,14 +797,17 @@ public:
    */
   bool operator== (RreqHeader const & o) const;
 private:
-  uint8_t        m_flags;          ///< |J|R|G|D|U| bit flags, see RFC
-  uint8_t        m_reserved;       ///< Not used (must be 0)
+  uint8_t        m_flags;          ///< |J|R|G|D|U|B|M| bit flags, see RFC; S follows m_destinations
+  uint8_t        m_reserved;       ///< TTL of the expanding ring search
   uint8_t        m_hopCount;       ///< Hop Count
   uint32_t       m_requestID;      ///< RREQ ID
   Ipv4Address    m_dst;            ///< Destination IP Address
   uint32_t       m_dstSeqNo;       ///< Destination Sequence Number
   Ipv4Address    m_origin;         ///< Originator IP Address
   uint32_t       m_originSeqNo;    ///< Source Sequence Number
+  uint16_t       m_metric;         ///< Path metric from the origin
+  Ipv4Address    m_firstHop;       ///< First node the RREQ reached from the origin
+  std::vector<Destination> m_destinations; ///< Destinations besides the main one
   //Ipv4Address    m_rad;
 };
 
@@ -394,6 +819,171 @@ private:
 std::ostream & operator<< (std::ostream & os, RreqHeader const &);
 
 
+/**
+ * \ingroup ierp
+ * \brief Bordercast tree, appended to a RREQ with the bordercast flag set
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                     Bordercaster Address                      |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |   Hops Left   |    Targets    |    Relays     |   Reserved    |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                       Target Address 1                        |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                              ...                              |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Relay Address 1                        |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                              ...                              |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * The targets are the peripheral nodes of the bordercaster the RREQ is sent
+ * to, the relays the neighbors that forward it one hop further along the
+ * zone routes.  A relay forwards to the targets it reaches in exactly Hops
+ * Left hops.
+ */
+class BordercastHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param bordercaster the node whose zone border the targets are
+   * \param hopsLeft the hops from the relays to the targets
+   */
+  BordercastHeader (Ipv4Address bordercaster = Ipv4Address (), uint8_t hopsLeft = 0);
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * Get the bordercaster
+   * \returns the node whose zone border the targets are
+   */
+  Ipv4Address
+  GetBordercaster () const
+  {
+    return m_bordercaster;
+  }
+  /**
+   * Get the hops from the relays to the targets
+   * \returns the hops left
+   */
+  uint8_t
+  GetHopsLeft () const
+  {
+    return m_hopsLeft;
+  }
+  /**
+   * Add a peripheral node the RREQ is bordercast to
+   * \param target the target address
+   * \returns false if the target list is full
+   */
+  bool AddTarget (Ipv4Address target);
+  /**
+   * Add a neighbor that forwards the RREQ, once
+   * \param relay the relay address
+   * \returns false if the relay list is full
+   */
+  bool AddRelay (Ipv4Address relay);
+  /**
+   * Get the targets
+   * \returns the target addresses
+   */
+  std::vector<Ipv4Address> const &
+  GetTargets () const
+  {
+    return m_targets;
+  }
+  /**
+   * \param address the address
+   * \returns true if address is a target
+   */
+  bool IsTarget (Ipv4Address address) const;
+  /**
+   * \param address the address
+   * \returns true if address is a relay
+   */
+  bool IsRelay (Ipv4Address address) const;
+
+private:
+  Ipv4Address m_bordercaster; ///< Node whose zone border the targets are
+  uint8_t m_hopsLeft; ///< Hops from the relays to the targets
+  std::vector<Ipv4Address> m_targets; ///< Peripheral nodes the RREQ is bordercast to
+  std::vector<Ipv4Address> m_relays; ///< Neighbors that forward the RREQ
+};
+std::ostream & operator<< (std::ostream & os, BordercastHeader const & h);
+
+/**
+ * \ingroup ierp
+ * \brief Multipoint relays of the sender, appended to a RREQ with the multipoint relay flag set
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |     Relays    |                   Reserved                    |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                        Relay Address 1                        |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                              ...                              |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * Only the listed neighbors re-broadcast the RREQ.
+ */
+class MprSetHeader : public Header
+{
+public:
+  MprSetHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * Add a multipoint relay
+   * \param relay the relay address
+   * \returns false if the message is full
+   */
+  bool AddRelay (Ipv4Address relay);
+  /**
+   * \param address the address
+   * \returns true if address is a multipoint relay of the sender
+   */
+  bool IsRelay (Ipv4Address address) const;
+  /**
+   * Get the multipoint relays
+   * \returns the relay addresses
+   */
+  std::vector<Ipv4Address> const &
+  GetRelays () const
+  {
+    return m_relays;
+  }
+
+private:
+  std::vector<Ipv4Address> m_relays; ///< Multipoint relays of the sender
+};
+std::ostream & operator<< (std::ostream & os, MprSetHeader const & h);
+
 /**
 * \ingroup aodv
 * \brief Route Reply (RREP) Message Format
@@ -401,7 +991,7 @@ std::ostream & operator<< (std::ostream & os, RreqHeader const &);
   0                   1                   2                   3
   0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-  |     Type      |R|A|    Reserved     |Prefix Sz|   Hop Count   |
+  |     Type      |R|A|M|  Reserved   |Prefix Sz|   Hop Count   |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                     Destination IP address                    |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
@@ -411,7 +1001,12 @@ std::ostream & operator<< (std::ostream & os, RreqHeader const &);
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   |                           Lifetime                            |
   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |            Metric             |        Expiration (ms)        |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+  The expiration is the time left until the first link of the path to
+  the destination is predicted to break, 0xffff if no break is predicted.
+  With the M flag set, a hello is followed by a PositionHeader.
 */
 class RrepHeader : public Header
 {
@@ -515,6 +1110,32 @@ public:
    * \return the lifetime
    */
   Time GetLifeTime () const;
+  /**
+   * \brief Set the path metric from the sender to the destination
+   * \param metric the path metric
+   */
+  void SetMetric (uint16_t metric)
+  {
+    m_metric = metric;
+  }
+  /**
+   * \brief Get the path metric from the sender to the destination
+   * \return the path metric
+   */
+  uint16_t GetMetric () const
+  {
+    return m_metric;
+  }
+  /**
+   * \brief Set the time left until a link of the path is predicted to break
+   * \param expiration the time left, Time::Max () if no break is predicted
+   */
+  void SetExpiration (Time expiration);
+  /**
+   * \brief Get the time left until a link of the path is predicted to break
+   * \return the time left, Time::Max () if no break is predicted
+   */
+  Time GetExpiration () const;
 
   // Flags
   /**
@@ -537,6 +1158,16 @@ public:
    * \return the prefix size
    */
   uint8_t GetPrefixSize () const;
+  /**
+   * \brief Set the mobility flag
+   * \param f true if a PositionHeader follows
+   */
+  void SetMobility (bool f);
+  /**
+   * \brief Get the mobility flag
+   * \return true if a PositionHeader follows
+   */
+  bool GetMobility () const;
 
   /**
    * Configure RREP to be a Hello message
@@ -561,6 +1192,8 @@ private:
   uint32_t      m_dstSeqNo;         ///< Destination Sequence Number
   Ipv4Address     m_origin;           ///< Source IP Address
   uint32_t      m_lifeTime;         ///< Lifetime (in milliseconds)
+  uint16_t      m_metric;           ///< Path metric to the destination
+  uint16_t      m_expiration;       ///< Time left until a link of the path breaks (in milliseconds)
 };
 
 /**
@@ -570,6 +1203,63 @@ private:
   */
 std::ostream & operator<< (std::ostream & os, RrepHeader const &);
 
+/**
+ * \ingroup iarp
+ * \brief Position and velocity of the sender, appended to a hello with the mobility flag set
+ * \verbatim
+ |      0        |      1        |      2        |       3       |
+  0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7 0 1 2 3 4 5 6 7
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                            X (cm)                             |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |                            Y (cm)                             |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ |       X Velocity (cm/s)       |       Y Velocity (cm/s)       |
+ +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * \endverbatim
+ *
+ * The receivers extrapolate the position from the velocity until the next
+ * hello, which the sender does not skip once its velocity changed.
+ */
+class PositionHeader : public Header
+{
+public:
+  /**
+   * Constructor
+   *
+   * \param position the position of the sender
+   * \param velocity the velocity of the sender
+   */
+  PositionHeader (Vector position = Vector (), Vector velocity = Vector ());
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator start) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  /**
+   * \returns the position of the sender, z left out
+   */
+  Vector GetPosition () const;
+  /**
+   * \returns the velocity of the sender, z left out
+   */
+  Vector GetVelocity () const;
+
+private:
+  int32_t m_x;  ///< X coordinate in centimeters
+  int32_t m_y;  ///< Y coordinate in centimeters
+  int16_t m_vx; ///< X velocity in centimeters per second
+  int16_t m_vy; ///< Y velocity in centimeters per second
+};
+std::ostream & operator<< (std::ostream & os, PositionHeader const & h);
+
 /**
 * \ingroup aodv
 * \brief Route Reply Acknowledgment (RREP-ACK) Message Format
@@ -615,6 +1305,98 @@ private:
   */
 std::ostream & operator<< (std::ostream & os, RrepAckHeader const &);
 
+/**
+* \ingroup ierp
+* \brief Route Error (RERR) Message Format
+  \verbatim
+  0                   1                   2                   3
+  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |     Type      |N|          Reserved           |   DestCount   |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |            Unreachable Destination IP Address (1)             |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |         Unreachable Destination Sequence Number (1)           |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |  Additional Unreachable Destination IP Addresses (if needed)  |
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  |Additional Unreachable Destination Sequence Numbers (if needed)|
+  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+*/
+class RerrHeader : public Header
+{
+public:
+  /// constructor
+  RerrHeader ();
+
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId ();
+  TypeId GetInstanceTypeId () const;
+  uint32_t GetSerializedSize () const;
+  void Serialize (Buffer::Iterator i) const;
+  uint32_t Deserialize (Buffer::Iterator start);
+  void Print (std::ostream &os) const;
+
+  // No delete flag
+  /**
+   * \brief Set the no delete flag
+   * \param f the no delete flag
+   */
+  void SetNoDelete (bool f);
+  /**
+   * \brief Get the no delete flag
+   * \return the no delete flag
+   */
+  bool GetNoDelete () const;
+
+  /**
+   * \brief Add unreachable node address and its sequence number in RERR header
+   * \param dst unreachable IPv4 address
+   * \param seqNo unreachable sequence number
+   * \return false if we already added maximum possible number of unreachable destinations
+   */
+  bool AddUnDestination (Ipv4Address dst, uint32_t seqNo);
+  /**
+   * \brief Delete pair (address + sequence number) from REER header, if the number of unreachable destinations > 0
+   * \param un unreachable pair (address + sequence number)
+   * \return true on success
+   */
+  bool RemoveUnDestination (std::pair<Ipv4Address, uint32_t> & un);
+  /// Clear header
+  void Clear ();
+  /**
+   * \returns number of unreachable destinations in RERR message
+   */
+  uint8_t GetDestCount () const
+  {
+    return (uint8_t)m_unreachableDstSeqNo.size ();
+  }
+
+  /**
+   * \brief Comparison operator
+   * \param o RERR header to compare
+   * \return true if the RERR headers are equal
+   */
+  bool operator== (RerrHeader const & o) const;
+private:
+  uint8_t m_flag;            ///< No delete flag
+  uint8_t m_reserved;        ///< Not used (must be 0)
+
+  /// List of Unreachable destination: IP addresses and sequence numbers
+  std::map<Ipv4Address, uint32_t> m_unreachableDstSeqNo;
+};
+
+/**
+  * \brief Stream output operator
+  * \param os output stream
+  * \return updated stream
+  */
+std::ostream & operator<< (std::ostream & os, RerrHeader const &);
+
 
 
 
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-popularity.h"
+#include "ns3/simulator.h"
+#include <cmath>
+
+namespace ns3 {
+namespace shingo {
+
+DestinationPopularity::DestinationPopularity (Time halfLife, uint32_t cacheSize, double hotThreshold)
+  : m_halfLife (halfLife),
+    m_cacheSize (cacheSize),
+    m_hotThreshold (hotThreshold)
+{
+}
+
+void
+DestinationPopularity::Decay (Score & s) const
+{
+  Time elapsed = Simulator::Now () - s.m_updated;
+  if (elapsed.IsStrictlyPositive () && m_halfLife.IsStrictlyPositive ())
+    {
+      s.m_score *= std::pow (0.5, elapsed.GetSeconds () / m_halfLife.GetSeconds ());
+    }
+  s.m_updated = Simulator::Now ();
+}
+
+void
+DestinationPopularity::Record (Ipv4Address dst)
+{
+  Purge ();
+  std::map<Ipv4Address, Score>::iterator i = m_scores.find (dst);
+  if (i == m_scores.end ())
+    {
+      Score s = { 0, Simulator::Now () };
+      i = m_scores.insert (std::make_pair (dst, s)).first;
+    }
+  Decay (i->second);
+  i->second.m_score += 1;
+}
+
+double
+DestinationPopularity::GetScore (Ipv4Address dst)
+{
+  std::map<Ipv4Address, Score>::iterator i = m_scores.find (dst);
+  if (i == m_scores.end ())
+    {
+      return 0;
+    }
+  Decay (i->second);
+  return i->second.m_score;
+}
+
+uint32_t
+DestinationPopularity::GetRank (Ipv4Address dst)
+{
+  double score = GetScore (dst);
+  uint32_t rank = 0;
+  for (std::map<Ipv4Address, Score>::iterator i = m_scores.begin (); i != m_scores.end (); ++i)
+    {
+      Decay (i->second);
+      if (i->second.m_score > score)
+        {
+          rank++;
+        }
+    }
+  return rank;
+}
+
+bool
+DestinationPopularity::IsHot (Ipv4Address dst)
+{
+  return GetScore (dst) >= m_hotThreshold && GetRank (dst) < m_cacheSize;
+}
+
+void
+DestinationPopularity::Purge ()
+{
+  for (std::map<Ipv4Address, Score>::iterator i = m_scores.begin (); i != m_scores.end (); )
+    {
+      Decay (i->second);
+      if (i->second.m_score < 0.01)
+        {
+          m_scores.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+uint32_t
+DestinationPopularity::GetSize ()
+{
+  Purge ();
+  return m_scores.size ();
+}
+
+}
+}
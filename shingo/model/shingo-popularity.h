@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_POPULARITY_H
+#define SHINGO_POPULARITY_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Popularity of the IERP destinations.
+ *
+ * Every RREQ, RREP or data packet seen for a destination adds one to its
+ * score, and the score decays exponentially with the configured half-life.
+ * The destinations ranked within the cache size, with a score of at least
+ * the hot threshold, are hot: their routes are kept longer to answer the
+ * RREQs of the next sources.
+ */
+class DestinationPopularity
+{
+public:
+  /**
+   * constructor
+   * \param halfLife time for the score to decay to half its value
+   * \param cacheSize number of destinations that can be hot at once
+   * \param hotThreshold score from which a destination can be hot
+   */
+  DestinationPopularity (Time halfLife = Seconds (30), uint32_t cacheSize = 4, double hotThreshold = 3);
+  /**
+   * Count a packet seen for dst
+   * \param dst the destination
+   */
+  void Record (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns the score of dst decayed to now
+   */
+  double GetScore (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns the number of destinations with a higher score
+   */
+  uint32_t GetRank (Ipv4Address dst);
+  /**
+   * \param dst the destination
+   * \returns true if dst is ranked within the cache size with a score of at least the hot threshold
+   */
+  bool IsHot (Ipv4Address dst);
+  /// Forget the destinations whose score has decayed away
+  void Purge ();
+  /**
+   * \returns number of destinations with a score
+   */
+  uint32_t GetSize ();
+
+  /**
+   * Set the half-life of the score
+   * \param halfLife the half-life
+   */
+  void SetHalfLife (Time halfLife)
+  {
+    m_halfLife = halfLife;
+  }
+  /**
+   * Set the cache size
+   * \param cacheSize the number of destinations that can be hot at once
+   */
+  void SetCacheSize (uint32_t cacheSize)
+  {
+    m_cacheSize = cacheSize;
+  }
+  /**
+   * Set the hot threshold
+   * \param threshold the score from which a destination can be hot
+   */
+  void SetHotThreshold (double threshold)
+  {
+    m_hotThreshold = threshold;
+  }
+
+private:
+  /// Popularity of one destination
+  struct Score
+  {
+    /// Score at m_updated
+    double m_score;
+    /// Time the score was last decayed
+    Time m_updated;
+  };
+  /**
+   * Decay a score to now
+   * \param s the score
+   */
+  void Decay (Score & s) const;
+  /// Score per destination
+  std::map<Ipv4Address, Score> m_scores;
+  /// Half-life of the score
+  Time m_halfLife;
+  /// Number of destinations that can be hot at once
+  uint32_t m_cacheSize;
+  /// Score from which a destination can be hot
+  double m_hotThreshold;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_POPULARITY_H */
@@ -0,0 +1,59 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-query-detection.h"
+#include "ns3/simulator.h"
+
+namespace ns3 {
+namespace shingo {
+
+void
+QueryDetectionCache::Record (Ipv4Address origin, uint32_t id, Ipv4Address relayer)
+{
+  Purge ();
+  Query & query = m_queries[std::make_pair (origin, id)];
+  if (query.m_relayers.empty ())
+    {
+      query.m_expire = Simulator::Now () + m_lifetime;
+    }
+  query.m_relayers.insert (relayer);
+}
+
+bool
+QueryDetectionCache::HasRelayed (Ipv4Address origin, uint32_t id, Ipv4Address node)
+{
+  std::map<QueryId, Query>::const_iterator i = m_queries.find (std::make_pair (origin, id));
+  return i != m_queries.end () && i->second.m_relayers.count (node) > 0;
+}
+
+uint32_t
+QueryDetectionCache::GetRelayerCount (Ipv4Address origin, uint32_t id)
+{
+  std::map<QueryId, Query>::const_iterator i = m_queries.find (std::make_pair (origin, id));
+  return i == m_queries.end () ? 0 : i->second.m_relayers.size ();
+}
+
+void
+QueryDetectionCache::Purge ()
+{
+  for (std::map<QueryId, Query>::iterator i = m_queries.begin (); i != m_queries.end (); )
+    {
+      if (i->second.m_expire < Simulator::Now ())
+        {
+          m_queries.erase (i++);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
+uint32_t
+QueryDetectionCache::GetSize ()
+{
+  Purge ();
+  return m_queries.size ();
+}
+
+}
+}
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_QUERY_DETECTION_H
+#define SHINGO_QUERY_DETECTION_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <set>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup ierp
+ *
+ * \brief Query detection cache.
+ *
+ * Records, per RREQ origin and ID, every neighbor heard relaying the
+ * query, including the copies the duplicate check drops.  A relayer
+ * covers its own zone, so a node can tell which parts of its zone the
+ * query has already reached.
+ */
+class QueryDetectionCache
+{
+public:
+  /**
+   * constructor
+   * \param lifetime the lifetime of the records
+   */
+  QueryDetectionCache (Time lifetime = Seconds (3)) : m_lifetime (lifetime)
+  {
+  }
+  /**
+   * Record that a query was heard from a relayer
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   * \param relayer the neighbor that sent the copy
+   */
+  void Record (Ipv4Address origin, uint32_t id, Ipv4Address relayer);
+  /**
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   * \param node the node
+   * \returns true if node was heard relaying the query
+   */
+  bool HasRelayed (Ipv4Address origin, uint32_t id, Ipv4Address node);
+  /**
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   * \returns the number of relayers heard
+   */
+  uint32_t GetRelayerCount (Ipv4Address origin, uint32_t id);
+  /// Remove all expired records
+  void Purge ();
+  /**
+   * \returns number of queries recorded
+   */
+  uint32_t GetSize ();
+  /**
+   * Set lifetime for future records
+   * \param lifetime the lifetime
+   */
+  void SetLifetime (Time lifetime)
+  {
+    m_lifetime = lifetime;
+  }
+
+private:
+  /// Query key: origin and RREQ ID
+  typedef std::pair<Ipv4Address, uint32_t> QueryId;
+  /// Record of one query
+  struct Query
+  {
+    /// Neighbors heard relaying the query
+    std::set<Ipv4Address> m_relayers;
+    /// When the record will expire
+    Time m_expire;
+  };
+  /// Recorded queries
+  std::map<QueryId, Query> m_queries;
+  /// Lifetime of the records
+  Time m_lifetime;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_QUERY_DETECTION_H */
@@ -1,4 +1,5 @@
 #include "shingo-table.h"
+#include "shingo-link-quality.h"
 #include <algorithm>
 #include <iomanip>
 #include "ns3/simulator.h"
@@ -24,7 +25,9 @@ RoutingTableEntry::RoutingTableEntry (Ptr<NetDevice> dev,
                                       bool areChanged)
   : m_seqNo (seqNo),
     m_hops (hops),
+    m_metric (hops * LinkQuality::PERFECT_LINK),
     m_lifeTime (lifetime),
+    m_holdTime (Seconds (0)),
     m_iface (iface),
     m_flag (VALID),
     m_settlingTime (SettlingTime),
@@ -150,6 +153,25 @@ RoutingTable::DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface)
     }
 }
 
+void
+RoutingTable::DeleteRoutesBeyond (uint32_t hops)
+{
+  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
+    {
+      if (i->second.GetHop () > hops)
+        {
+          std::map<Ipv4Address, RoutingTableEntry>::iterator tmp = i;
+          ++i;
+          ForceDeleteIpv4Event (tmp->first);
+          m_ipv4AddressEntry.erase (tmp);
+        }
+      else
+        {
+          ++i;
+        }
+    }
+}
+
 
 void
 RoutingTable::GetListOfAllRoutes (std::map<Ipv4Address, RoutingTableEntry> & allRoutes)
@@ -199,7 +221,8 @@ RoutingTable::Purge (std::map<Ipv4Address, RoutingTableEntry> & removedAddresses
   for (std::map<Ipv4Address, RoutingTableEntry>::iterator i = m_ipv4AddressEntry.begin (); i != m_ipv4AddressEntry.end (); )
     {
       std::map<Ipv4Address, RoutingTableEntry>::iterator itmp = i;
-      if (i->second.GetLifeTime () > m_holddownTime && (i->second.GetHop () > 0))
+      Time holddown = i->second.GetHoldTime ().IsZero () ? m_holddownTime : i->second.GetHoldTime ();
+      if (i->second.GetLifeTime () > holddown && (i->second.GetHop () > 0))
         {
           for (std::map<Ipv4Address, RoutingTableEntry>::iterator j = m_ipv4AddressEntry.begin (); j != m_ipv4AddressEntry.end (); )
             {
@@ -344,6 +367,7 @@ RoutingTableEntry2::RoutingTableEntry2 (Ptr<NetDevice> dev, Ipv4Address dst, boo
     m_validSeqNo (vSeqNo),
     m_seqNo (seqNo),
     m_hops (hops),
+    m_metric (hops * LinkQuality::PERFECT_LINK),
     m_lifeTime (lifetime + Simulator::Now ()),
     m_iface (iface),
     m_flag (VALID),
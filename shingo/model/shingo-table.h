@@ -93,11 +93,49 @@ class RoutingTableEntry
   {
     return m_hops;
   }
+  /**
+   * Set the path metric
+   * \param metric the sum of the link costs to the destination
+   */
+  void
+  SetMetric (uint16_t metric)
+  {
+    m_metric = metric;
+  }
+  /**
+   * Get the path metric
+   * \returns the sum of the link costs to the destination
+   */
+  uint16_t
+  GetMetric () const
+  {
+    return m_metric;
+  }
 
-   //経路エントリの維持時間を設定する
- void SetLifeTime (Time lifeTime) { m_lifeTime = lifeTime + Simulator::Now (); }
-   //経路エントリの維持時間を取得する 
- Time GetLifeTime () const { return m_lifeTime - Simulator::Now (); }
+   //経路エントリの最終更新時刻を設定する
+ void SetLifeTime (Time lifeTime) { m_lifeTime = lifeTime; }
+   //最終更新からの経過時間を取得する
+ Time GetLifeTime () const { return Simulator::Now () - m_lifeTime; }
+
+  /**
+   * Set the hold time advertised by the next hop, zero to use the hold
+   * down time of the table
+   * \param holdTime the hold time
+   */
+  void
+  SetHoldTime (Time holdTime)
+  {
+    m_holdTime = holdTime;
+  }
+  /**
+   * Get the hold time advertised by the next hop
+   * \returns the hold time
+   */
+  Time
+  GetHoldTime () const
+  {
+    return m_holdTime;
+  }
 
   /**
    * Set settling time
@@ -166,8 +204,12 @@ class RoutingTableEntry
   uint32_t m_seqNo;
 
   uint16_t m_hops;
+  /// Sum of the link costs to the destination
+  uint16_t m_metric;
    //経路エントリーの維持時間
  Time m_lifeTime;
+  /// Hold time advertised by the next hop, zero if none
+  Time m_holdTime;
    //経路情報
  Ptr<Ipv4Route> m_ipv4Route;
 
@@ -224,6 +266,12 @@ class RoutingTable
    */
   void
   DeleteAllRoutesFromInterface (Ipv4InterfaceAddress iface);
+  /**
+   * Delete the routes more than the given number of hops away, and the updates waiting for them
+   * \param hops the largest hop count kept
+   */
+  void
+  DeleteRoutesBeyond (uint32_t hops);
 
    //ルーティングテーブルのすべてのエントリーを削除する
  void Clear () { m_ipv4AddressEntry.clear (); }
@@ -497,6 +545,22 @@ public:
   {
     return m_hops;
   }
+  /**
+   * Set the path metric
+   * \param metric the sum of the link costs to the destination
+   */
+  void SetMetric (uint16_t metric)
+  {
+    m_metric = metric;
+  }
+  /**
+   * Get the path metric
+   * \returns the sum of the link costs to the destination
+   */
+  uint16_t GetMetric () const
+  {
+    return m_metric;
+  }
   /**
    * Set the lifetime
    * \param lt The lifetime
@@ -609,6 +673,8 @@ private:
   uint32_t m_seqNo;
   /// Hop Count (number of hops needed to reach destination)
   uint16_t m_hops;
+  /// Sum of the link costs to the destination
+  uint16_t m_metric;
   /**
   * \brief Expiration or deletion time of the route
   *	Lifetime field in the routing table plays dual role:
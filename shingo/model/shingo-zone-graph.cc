@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-zone-graph.h"
+#include "ns3/simulator.h"
+#include <queue>
+
+namespace ns3 {
+namespace shingo {
+
+ZoneGraph::ZoneGraph ()
+{
+}
+
+bool
+ZoneGraph::IsNewer (Ipv4Address node, uint32_t seqNo) const
+{
+  std::map<Ipv4Address, Node>::const_iterator i = m_nodes.find (node);
+  return i == m_nodes.end () || seqNo > i->second.m_seqNo;
+}
+
+uint32_t
+ZoneGraph::GetSeqNo (Ipv4Address node) const
+{
+  std::map<Ipv4Address, Node>::const_iterator i = m_nodes.find (node);
+  return i == m_nodes.end () ? 0 : i->second.m_seqNo;
+}
+
+bool
+ZoneGraph::Update (Ipv4Address node, uint32_t seqNo, std::set<Ipv4Address> const & neighbors, Time expire)
+{
+  std::map<Ipv4Address, Node>::iterator i = m_nodes.find (node);
+  if (i == m_nodes.end ())
+    {
+      Node n = { seqNo, neighbors, expire };
+      m_nodes.insert (std::make_pair (node, n));
+      return true;
+    }
+  i->second.m_seqNo = seqNo;
+  i->second.m_expire = expire;
+  if (i->second.m_neighbors == neighbors)
+    {
+      return false;
+    }
+  i->second.m_neighbors = neighbors;
+  return true;
+}
+
+bool
+ZoneGraph::Remove (Ipv4Address node)
+{
+  return m_nodes.erase (node) > 0;
+}
+
+bool
+ZoneGraph::Purge ()
+{
+  bool changed = false;
+  for (std::map<Ipv4Address, Node>::iterator i = m_nodes.begin (); i != m_nodes.end (); )
+    {
+      if (i->second.m_expire < Simulator::Now ())
+        {
+          m_nodes.erase (i++);
+          changed = true;
+        }
+      else
+        {
+          ++i;
+        }
+    }
+  return changed;
+}
+
+bool
+ZoneGraph::IsLink (Ipv4Address from, Ipv4Address to) const
+{
+  std::map<Ipv4Address, Node>::const_iterator i = m_nodes.find (to);
+  return i == m_nodes.end () || i->second.m_neighbors.count (from) > 0;
+}
+
+void
+ZoneGraph::ComputeRoutes (Ipv4Address self, uint32_t radius, std::map<Ipv4Address, ZoneRoute> & routes) const
+{
+  routes.clear ();
+  std::queue<Ipv4Address> frontier;
+  frontier.push (self);
+  while (!frontier.empty ())
+    {
+      Ipv4Address u = frontier.front ();
+      frontier.pop ();
+      uint32_t hops = 0;
+      Ipv4Address nextHop;
+      if (u != self)
+        {
+          hops = routes[u].m_hops;
+          nextHop = routes[u].m_nextHop;
+        }
+      std::map<Ipv4Address, Node>::const_iterator n = m_nodes.find (u);
+      if (hops >= radius || n == m_nodes.end ())
+        {
+          continue;
+        }
+      for (std::set<Ipv4Address>::const_iterator v = n->second.m_neighbors.begin (); v != n->second.m_neighbors.end (); ++v)
+        {
+          if (*v == self || routes.find (*v) != routes.end () || !IsLink (u, *v))
+            {
+              continue;
+            }
+          ZoneRoute route = { u == self ? *v : nextHop, hops + 1 };
+          routes.insert (std::make_pair (*v, route));
+          frontier.push (*v);
+        }
+    }
+}
+
+}
+}
@@ -0,0 +1,111 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_ZONE_GRAPH_H
+#define SHINGO_ZONE_GRAPH_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
+#include <map>
+#include <set>
+
+namespace ns3 {
+namespace shingo {
+
+/// Zone route computed from the zone graph
+struct ZoneRoute
+{
+  /// First hop toward the destination
+  Ipv4Address m_nextHop;
+  /// Number of hops to the destination
+  uint32_t m_hops;
+};
+
+/**
+ * \ingroup iarp
+ *
+ * \brief Zone topology of the link-state zone engine.
+ *
+ * Holds the last neighbor set advertised by every node of the zone.  A link
+ * is used only if both ends list each other, or if the far end has not
+ * advertised its neighbors, as is the case for the nodes on the zone border.
+ */
+class ZoneGraph
+{
+public:
+  ZoneGraph ();
+  /**
+   * \param node the origin of a neighbor set
+   * \param seqNo the sequence number of the neighbor set
+   * \returns true if no neighbor set of node with this or a later sequence number is known
+   */
+  bool IsNewer (Ipv4Address node, uint32_t seqNo) const;
+  /**
+   * \param node the origin of a neighbor set
+   * \returns the sequence number of the last neighbor set of node, 0 if unknown
+   */
+  uint32_t GetSeqNo (Ipv4Address node) const;
+  /**
+   * Store the neighbor set advertised by a node
+   * \param node the origin of the neighbor set
+   * \param seqNo the sequence number of the neighbor set
+   * \param neighbors the one-hop neighbors of node
+   * \param expire the time the neighbor set is forgotten
+   * \returns true if the links of node changed
+   */
+  bool Update (Ipv4Address node, uint32_t seqNo, std::set<Ipv4Address> const & neighbors, Time expire);
+  /**
+   * Forget the neighbor set of a node
+   * \param node the node
+   * \returns true if a neighbor set was known
+   */
+  bool Remove (Ipv4Address node);
+  /**
+   * Forget the expired neighbor sets
+   * \returns true if any was forgotten
+   */
+  bool Purge ();
+  /**
+   * Breadth first search of the zone
+   * \param self the root of the search
+   * \param radius the zone radius in hops
+   * \param routes filled with the route to every node within radius hops of self
+   */
+  void ComputeRoutes (Ipv4Address self, uint32_t radius, std::map<Ipv4Address, ZoneRoute> & routes) const;
+  /**
+   * \returns number of known neighbor sets
+   */
+  uint32_t GetSize () const
+  {
+    return m_nodes.size ();
+  }
+  /// Forget all neighbor sets
+  void Clear ()
+  {
+    m_nodes.clear ();
+  }
+
+private:
+  /// Neighbor set advertised by one node
+  struct Node
+  {
+    /// Sequence number of the neighbor set
+    uint32_t m_seqNo;
+    /// One-hop neighbors
+    std::set<Ipv4Address> m_neighbors;
+    /// Time the neighbor set is forgotten
+    Time m_expire;
+  };
+  /**
+   * \param from one end of the link
+   * \param to the other end of the link
+   * \returns true if the link is usable from from to to
+   */
+  bool IsLink (Ipv4Address from, Ipv4Address to) const;
+  /// Neighbor sets per origin
+  std::map<Ipv4Address, Node> m_nodes;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_ZONE_GRAPH_H */
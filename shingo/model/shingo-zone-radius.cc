@@ -0,0 +1,35 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "shingo-zone-radius.h"
+
+namespace ns3 {
+namespace shingo {
+
+ZoneRadiusAdaptation::ZoneRadiusAdaptation (uint32_t minRadius, uint32_t maxRadius, double ratio)
+  : m_minRadius (minRadius),
+    m_maxRadius (maxRadius),
+    m_ratio (ratio),
+    m_iarpBytes (0),
+    m_rreqBytes (0)
+{
+}
+
+uint32_t
+ZoneRadiusAdaptation::Adapt (uint32_t radius)
+{
+  // Proactive overhead dominates in dense zones, RREQ floods dominate in sparse ones
+  if (m_iarpBytes > m_ratio * m_rreqBytes && radius > m_minRadius)
+    {
+      radius--;
+    }
+  else if (m_rreqBytes > m_ratio * m_iarpBytes && radius < m_maxRadius)
+    {
+      radius++;
+    }
+  m_iarpBytes = 0;
+  m_rreqBytes = 0;
+  return radius;
+}
+
+}  // namespace shingo
+}  // namespace ns3
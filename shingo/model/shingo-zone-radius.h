@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef SHINGO_ZONE_RADIUS_H
+#define SHINGO_ZONE_RADIUS_H
+
+#include <stdint.h>
+
+namespace ns3 {
+namespace shingo {
+/**
+ * \ingroup iarp
+ *
+ * \brief Zone radius adapted to the measured control load.
+ *
+ * Counts the proactive (IARP) and the reactive (RREQ) control bytes the
+ * node sent and received since the last adaptation.  The radius shrinks by
+ * one hop when the IARP bytes exceed the ratio times the RREQ bytes, as in
+ * dense zones, and grows by one hop in the opposite case, as in sparse
+ * ones, always within the minimum and maximum radius.  A radius of 0, pure
+ * reactive routing, is reached only when the minimum radius is 0.
+ */
+class ZoneRadiusAdaptation
+{
+public:
+  /**
+   * constructor
+   * \param minRadius the smallest radius the adaptation may choose
+   * \param maxRadius the largest radius the adaptation may choose
+   * \param ratio the ratio between the IARP and RREQ bytes beyond which the radius changes
+   */
+  ZoneRadiusAdaptation (uint32_t minRadius = 1, uint32_t maxRadius = 4, double ratio = 2.0);
+  /**
+   * Count IARP bytes sent or received
+   * \param bytes the size of the message
+   */
+  void RecordIarp (uint32_t bytes)
+  {
+    m_iarpBytes += bytes;
+  }
+  /**
+   * Count RREQ bytes sent or received
+   * \param bytes the size of the message
+   */
+  void RecordRreq (uint32_t bytes)
+  {
+    m_rreqBytes += bytes;
+  }
+  /**
+   * Choose the radius for the load counted since the last adaptation, and restart the count
+   * \param radius the radius currently in use
+   * \returns the radius to use
+   */
+  uint32_t Adapt (uint32_t radius);
+  /**
+   * \returns the IARP bytes since the last adaptation
+   */
+  uint64_t GetIarpBytes () const
+  {
+    return m_iarpBytes;
+  }
+  /**
+   * \returns the RREQ bytes since the last adaptation
+   */
+  uint64_t GetRreqBytes () const
+  {
+    return m_rreqBytes;
+  }
+
+  /**
+   * Set the smallest radius
+   * \param radius the smallest radius the adaptation may choose
+   */
+  void SetMinRadius (uint32_t radius)
+  {
+    m_minRadius = radius;
+  }
+  /**
+   * Set the largest radius
+   * \param radius the largest radius the adaptation may choose
+   */
+  void SetMaxRadius (uint32_t radius)
+  {
+    m_maxRadius = radius;
+  }
+  /**
+   * Set the ratio
+   * \param ratio the ratio between the IARP and RREQ bytes beyond which the radius changes
+   */
+  void SetRatio (double ratio)
+  {
+    m_ratio = ratio;
+  }
+
+private:
+  /// Smallest radius the adaptation may choose
+  uint32_t m_minRadius;
+  /// Largest radius the adaptation may choose
+  uint32_t m_maxRadius;
+  /// Ratio between the IARP and RREQ bytes beyond which the radius changes
+  double m_ratio;
+  /// IARP bytes sent and received since the last adaptation
+  uint64_t m_iarpBytes;
+  /// RREQ bytes sent and received since the last adaptation
+  uint64_t m_rreqBytes;
+};
+
+}  // namespace shingo
+}  // namespace ns3
+
+#endif /* SHINGO_ZONE_RADIUS_H */
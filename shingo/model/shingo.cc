@@ -6,6 +6,7 @@
 
 #include "ns3/log.h"
 #include "ns3/boolean.h"
+#include "ns3/enum.h"
 #include "ns3/double.h"
 #include "ns3/uinteger.h"
 #include "ns3/random-variable-stream.h"
@@ -14,13 +15,21 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/wifi-net-device.h"
 #include "ns3/adhoc-wifi-mac.h"
+#include "ns3/txop.h"
+#include "ns3/wifi-mac-queue.h"
 #include "ns3/string.h"
 #include "ns3/pointer.h"
+#include "ns3/mobility-model.h"
+#include "ns3/udp-header.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-l4-protocol.h"
 
 #include <algorithm>
 #include <limits>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
 
 NS_LOG_COMPONENT_DEFINE ("ShingoProtocol");
 
@@ -153,7 +162,344 @@ RoutingProtocol::GetTypeId (void)
     .AddAttribute ("RouteAggregationTime","Time to aggregate updates before sending them out (in seconds)",
                    TimeValue (Seconds (1)),
                    MakeTimeAccessor (&RoutingProtocol::m_routeAggregationTime),
-                   MakeTimeChecker ());
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableZoneSolicit","Solicits the zone tables of the neighbors on start-up and when an interface comes up",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableZoneSolicit),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ZoneSolicitJitter","Maximum random delay before a zone solicit, or the zone table answering it, is sent",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&RoutingProtocol::m_zoneSolicitJitter),
+                   MakeTimeChecker ())
+    .AddAttribute ("ZoneRadius","Zone radius in hops; 0 disables IARP and leaves every destination to IERP",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_zoneRadius),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("EnableAdaptiveZoneRadius","Adapts the zone radius to the measured IARP and RREQ load",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableAdaptiveZoneRadius),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MinZoneRadius","Smallest zone radius the adaptation may choose",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_minZoneRadius),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxZoneRadius","Largest zone radius the adaptation may choose",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxZoneRadius),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ZoneRadiusAdaptInterval","Time over which the control load is measured before the zone radius is adapted",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_zoneRadiusAdaptInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("ZoneRadiusAdaptRatio","The zone radius shrinks when IARP bytes exceed this many times the RREQ bytes, "
+                   "and grows in the opposite case",
+                   DoubleValue (2.0),
+                   MakeDoubleAccessor (&RoutingProtocol::m_zoneRadiusAdaptRatio),
+                   MakeDoubleChecker<double> (1.0))
+    .AddAttribute ("EnableAdaptiveUpdateInterval","Adapts the periodic update interval and Holdtimes to the observed zone churn",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableAdaptiveUpdateInterval),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MinPeriodicUpdateInterval","Shortest periodic update interval the adaptation may choose",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minPeriodicUpdateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxPeriodicUpdateInterval","Longest periodic update interval the adaptation may choose",
+                   TimeValue (Seconds (60)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxPeriodicUpdateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinHoldtimes","Smallest Holdtimes the adaptation may choose",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_minHoldtimes),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MaxHoldtimes","Largest Holdtimes the adaptation may choose",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxHoldtimes),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("ChurnThreshold","Zone members added, changed or lost during one update interval from which "
+                   "the interval is halved; an interval without any change doubles it",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_churnThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("MinTriggeredUpdateInterval","Minimum time between two triggered updates; changes seen meanwhile are sent together",
+                   TimeValue (MilliSeconds (500)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minTriggeredUpdateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableFlapDamping","Leaves the changes of flapping routes to the periodic updates",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableFlapDamping),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FlapHalfLife","Half-life of the flap penalty of a route",
+                   TimeValue (Seconds (15)),
+                   MakeTimeAccessor (&RoutingProtocol::m_flapHalfLife),
+                   MakeTimeChecker ())
+    .AddAttribute ("FlapSuppressThreshold","Flap penalty above which the changes of a route are not triggered; "
+                   "every flap adds 1000",
+                   DoubleValue (2000),
+                   MakeDoubleAccessor (&RoutingProtocol::m_flapSuppressThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("FlapReuseThreshold","Flap penalty below which the changes of a suppressed route are triggered again",
+                   DoubleValue (750),
+                   MakeDoubleAccessor (&RoutingProtocol::m_flapReuseThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("ZoneEngine","Protocol maintaining the zone routes: the DSDV-derived IARP, or link state "
+                   "built from the neighbor sets of the zone members",
+                   EnumValue (ZONE_ENGINE_IARP),
+                   MakeEnumAccessor (&RoutingProtocol::m_zoneEngine),
+                   MakeEnumChecker (ZONE_ENGINE_IARP, "Iarp",
+                                    ZONE_ENGINE_LINK_STATE, "LinkState"))
+    .AddAttribute ("NeighborSetInterval","Interval between two neighbor sets of the link-state zone engine",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&RoutingProtocol::m_neighborSetInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("NeighborHoldTime","Time a neighbor, or the neighbor set of a zone member, is kept without being heard again",
+                   TimeValue (Seconds (6)),
+                   MakeTimeAccessor (&RoutingProtocol::m_neighborHoldTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableQueryDetection","Drops the relay of a RREQ when every peripheral zone member "
+                   "already lies within the zone of a node heard relaying it",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableQueryDetection),
+                   MakeBooleanChecker ())
+    .AddAttribute ("EnableProxyReply","A node with the destination of a RREQ in its zone answers it "
+                   "instead of forwarding it to the destination",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableProxyReply),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RreqDissemination","How a RREQ is carried beyond the zone: re-broadcast by every node, "
+                   "bordercast along the zone routes to the peripheral nodes, re-broadcast by the multipoint relays only, "
+                   "or re-broadcast unless enough copies were overheard",
+                   EnumValue (RREQ_FLOOD),
+                   MakeEnumAccessor (&RoutingProtocol::m_rreqDissemination),
+                   MakeEnumChecker (RREQ_FLOOD, "Flood",
+                                    RREQ_BORDERCAST, "Bordercast",
+                                    RREQ_MPR, "Mpr",
+                                    RREQ_GOSSIP, "Gossip"))
+    .AddAttribute ("GossipAssessmentDelay","Maximum random delay during which a gossiping node counts the copies of a RREQ "
+                   "before deciding to re-broadcast it",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&RoutingProtocol::m_gossipAssessmentDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("GossipCounterThreshold","Copies of a RREQ heard from which a gossiping node does not re-broadcast it",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_gossipCounterThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("GossipNeighbors","A gossiping node with more neighbors re-broadcasts with probability "
+                   "GossipNeighbors / neighbors; 0 always re-broadcasts below the counter threshold",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::m_gossipNeighbors),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ActiveRouteTimeout","Period of time during which an IERP route is considered to be valid once used",
+                   TimeValue (Seconds (3)),
+                   MakeTimeAccessor (&RoutingProtocol::m_activeRouteTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableRouteCache","Keeps the routes to the most popular destinations longer, "
+                   "and answers RREQs only with routes that still have CachedReplyMinLifetime to live",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableRouteCache),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteCacheSize","Number of destinations whose routes are kept as hot at once",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&RoutingProtocol::m_routeCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PopularityHalfLife","Half-life of the count of RREQs, RREPs and data packets seen for a destination",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&RoutingProtocol::m_popularityHalfLife),
+                   MakeTimeChecker ())
+    .AddAttribute ("HotRouteTimeout","Lifetime given to a route to a hot destination each time it is learnt or used",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_hotRouteTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("CachedReplyMinLifetime","Remaining lifetime a route needs for an intermediate node to answer a RREQ with it",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_cachedReplyMinLifetime),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableZoneRing","Start the expanding ring search just beyond the zone and grow it by zone diameters",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::m_zoneRing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Sink","Sink of the collection tree: it floods a beacon every SinkBeaconInterval and every node "
+                   "keeps a route to it through the neighbor closest to it; none disables the tree",
+                   Ipv4AddressValue (),
+                   MakeIpv4AddressAccessor (&RoutingProtocol::m_sink),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("SinkBeaconInterval","Interval between two beacons of the sink",
+                   TimeValue (Seconds (5)),
+                   MakeTimeAccessor (&RoutingProtocol::m_sinkBeaconInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("SinkParentHysteresis","Hops by which a neighbor must beat the parent toward the sink to replace it",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_sinkHysteresis),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("AnycastGroup","Anycast group address: a route to it leads to the nearest of the AnycastMembers; "
+                   "none disables anycast",
+                   Ipv4AddressValue (),
+                   MakeIpv4AddressAccessor (&RoutingProtocol::m_anycastGroup),
+                   MakeIpv4AddressChecker ())
+    .AddAttribute ("EnableRequestMerging","A relay holds the RREQ of a new origin for a destination another discovery "
+                   "it relayed looks for, and copies the RREP of that discovery to it",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableRequestMerging),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RequestMergeTime","Time a relayed discovery holds the RREQs for the same destination "
+                   "before they are relayed anyway",
+                   TimeValue (MilliSeconds (200)),
+                   MakeTimeAccessor (&RoutingProtocol::m_requestMergeTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableReplyAck","Every RREP sent toward its origin asks the next hop for a RREP-ACK; "
+                   "a next hop that misses ReplyAckMisses of them in a row is blacklisted as a unidirectional link",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableReplyAck),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ReplyAckMisses","Number of RREP-ACKs in a row a neighbor misses before it is blacklisted",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_replyAckMisses),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("NextHopWait","Period of our waiting for the neighbour's RREP_ACK",
+                   TimeValue (MilliSeconds (50)),
+                   MakeTimeAccessor (&RoutingProtocol::m_nextHopWait),
+                   MakeTimeChecker ())
+    .AddAttribute ("BlackListTimeout","Time for which the node is put into the blacklist",
+                   TimeValue (Seconds (5.6)),
+                   MakeTimeAccessor (&RoutingProtocol::m_blackListTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableRouteErrors","A broken link to the next hop of IERP routes, or a data packet with no route "
+                   "to forward it, sends a RERR to the precursors of the routes",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableRouteErrors),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RerrRateLimit","Maximum number of RERR per second.",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&RoutingProtocol::m_rerrRateLimit),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("EnableLocalRepair","A node forwarding for others buffers the packets of a broken route "
+                   "and looks for a new one with a small ring RREQ before it sends a RERR",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableLocalRepair),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxRepairTtl","Largest ring of a local repair: the hops of the broken route beyond the zone radius",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxRepairTtl),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("LocalAddTtl","Value used in calculation RREQ TTL when use local repair.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_localAddTtl),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("EnableHello","Broadcasts hello messages, skipped while the node sends other control broadcasts, "
+                   "to detect the neighbors lost",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableHello),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HelloInterval","Initial interval between two hello messages",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_helloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinHelloInterval","Shortest hello interval the adaptation to the neighbor churn may choose",
+                   TimeValue (MilliSeconds (500)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minHelloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxHelloInterval","Longest hello interval the adaptation to the neighbor churn may choose",
+                   TimeValue (Seconds (2)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxHelloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("AllowedHelloLoss","Number of hello messages which may be lost for a valid link.",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_allowedHelloLoss),
+                   MakeUintegerChecker<uint16_t> (1))
+    .AddAttribute ("HelloChurnThreshold","Neighbors opened or lost during one hello interval from which "
+                   "the interval is halved; an interval without any change doubles it",
+                   UintegerValue (2),
+                   MakeUintegerAccessor (&RoutingProtocol::m_helloChurnThreshold),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EnableLinkQuality","Select the zone and IERP routes by the sum of the ETX of their links, "
+                   "measured from the hellos and control broadcasts of the neighbors, instead of their hop count",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableLinkQuality),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LinkQualityWindow","Span of the window the delivery ratio of a link is measured over",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_linkQualityWindow),
+                   MakeTimeChecker ())
+    .AddAttribute ("MetricHysteresis","Fraction by which the metric of a new path must beat that of the current "
+                   "one to replace it",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&RoutingProtocol::m_metricHysteresis),
+                   MakeDoubleChecker<double> (0, 1))
+    .AddAttribute ("EnableLinkExpiration","The hellos advertise the position and velocity of the node; the lifetimes "
+                   "of the routes are capped at the predicted break of their links and a source looks for a new "
+                   "route before its route breaks",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableLinkExpiration),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TransmissionRange","Transmission range the link breaks are predicted for, in meters",
+                   DoubleValue (100),
+                   MakeDoubleAccessor (&RoutingProtocol::m_transmissionRange),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("LinkExpirationGuard","Time before the predicted break of its route the source looks for a new one",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_linkExpirationGuard),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableRouteRefresh","A source looks for a new IERP route for an active flow shortly before "
+                   "the route expires, and keeps sending over the old one until the RREP replaces it",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableRouteRefresh),
+                   MakeBooleanChecker ())
+    .AddAttribute ("RouteRefreshLead","Time before its IERP route expires an active flow looks for a new one",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_routeRefreshLead),
+                   MakeTimeChecker ())
+    .AddAttribute ("ActiveFlowTimeout","Time after its last packet a flow stays active and its route refreshed",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_activeFlowTimeout),
+                   MakeTimeChecker ())
+    .AddAttribute ("EnableMultipath","Keep equally short zone paths and link disjoint IERP paths besides the routes, "
+                   "spread the flows over them by a hash of the flow and fail over to them on a link break",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableMultipath),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxPaths","Maximum number of paths kept per destination, the route included",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxPaths),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("EnableLoadBalancing","Advertise the load of the node in the IARP updates, add the load of the next hop "
+                   "to the link metric and delay the RREQ re-broadcasts of a busy node",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::EnableLoadBalancing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("LoadWeight","Number of links a neighbor with full queues adds to the link metric",
+                   DoubleValue (1),
+                   MakeDoubleAccessor (&RoutingProtocol::m_loadWeight),
+                   MakeDoubleChecker<double> (0))
+    .AddAttribute ("MaxLoadDelay","RREQ re-broadcast delay of a node with full queues, on top of the jitter",
+                   TimeValue (MilliSeconds (20)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxLoadDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("RreqBatchDelay","Time a RREQ waits for the other destinations asked for to share it",
+                   TimeValue (MilliSeconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_rreqBatchDelay),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxRreqDestinations","Maximum number of destinations a RREQ asks for; 1 disables the batching",
+                   UintegerValue (8),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxRreqDestinations),
+                   MakeUintegerChecker<uint32_t> (1, 255))
+    .AddAttribute ("AnycastMembers","Space separated addresses of the members of the anycast group",
+                   StringValue (""),
+                   MakeStringAccessor (&RoutingProtocol::m_anycastMemberList),
+                   MakeStringChecker ())
+    .AddAttribute ("DiameterWindow","Period over which the largest RREQ and RREP hop count is kept "
+                   "to estimate the network diameter",
+                   TimeValue (Seconds (30)),
+                   MakeTimeAccessor (&RoutingProtocol::m_diameterWindow),
+                   MakeTimeChecker ())
+    .AddTraceSource ("Tx","A control packet is sent.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_txTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("Rx","A control packet is received.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rxTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("LocalRepair","A local repair of a broken route ended.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_localRepairTrace),
+                     "ns3::shingo::RoutingProtocol::LocalRepairTracedCallback");
 /**********IARP*****************/
  return tid;
 }
@@ -189,21 +535,81 @@ RoutingProtocol::GetEnableRAFlag () const
   return EnableRouteAggregation;
 }
 
+uint32_t
+RoutingProtocol::GetZoneRadius () const
+{
+  return m_zoneRadius;
+}
+
+Time
+RoutingProtocol::GetPeriodicUpdateInterval () const
+{
+  return m_periodicUpdateInterval;
+}
+
+uint32_t
+RoutingProtocol::GetZoneHopCount (Ipv4Address dst)
+{
+  RoutingTableEntry rt;
+  if (m_routingTable.LookupRoute (dst,rt) && rt.GetFlag () == VALID)
+    {
+      return rt.GetHop ();
+    }
+  return 0;
+}
+
 RoutingProtocol::RoutingProtocol ()
   : m_routingTable (),
     m_advRoutingTable (),
     m_queue (),
+    m_zoneChanges (0),
+    m_neighborSetSeqNo (0),
     m_nb (Seconds(1)),
     m_rreqRetries (2),
     m_rreqRateLimit (10),
     m_rreqCount (0),
+    m_rerrRateLimit (10),
+    m_rerrCount (0),
+    EnableRouteErrors (true),
+    EnableLocalRepair (true),
+    m_maxRepairTtl (3),
+    m_localAddTtl (2),
+    EnableHello (true),
+    m_helloInterval (Seconds (1)),
+    m_minHelloInterval (MilliSeconds (500)),
+    m_maxHelloInterval (Seconds (2)),
+    m_allowedHelloLoss (2),
+    m_helloChurnThreshold (2),
+    EnableLinkQuality (false),
+    m_linkQualityWindow (Seconds (10)),
+    m_metricHysteresis (0.1),
+    EnableLinkExpiration (false),
+    m_transmissionRange (100),
+    m_linkExpirationGuard (Seconds (1)),
+    EnableRouteRefresh (true),
+    m_routeRefreshLead (Seconds (1)),
+    m_activeFlowTimeout (Seconds (10)),
+    EnableMultipath (false),
+    m_maxPaths (3),
+    EnableLoadBalancing (false),
+    m_loadWeight (1),
+    m_maxLoadDelay (MilliSeconds (20)),
     m_seqNo (0),
     m_requestId (0),
     m_rreqIdCache (m_pathDiscoveryTime),
+    m_mprRelayCache (Seconds (3)),
     m_ttlStart (1),
     m_ttlIncrement (2),
     m_ttlThreshold (7),
     m_netDiameter (35),
+    m_zoneRing (true),
+    m_diameterWindow (Seconds (30)),
+    m_diameterEstimate (0),
+    m_lastDiameterEstimate (0),
+    m_sinkSeqNo (0),
+    m_sinkHop (0),
+    m_rreqBatchDelay (MilliSeconds (10)),
+    m_maxRreqDestinations (8),
     m_timeoutBuffer (2),
     m_nodeTraversalTime (MilliSeconds (40)),
     m_netTraversalTime (Time ((2 * m_netDiameter) * m_nodeTraversalTime)),
@@ -211,12 +617,31 @@ RoutingProtocol::RoutingProtocol ()
     m_myRouteTimeout (Time (2 * std::max (m_pathDiscoveryTime, Seconds (3)))),
     m_nextHopWait (m_nodeTraversalTime + MilliSeconds (10)),
     m_blackListTimeout (Time (m_rreqRetries * m_netTraversalTime)),
+    EnableReplyAck (true),
+    m_replyAckMisses (3),
     m_destinationOnly (false),
     m_gratuitousReply (true),
     m_queue2 (64, Seconds(30)),
-    m_periodicUpdateTimer (Timer::CANCEL_ON_DESTROY)
+    m_rreqRateLimitTimer (Timer::CANCEL_ON_DESTROY),
+    m_periodicUpdateTimer (Timer::CANCEL_ON_DESTROY),
+    m_triggeredExpireTimer (Timer::CANCEL_ON_DESTROY),
+    m_zoneSolicitTimer (Timer::CANCEL_ON_DESTROY),
+    m_zoneReplyTimer (Timer::CANCEL_ON_DESTROY),
+    m_zoneRadiusTimer (Timer::CANCEL_ON_DESTROY),
+    m_neighborSetTimer (Timer::CANCEL_ON_DESTROY),
+    m_sinkBeaconTimer (Timer::CANCEL_ON_DESTROY),
+    m_rreqBatchTimer (Timer::CANCEL_ON_DESTROY),
+    m_helloTimer (Timer::CANCEL_ON_DESTROY)
 {
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
+  m_zoneSolicitTimer.SetFunction (&RoutingProtocol::SendZoneSolicit,this);
+  m_zoneReplyTimer.SetFunction (&RoutingProtocol::SendZoneReply,this);
+  m_triggeredExpireTimer.SetFunction (&RoutingProtocol::SendTriggeredUpdate,this);
+  m_neighborSetTimer.SetFunction (&RoutingProtocol::SendNeighborSet,this);
+  m_sinkBeaconTimer.SetFunction (&RoutingProtocol::SinkBeaconTimerExpire,this);
+  m_rreqBatchTimer.SetFunction (&RoutingProtocol::SendBatchedRequest,this);
+  m_helloTimer.SetFunction (&RoutingProtocol::HelloTimerExpire,this);
+  m_nb.SetCallback (MakeCallback (&RoutingProtocol::HandleLinkFailure, this));
 }
 
 RoutingProtocol::~RoutingProtocol ()
@@ -235,6 +660,7 @@ RoutingProtocol::DoDispose ()
       iter->first->Close ();
     }
   m_socketAddresses.clear ();
+  m_macQueues.clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
@@ -271,12 +697,64 @@ RoutingProtocol::Start ()
   m_queue.SetMaxPacketsPerDst (m_maxQueuedPacketsPerDst);
   m_queue.SetMaxQueueLen (m_maxQueueLen);
   m_queue.SetQueueTimeout (m_maxQueueTime);
-  m_routingTable.Setholddowntime (Time (Holdtimes * m_periodicUpdateInterval));
-  m_advRoutingTable.Setholddowntime (Time (Holdtimes * m_periodicUpdateInterval));
+  m_routingTable.Setholddowntime (GetIarpHoldTime ());
+  m_advRoutingTable.Setholddowntime (GetIarpHoldTime ());
   m_scb = MakeCallback (&RoutingProtocol::Send,this);
   m_ecb = MakeCallback (&RoutingProtocol::Drop,this);
+  m_rreqIdCache.SetLifetime (m_netTraversalTime);
+  m_linkQuality.SetWindow (m_linkQualityWindow);
+  m_linkExpiration.SetRange (m_transmissionRange);
+  m_zoneMultipath.SetMaxPaths (m_maxPaths);
+  m_multipath.SetMaxPaths (m_maxPaths);
+  m_queryDetection.SetLifetime (m_netTraversalTime);
+  m_mprRelayCache.SetLifetime (m_netTraversalTime);
+  m_popularity.SetHalfLife (m_popularityHalfLife);
+  m_popularity.SetCacheSize (m_routeCacheSize);
+  m_rreqRateLimitTimer.SetFunction (&RoutingProtocol::RreqRateLimitTimerExpire, this);
+  m_rreqRateLimitTimer.Schedule (Seconds (1));
+  m_flapDamping.SetHalfLife (m_flapHalfLife);
+  m_flapDamping.SetSuppressThreshold (m_flapSuppressThreshold);
+  m_flapDamping.SetReuseThreshold (m_flapReuseThreshold);
+  m_zoneRadiusAdaptation.SetMinRadius (m_minZoneRadius);
+  m_zoneRadiusAdaptation.SetMaxRadius (m_maxZoneRadius);
+  m_zoneRadiusAdaptation.SetRatio (m_zoneRadiusAdaptRatio);
+  m_helloSchedule.SetInterval (m_helloInterval);
+  m_helloSchedule.SetMinInterval (m_minHelloInterval);
+  m_helloSchedule.SetMaxInterval (m_maxHelloInterval);
+  m_helloSchedule.SetChurnThreshold (m_helloChurnThreshold);
+  m_helloSchedule.SetAllowedLoss (m_allowedHelloLoss);
   m_periodicUpdateTimer.SetFunction (&RoutingProtocol::SendPeriodicUpdate,this);
-  m_periodicUpdateTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE)
+    {
+      m_neighborSetTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+    }
+  else
+    {
+      m_periodicUpdateTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+    }
+  if (EnableZoneSolicit)
+    {
+      ScheduleZoneSolicit ();
+    }
+  if (EnableAdaptiveZoneRadius)
+    {
+      m_zoneRadiusTimer.SetFunction (&RoutingProtocol::AdaptZoneRadius,this);
+      m_zoneRadiusTimer.Schedule (m_zoneRadiusAdaptInterval);
+    }
+  std::istringstream members (m_anycastMemberList);
+  std::string member;
+  while (members >> member)
+    {
+      m_anycastMembers.insert (Ipv4Address (member.c_str ()));
+    }
+  if (m_sink != Ipv4Address ())
+    {
+      m_sinkBeaconTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+    }
+  if (EnableHello)
+    {
+      m_helloTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+    }
 /*********************************/
 }
 
@@ -306,6 +784,12 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
                                 << ", Packet id: " << p->GetUid () << ", Destination address in Packet: " << dst);
   RoutingTableEntry rt;
   m_routingTable.Purge (removedAddresses);
+  m_zoneChanges += removedAddresses.size ();
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE)
+    {
+      // The link-state zone engine sends no IARP update for the routes of the members gone silent
+      removedAddresses.clear ();
+    }
   for (std::map<Ipv4Address, RoutingTableEntry>::iterator rmItr = removedAddresses.begin ();
        rmItr != removedAddresses.end (); ++rmItr)
     {
@@ -315,9 +799,9 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
     }
   if (!removedAddresses.empty ())
     {
-      Simulator::Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)),&RoutingProtocol::SendTriggeredUpdate,this);
+      ScheduleTriggeredUpdate (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
     }
-  if (m_routingTable.LookupRoute (dst,rt))
+  if (LookupZoneRoute (dst,rt))
     {
       if (EnableBuffering)
         {
@@ -354,11 +838,36 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv4Header &header,
                   sockerr = Socket::ERROR_NOROUTETOHOST;
                   return Ptr<Ipv4Route> ();
                 }
-              return route;
+              // The transport header is not added yet: the flows of this node are told apart by destination
+              return SelectPath (route, dst, MultipathTable::GetFlowHash (header.GetSource (), dst, header.GetProtocol (), 0, 0), true);
             }
         }
     }
 
+  // IERP routes, the route to the sink of the collection tree included, need no discovery
+  RoutingTableEntry2 toDst;
+  m_routingTable2.Purge ();
+  if (m_routingTable2.LookupValidRoute (dst, toDst))
+    {
+      route = toDst.GetRoute ();
+      NS_LOG_DEBUG ("An IERP route exists from " << route->GetSource () << " to destination " << dst
+                                                 << " via " << route->GetGateway ());
+      if (oif != 0 && route->GetOutputDevice () != oif)
+        {
+          NS_LOG_DEBUG ("Output device doesn't match. Dropped.");
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return Ptr<Ipv4Route> ();
+        }
+      UpdateRouteLifeTime (dst, m_activeRouteTimeout);
+      UpdateRouteLifeTime (route->GetGateway (), m_activeRouteTimeout);
+      if (EnableRouteRefresh)
+        {
+          m_lastRouteUse[dst] = Simulator::Now ();
+          ScheduleRouteRefresh (dst);
+        }
+      return SelectPath (route, dst, MultipathTable::GetFlowHash (header.GetSource (), dst, header.GetProtocol (), 0, 0), false);
+    }
+
 //  if (EnableBuffering)
 //    {
       uint32_t iif = (oif ? m_ipv4->GetInterfaceForDevice (oif) : -1);
@@ -484,7 +993,7 @@ RoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
         }
     }
 
-  if (m_ipv4->IsDestinationAddress (dst, iif))
+  if (m_ipv4->IsDestinationAddress (dst, iif) || IsAnycastMember (dst))
     {
       if (lcb.IsNull () == false)
         {
@@ -508,7 +1017,7 @@ RoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
     }
 
   RoutingTableEntry toDst;
-  if (m_routingTable.LookupRoute (dst,toDst))
+  if (LookupZoneRoute (dst,toDst))
     {
       RoutingTableEntry ne;
       if (m_routingTable.LookupRoute (toDst.GetNextHop (),ne))
@@ -518,7 +1027,7 @@ RoutingProtocol::RouteInput (Ptr<const Packet> p, const Ipv4Header &header,
                                       << " to " << dst
                                       << " from " << header.GetSource ()
                                       << " via nexthop neighbor " << toDst.GetNextHop ());
-          ucb (route,p,header);
+          ucb (SelectPath (route, dst, GetFlowHash (p, header), true), p, header);
           return true;
         }
     }
@@ -543,7 +1052,7 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
     {
       if (toDst.GetFlag () == VALID)
         {
-          Ptr<Ipv4Route> route = toDst.GetRoute ();
+          Ptr<Ipv4Route> route = SelectPath (toDst.GetRoute (), dst, GetFlowHash (p, header), false);
           NS_LOG_LOGIC (route->GetSource () << " forwarding to " << dst << " from " << origin << " packet " << p->GetUid ());
 
           /*
@@ -554,6 +1063,14 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
            */
           UpdateRouteLifeTime (origin, m_activeRouteTimeout);
           UpdateRouteLifeTime (dst, m_activeRouteTimeout);
+          if (EnableRouteCache)
+            {
+              m_popularity.Record (dst);
+              if (m_popularity.IsHot (dst))
+                {
+                  UpdateRouteLifeTime (dst, m_hotRouteTimeout);
+                }
+            }
           UpdateRouteLifeTime (route->GetGateway (), m_activeRouteTimeout);
           /*
            *  Since the route between each originator and destination pair is expected to be symmetric, the
@@ -572,9 +1089,14 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
         }
       else
         {
+          if (SalvagePacket (p, header, ucb, ecb, toDst))
+            {
+              NS_LOG_DEBUG ("Buffer packet " << p->GetUid () << " while the route to " << dst << " is repaired");
+              return true;
+            }
           if (toDst.GetValidSeqNo ())
             {
-              //SendRerrWhenNoRouteToForward (dst, toDst.GetSeqNo (), origin);
+              SendRerrWhenNoRouteToForward (dst, toDst.GetSeqNo (), origin);
               NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
               return false;
             }
@@ -582,7 +1104,7 @@ RoutingProtocol::Forwarding (Ptr<const Packet> p, const Ipv4Header & header,
     }
   NS_LOG_LOGIC ("route not found to " << dst << ". Send RERR message.");
   NS_LOG_DEBUG ("Drop packet " << p->GetUid () << " because no route to forward it.");
-  //SendRerrWhenNoRouteToForward (dst, 0, origin);
+  SendRerrWhenNoRouteToForward (dst, 0, origin);
   return false;
 }
 
@@ -599,7 +1121,8 @@ RoutingProtocol::UpdateRouteLifeTime (Ipv4Address addr, Time lifetime)
         {
           NS_LOG_DEBUG ("Updating VALID route");
           rt.SetRreqCnt (0);
-          rt.SetLifeTime (std::max (lifetime, rt.GetLifeTime ()));
+          // Use does not keep a route beyond the predicted break of its links
+          rt.SetLifeTime (std::max (std::min (lifetime, GetRouteExpiration (addr)), rt.GetLifeTime ()));
           m_routingTable2.Update (rt);
           return true;
         }
@@ -683,45 +1206,80 @@ RoutingProtocol::RecvShingo (Ptr<Socket> socket)
     }
 */
   NS_LOG_DEBUG ("SHIGNO node " << this << " received a SHINGO packet from " << sender << " to " << receiver);
-/*
-  UpdateRouteToNeighbor (sender, receiver);
-  TypeHeader tHeader (AODVTYPE_RREQ);
+  m_rxTrace (packet);
+  TypeHeader tHeader (SHINGO_IARP);
   packet->RemoveHeader (tHeader);
   if (!tHeader.IsValid ())
     {
-      NS_LOG_DEBUG ("AODV message " << packet->GetUid () << " with unknown type received: " << tHeader.Get () << ". Drop");
+      NS_LOG_DEBUG ("SHINGO message " << packet->GetUid () << " with unknown type received: " << tHeader.Get () << ". Drop");
       return; // drop
     }
-*/
-/*
-printf("%d\n",packet->GetSize());
-  switch (1)
+  CountControlBytes (tHeader.Get (), packet->GetSize () + tHeader.GetSerializedSize ());
+  // Any control message heard keeps the link to its sender open
+  if (!m_nb.IsNeighbor (sender))
+    {
+      m_helloSchedule.RecordChange ();
+    }
+  m_nb.Update (sender, GetNeighborLifetime (sender));
+  if (EnableLinkQuality)
+    {
+      switch (tHeader.Get ())
+        {
+        case SHINGO_IARP:
+        case SHINGO_RREQ:
+        case SHINGO_ZONE_SOLICIT:
+        case SHINGO_NEIGHBOR_SET:
+        case SHINGO_SINK_BEACON:
+          // Broadcasts that stand in for a hello of the sender; the hellos are counted as they are processed
+          m_linkQuality.Receive (sender, GetProbeInterval (sender));
+          break;
+        default:
+          break;
+        }
+    }
+  switch (tHeader.Get ())
     {
     case SHINGO_IARP:
       {
         RecvIarp (packet, receiver, sender);
         break;
       }
+    case SHINGO_RREQ:
+      {
+        RecvRequest (packet, receiver, sender);
+        break;
+      }
+    case SHINGO_RREP:
+      {
+        RecvReply (packet, receiver, sender);
+        break;
+      }
+    case SHINGO_RREP_ACK:
+      {
+        RecvReplyAck (sender);
+        break;
+      }
+    case SHINGO_ZONE_SOLICIT:
+      {
+        RecvZoneSolicit (packet, receiver, sender);
+        break;
+      }
+    case SHINGO_NEIGHBOR_SET:
+      {
+        RecvNeighborSet (packet, receiver, sender);
+        break;
+      }
+    case SHINGO_SINK_BEACON:
+      {
+        RecvSinkBeacon (packet, receiver, sender);
+        break;
+      }
+    case SHINGO_RERR:
+      {
+        RecvError (packet, sender);
+        break;
+      }
     }
-*/
-
-if(packet->GetSize() % 12 == 0)
-  {
-   RecvIarp (packet, receiver, sender);
-  }
-  else if (packet->GetSize() % 23 == 0)
-        {
-         RecvRequest (packet, receiver, sender);
-        }
-  else if (packet->GetSize() % 19 == 0)
-        {
-         RecvReply (packet, receiver, sender);
-        }
-  else //if (packet->GetSize() % 1 == 0)
-        {
-         RecvReplyAck (sender);
-        }
-
 }
 
 
@@ -739,9 +1297,23 @@ RoutingProtocol::RecvIarp (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address
 //printf("RecvIarp \n");
 Ptr<Packet> advpacket = Create<Packet> ();
   Ptr<NetDevice> dev = m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (receiver));
+  // Entries learnt from this sender are kept for the hold time it advertises
+  IarpUpdateHeader updateHeader;
+  packet->RemoveHeader (updateHeader);
+  Time holdTime = updateHeader.GetHoldTime ();
   uint32_t packetSize = packet->GetSize ();
   NS_LOG_FUNCTION (m_mainAddress << " received IARP packet of size: " << packetSize
                                  << " and packet id: " << packet->GetUid ());
+  // Zone routes through a neighbor that does not hear this node would eat the data
+  if (m_blacklist.IsBlacklisted (sender))
+    {
+      NS_LOG_DEBUG ("Ignoring IARP update from node in blacklist " << sender);
+      return;
+    }
+  m_neighborLoad[sender] = updateHeader.GetLoad ();
+  uint16_t linkMetric = GetLinkMetric (sender);
+  // The entries learnt from the sender last until the link to it is predicted to break
+  holdTime = std::min (holdTime, GetLinkExpiration (sender));
   uint32_t count = 0;
   for (; packetSize > 0; packetSize = packetSize - 12)
     {
@@ -774,12 +1346,46 @@ Ptr<Packet> advpacket = Create<Packet> ();
         {
           continue;
         }
+      // The sender hears every node it advertises at one hop: the links of the multipoint relay selection
+      if (iarpHeader.GetHopCount () == 2)
+        {
+          if (iarpHeader.GetDstSeqno () % 2 == 1)
+            {
+              m_mprSelection.RemoveLink (sender, iarpHeader.GetDst ());
+            }
+          else
+            {
+              m_mprSelection.AddLink (sender, iarpHeader.GetDst (), Simulator::Now () + holdTime);
+            }
+        }
+      // Members beyond the zone radius are left to IERP; link breaks are still processed
+      if (iarpHeader.GetHopCount () > m_zoneRadius && iarpHeader.GetDstSeqno () % 2 != 1)
+        {
+          NS_LOG_DEBUG (iarpHeader.GetDst () << " is outside the zone radius " << m_zoneRadius << ". Discarding this.");
+          continue;
+        }
       NS_LOG_DEBUG ("Received a IARP packet from "
                     << sender << " to " << receiver << ". Details are: Destination: " << iarpHeader.GetDst () << ", Seq No: "
                     << iarpHeader.GetDstSeqno () << ", HopCount: " << iarpHeader.GetHopCount ());
+      // The sender advertises its own metric, the link to it is added here
+      uint16_t metric = LinkQuality::Accumulate (iarpHeader.GetMetric (), linkMetric);
       RoutingTableEntry fwdTableEntry, advTableEntry;
       EventId event;
       bool permanentTableVerifier = m_routingTable.LookupRoute (iarpHeader.GetDst (),fwdTableEntry);
+      // An as short and fresh path through another neighbor is kept besides the zone route
+      if (EnableMultipath && permanentTableVerifier && iarpHeader.GetDstSeqno () % 2 != 1 && fwdTableEntry.GetHop () > 1
+          && sender != fwdTableEntry.GetNextHop () && iarpHeader.GetHopCount () == fwdTableEntry.GetHop ()
+          && int32_t (iarpHeader.GetDstSeqno ()) - int32_t (fwdTableEntry.GetSeqNo ()) >= 0
+          && !IsBetterPath (fwdTableEntry.GetHop (), fwdTableEntry.GetMetric (), iarpHeader.GetHopCount (), metric))
+        {
+          MultipathTable::Path path;
+          path.m_nextHop = sender;
+          path.m_hops = iarpHeader.GetHopCount ();
+          path.m_metric = metric;
+          path.m_expire = Simulator::Now () + (holdTime.IsZero () ? m_routingTable.Getholddowntime () : holdTime);
+          m_zoneMultipath.SetPrimary (iarpHeader.GetDst (), fwdTableEntry.GetNextHop (), Ipv4Address ());
+          m_zoneMultipath.AddPath (iarpHeader.GetDst (), path);
+        }
       if (permanentTableVerifier == false)
         {
           if (iarpHeader.GetDstSeqno () % 2 != 1)
@@ -796,7 +1402,10 @@ Ptr<Packet> advpacket = Create<Packet> ();
                 m_settlingTime, /*entries changed*/
                 true);
               newEntry.SetFlag (VALID);
+              newEntry.SetHoldTime (holdTime);
+              newEntry.SetMetric (metric);
               m_routingTable.AddRoute (newEntry);
+              m_zoneChanges++;
               NS_LOG_DEBUG ("New Route added to both tables");
               m_advRoutingTable.AddRoute (newEntry);
             }
@@ -832,24 +1441,29 @@ Ptr<Packet> advpacket = Create<Packet> ();
                       NS_LOG_DEBUG ("Canceling the timer to update route with better seq number");
                     }
                   // if its a changed metric *nomatter* where the update came from, wait  for WST
-                  if (iarpHeader.GetHopCount () != advTableEntry.GetHop ())
+                  if (IsBetterPath (iarpHeader.GetHopCount (), metric, advTableEntry.GetHop (), advTableEntry.GetMetric ())
+                      || IsBetterPath (advTableEntry.GetHop (), advTableEntry.GetMetric (), iarpHeader.GetHopCount (), metric))
                     {
                       advTableEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
                       advTableEntry.SetLifeTime (Simulator::Now ());
+                      advTableEntry.SetHoldTime (holdTime);
                       advTableEntry.SetFlag (VALID);
                       advTableEntry.SetEntriesChanged (true);
                       advTableEntry.SetNextHop (sender);
                       advTableEntry.SetHop (iarpHeader.GetHopCount ());
+                      advTableEntry.SetMetric (metric);
                       NS_LOG_DEBUG ("Received update with better sequence number and changed metric.Waiting for WST");
                       Time tempSettlingtime = GetSettlingTime (iarpHeader.GetDst ());
                       advTableEntry.SetSettlingTime (tempSettlingtime);
                       NS_LOG_DEBUG ("Added Settling Time:" << tempSettlingtime.GetSeconds ()
                                                            << "s as there is no event running for this route");
-                      event = Simulator::Schedule (tempSettlingtime,&RoutingProtocol::SendTriggeredUpdate,this);
+                      event = Simulator::Schedule (tempSettlingtime,&RoutingProtocol::ScheduleTriggeredUpdate,this,Seconds (0));
                       m_advRoutingTable.AddIpv4Event (iarpHeader.GetDst (),event);
                       NS_LOG_DEBUG ("EventCreated EventUID: " << event.GetUid ());
                       // if received changed metric, use it but adv it only after wst
                       m_routingTable.Update (advTableEntry);
+                      m_zoneChanges++;
+                      m_flapDamping.RecordFlap (iarpHeader.GetDst ());
                       m_advRoutingTable.Update (advTableEntry);
                     }
                   else
@@ -857,17 +1471,19 @@ Ptr<Packet> advpacket = Create<Packet> ();
                       // Received update with better seq number and same metric.
                       advTableEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
                       advTableEntry.SetLifeTime (Simulator::Now ());
+                      advTableEntry.SetHoldTime (holdTime);
                       advTableEntry.SetFlag (VALID);
                       advTableEntry.SetEntriesChanged (true);
                       advTableEntry.SetNextHop (sender);
                       advTableEntry.SetHop (iarpHeader.GetHopCount ());
+                      advTableEntry.SetMetric (metric);
                       m_advRoutingTable.Update (advTableEntry);
                       NS_LOG_DEBUG ("Route with better sequence number and same metric received. Advertised without WST");
                     }
                 }
               else if (iarpHeader.GetDstSeqno () == advTableEntry.GetSeqNo ())
                 {
-                  if (iarpHeader.GetHopCount () < advTableEntry.GetHop ())
+                  if (IsBetterPath (iarpHeader.GetHopCount (), metric, advTableEntry.GetHop (), advTableEntry.GetMetric ()))
                     {
                       /*Received update with same seq number and better hop count.
                        * As the metric is changed, we will have to wait for WST before sending out this update.
@@ -877,19 +1493,23 @@ Ptr<Packet> advpacket = Create<Packet> ();
                       m_advRoutingTable.ForceDeleteIpv4Event (iarpHeader.GetDst ());
                       advTableEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
                       advTableEntry.SetLifeTime (Simulator::Now ());
+                      advTableEntry.SetHoldTime (holdTime);
                       advTableEntry.SetFlag (VALID);
                       advTableEntry.SetEntriesChanged (true);
                       advTableEntry.SetNextHop (sender);
                       advTableEntry.SetHop (iarpHeader.GetHopCount ());
+                      advTableEntry.SetMetric (metric);
                       Time tempSettlingtime = GetSettlingTime (iarpHeader.GetDst ());
                       advTableEntry.SetSettlingTime (tempSettlingtime);
                       NS_LOG_DEBUG ("Added Settling Time," << tempSettlingtime.GetSeconds ()
                                                            << " as there is no current event running for this route");
-                      event = Simulator::Schedule (tempSettlingtime,&RoutingProtocol::SendTriggeredUpdate,this);
+                      event = Simulator::Schedule (tempSettlingtime,&RoutingProtocol::ScheduleTriggeredUpdate,this,Seconds (0));
                       m_advRoutingTable.AddIpv4Event (iarpHeader.GetDst (),event);
                       NS_LOG_DEBUG ("EventCreated EventUID: " << event.GetUid ());
                       // if received changed metric, use it but adv it only after wst
                       m_routingTable.Update (advTableEntry);
+                      m_zoneChanges++;
+                      m_flapDamping.RecordFlap (iarpHeader.GetDst ());
                       m_advRoutingTable.Update (advTableEntry);
                     }
                   else
@@ -905,6 +1525,8 @@ Ptr<Packet> advpacket = Create<Packet> ();
                           if (advTableEntry.GetNextHop () == sender)
                             {
                               advTableEntry.SetLifeTime (Simulator::Now ());
+                              advTableEntry.SetHoldTime (holdTime);
+                              advTableEntry.SetMetric (metric);
                               m_routingTable.Update (advTableEntry);
                             }
                           m_advRoutingTable.DeleteRoute (
@@ -928,13 +1550,32 @@ Ptr<Packet> advpacket = Create<Packet> ();
             {
               NS_LOG_DEBUG ("Route with infinite metric received for "
                             << iarpHeader.GetDst () << " from " << sender);
+              m_zoneMultipath.RemovePath (iarpHeader.GetDst (), sender);
+              MultipathTable::Path path;
+              if (EnableMultipath && sender == fwdTableEntry.GetNextHop () && fwdTableEntry.GetHop () > 1
+                  && m_zoneMultipath.TakeBestPath (iarpHeader.GetDst (), path))
+                {
+                  // The zone route goes on through another neighbor as short: nothing to advertise
+                  NS_LOG_DEBUG ("Zone route to " << iarpHeader.GetDst () << " fails over to " << path.m_nextHop);
+                  fwdTableEntry.SetNextHop (path.m_nextHop);
+                  fwdTableEntry.SetMetric (path.m_metric);
+                  fwdTableEntry.SetLifeTime (Simulator::Now ());
+                  fwdTableEntry.SetHoldTime (path.m_expire - Simulator::Now ());
+                  m_routingTable.Update (fwdTableEntry);
+                  if (!m_advRoutingTable.AnyRunningEvent (iarpHeader.GetDst ()))
+                    {
+                      m_advRoutingTable.DeleteRoute (iarpHeader.GetDst ());
+                    }
+                }
               // Delete route only if update was received from my nexthop neighbor
-              if (sender == advTableEntry.GetNextHop ())
+              else if (sender == advTableEntry.GetNextHop ())
                 {
                   NS_LOG_DEBUG ("Triggering an update for this unreachable route:");
                   std::map<Ipv4Address, RoutingTableEntry> dstsWithNextHopSrc;
                   m_routingTable.GetListOfDestinationWithNextHop (iarpHeader.GetDst (),dstsWithNextHopSrc);
                   m_routingTable.DeleteRoute (iarpHeader.GetDst ());
+                  m_zoneChanges += 1 + dstsWithNextHopSrc.size ();
+                  m_flapDamping.RecordFlap (iarpHeader.GetDst ());
                   advTableEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
                   advTableEntry.SetEntriesChanged (true);
                   m_advRoutingTable.Update (advTableEntry);
@@ -964,11 +1605,11 @@ Ptr<Packet> advpacket = Create<Packet> ();
   m_advRoutingTable.GetListOfAllRoutes (allRoutes);
   if (EnableRouteAggregation && allRoutes.size () > 0)
     {
-      Simulator::Schedule (m_routeAggregationTime,&RoutingProtocol::SendTriggeredUpdate,this);
+      ScheduleTriggeredUpdate (m_routeAggregationTime);
     }
   else
     {
-      Simulator::Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)),&RoutingProtocol::SendTriggeredUpdate,this);
+      ScheduleTriggeredUpdate (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
     }
 }
 
@@ -982,56 +1623,113 @@ RoutingProtocol::RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address s
   p->RemoveHeader (rreqHeader);
 
   // A node ignores all RREQs received from any node in its blacklist
-  RoutingTableEntry2 toPrev;
-  if (m_routingTable2.LookupRoute (src, toPrev))
+  if (m_blacklist.IsBlacklisted (src))
     {
-      if (toPrev.IsUnidirectional ())
-        {
-          NS_LOG_DEBUG ("Ignoring RREQ from node in blacklist");
-          return;
-        }
+      NS_LOG_DEBUG ("Ignoring RREQ from node in blacklist");
+      return;
     }
 
   uint32_t id = rreqHeader.GetId ();
   Ipv4Address origin = rreqHeader.GetOrigin ();
+  uint16_t metric = LinkQuality::Accumulate (rreqHeader.GetMetric (), GetLinkMetric (src));
+  // The node next to the origin tells the link disjoint paths to the origin apart
+  Ipv4Address firstHop = rreqHeader.GetHopCount () == 0 ? receiver : rreqHeader.GetFirstHop ();
+
+  /*
+   * A bordercast is processed by its targets, forwarded by its relays and only overheard by the other nodes.
+   * Its relays cover nothing by themselves: the zone covered is the one of the bordercaster.
+   */
+  Ipv4Address relayer = src;
+  BordercastHeader bordercastHeader;
+  bool relayOnly = false;
+  // Only the multipoint relays of the sender re-broadcast the RREQ, if it lists them
+  MprSetHeader mprSetHeader;
+  bool mprFlood = rreqHeader.GetMprFlood ();
+  if (mprFlood)
+    {
+      p->RemoveHeader (mprSetHeader);
+      rreqHeader.SetMprFlood (false);
+    }
+  bool mprRelay = !mprFlood || mprSetHeader.IsRelay (receiver);
+  if (rreqHeader.GetBordercast ())
+    {
+      p->RemoveHeader (bordercastHeader);
+      rreqHeader.SetBordercast (false);
+      relayer = bordercastHeader.GetBordercaster ();
+      if (!bordercastHeader.IsTarget (receiver) && !IsRequestedDestination (rreqHeader))
+        {
+          m_queryDetection.Record (origin, id, relayer);
+          if (!bordercastHeader.IsRelay (receiver))
+            {
+              return;
+            }
+          relayOnly = true;
+        }
+    }
 
   /*
    *  Node checks to determine whether it has received a RREQ with the same Originator IP Address and RREQ ID.
    *  If such a RREQ has been received, the node silently discards the newly received RREQ.
    */
-  if (m_rreqIdCache.IsDuplicate (origin, id))
+  // Every copy heard tells that its sender relayed the query, duplicates included
+  if (!relayOnly)
     {
+      m_queryDetection.Record (origin, id, relayer);
+    }
+  // A copy over a clearly better path than the ones processed is processed again, so that the reverse route follows it
+  std::map<Ipv4Address, std::pair<uint32_t, uint16_t> >::const_iterator best = m_rreqBestMetric.find (origin);
+  bool betterCopy = EnableLinkQuality && best != m_rreqBestMetric.end () && best->second.first == id
+    && IsBetterPath (0, metric, 0, best->second.second);
+  if (!relayOnly && m_rreqIdCache.IsDuplicate (origin, id) && !betterCopy)
+    {
+      if (EnableMultipath)
+        {
+          AddReversePath (rreqHeader, src, firstHop, metric);
+        }
+      // A relay left out by the first sender still re-broadcasts for a later one that selected it
+      if (mprFlood && mprRelay && m_rreqDissemination == RREQ_MPR && rreqHeader.GetHopCount () < GetHopCap ()
+          && rreqHeader.GetTtl () > 1 && !m_mprRelayCache.IsDuplicate (origin, id))
+        {
+          AdvanceRequest (rreqHeader, metric, firstHop);
+          rreqHeader.SetTtl (rreqHeader.GetTtl () - 1);
+          RelayRequestToMprs (rreqHeader);
+        }
       NS_LOG_DEBUG ("Ignoring RREQ due to duplicate");
       return;
     }
+  if (EnableLinkQuality && !relayOnly)
+    {
+      m_rreqBestMetric[origin] = std::make_pair (id, metric);
+    }
 
-  // Increment RREQ hop count
-  uint8_t hop = rreqHeader.GetHopCount () + 1;
-  rreqHeader.SetHopCount (hop);
+  if (EnableRouteCache)
+    {
+      m_popularity.Record (rreqHeader.GetDst ());
+      for (std::vector<RreqHeader::Destination>::const_iterator d = rreqHeader.GetDestinations ().begin ();
+           d != rreqHeader.GetDestinations ().end (); ++d)
+        {
+          m_popularity.Record (d->m_dst);
+        }
+    }
 
-  if(hop > 8) return;
+  // Increment RREQ hop count
+  uint8_t hop = AdvanceRequest (rreqHeader, metric, firstHop);
+  ObserveHopCount (hop);
+  if (hop > GetHopCap ())
+    {
+      NS_LOG_DEBUG ("Hop cap exceeded. Drop RREQ origin " << origin << " with hop count " << (uint32_t) hop);
+      return;
+    }
 
 int check = 0;
 
-  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
-  m_routingTable.GetListOfAllRoutes (allRoutes);
-  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+  // The destination is in the zone only through a valid zone route the RREQ can be forwarded on:
+  // not through a blacklisted neighbor, and for the anycast group through the nearest member
+  RoutingTableEntry toZoneDst;
+  if (LookupZoneRoute (rreqHeader.GetDst (), toZoneDst) && toZoneDst.GetFlag () == VALID)
     {
-      RoutingTableEntry rt;
-      RoutingTableEntry2 rt2;
-      rt = i->second;
-/*
-      if(i->second.GetDestination() == src &&  rreqHeader.GetHopCount () > i->second.GetHop())
-         {
-           return;
-         }
-*/
-      if(i->second.GetDestination() == rreqHeader.GetDst())
-        {
-          check = 1;
-          //rt2.SetFlag (DISCOVER);
-          NS_LOG_LOGIC (src << " : sender " << receiver << " : receiver discover to " << rreqHeader.GetDst());
-        }
+      check = 1;
+      NS_LOG_LOGIC (src << " : sender " << receiver << " : receiver discover to " << rreqHeader.GetDst());
     }
 
 
@@ -1056,10 +1754,17 @@ int check = 0;
       RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ origin, /*validSeno=*/ true, /*seqNo=*/ rreqHeader.GetOriginSeqno (),
                                               /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0), /*hops=*/ hop,
                                               /*nextHop*/ src, /*timeLife=*/ Time ((2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime)));
+      newEntry.SetMetric (metric);
       m_routingTable2.AddRoute (newEntry);
+      m_multipath.Clear (origin);
     }
   else
     {
+      // The paths of an older discovery may be gone
+      if (int32_t (rreqHeader.GetOriginSeqno ()) - int32_t (toOrigin.GetSeqNo ()) > 0 || !toOrigin.GetValidSeqNo ())
+        {
+          m_multipath.Clear (origin);
+        }
       if (toOrigin.GetValidSeqNo ())
         {
           if (int32_t (rreqHeader.GetOriginSeqno ()) - int32_t (toOrigin.GetSeqNo ()) > 0)
@@ -1076,11 +1781,16 @@ int check = 0;
       toOrigin.SetOutputDevice (m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (receiver)));
       toOrigin.SetInterface (m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0));
       toOrigin.SetHop (hop);
+      toOrigin.SetMetric (metric);
       toOrigin.SetLifeTime (std::max (Time (2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime),
                                       toOrigin.GetLifeTime ()));
       m_routingTable2.Update (toOrigin);
       //m_nb.Update (src, Time (AllowedHelloLoss * HelloInterval));
     }
+  if (EnableMultipath)
+    {
+      m_multipath.SetPrimary (origin, src, firstHop);
+    }
 
 
   RoutingTableEntry2 toNeighbor;
@@ -1091,11 +1801,13 @@ int check = 0;
       RoutingTableEntry2 newEntry (dev, src, false, rreqHeader.GetOriginSeqno (),
                                   m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
                                   1, src, m_activeRouteTimeout);
+      newEntry.SetMetric (GetLinkMetric (src));
       m_routingTable2.AddRoute (newEntry);
     }
   else
     {
       toNeighbor.SetLifeTime (m_activeRouteTimeout);
+      toNeighbor.SetMetric (GetLinkMetric (src));
       toNeighbor.SetValidSeqNo (false);
       toNeighbor.SetSeqNo (rreqHeader.GetOriginSeqno ());
       toNeighbor.SetFlag (VALID);
@@ -1105,6 +1817,9 @@ int check = 0;
       toNeighbor.SetNextHop (src);
       m_routingTable2.Update (toNeighbor);
     }
+  // The RREQ tells the motion of its last link only
+  RecordRouteExpiration (origin, src, GetLinkExpiration (src));
+  RecordRouteExpiration (src, src, GetLinkExpiration (src));
   m_nb.Update (src, Time (2 * Seconds(1)));
 /*
   NS_LOG_LOGIC (receiver << " receive RREQ with hop count " << static_cast<uint32_t> (rreqHeader.GetHopCount ())
@@ -1117,60 +1832,124 @@ int check = 0;
 
 
 
-  //  A node generates a RREP if either:
-  //  (i)  it is itself the destination,
-  if (IsMyOwnAddress (rreqHeader.GetDst ()))
+  // Every destination of the RREQ is answered on its own: the RREQ goes on for the ones left
+  std::vector<RreqHeader::Destination> left;
+  std::vector<RreqHeader::Destination> destinations = rreqHeader.GetDestinations ();
+  rreqHeader.SetDestinations (left);
+  for (std::vector<RreqHeader::Destination>::iterator d = destinations.begin (); d != destinations.end (); ++d)
     {
-      m_routingTable2.LookupRoute (origin, toOrigin);
-      NS_LOG_DEBUG ("Send reply since I am the destination");
-      SendReply (rreqHeader, toOrigin);
-      return;
+      RreqHeader single = rreqHeader;
+      single.SetDst (d->m_dst);
+      single.SetDstSeqno (d->m_dstSeqNo);
+      single.SetDestinationOnly (d->m_destinationOnly);
+      single.SetUnknownSeqno (d->m_unknownSeqNo);
+      if (!ReplyToRequest (single, src))
+        {
+          d->m_dstSeqNo = single.GetDstSeqno ();
+          d->m_unknownSeqNo = single.GetUnknownSeqno ();
+          left.push_back (*d);
+        }
     }
-
-  /*
-   * (ii) or it has an active route to the destination, the destination sequence number in the node's existing route table entry for the destination
-   *      is valid and greater than or equal to the Destination Sequence Number of the RREQ, and the "destination only" flag is NOT set.
-   */
-  RoutingTableEntry2 toDst;
-  Ipv4Address dst = rreqHeader.GetDst ();
-  if (m_routingTable2.LookupRoute (dst, toDst))
+  if (ReplyToRequest (rreqHeader, src))
     {
-      /*
-       * Drop RREQ, This node RREP will make a loop.
-       */
-      if (toDst.GetNextHop () == src)
+      if (left.empty ())
         {
-          NS_LOG_DEBUG ("Drop RREQ from " << src << ", dest next hop " << toDst.GetNextHop ());
           return;
         }
-      /*
-       * The Destination Sequence number for the requested destination is set to the maximum of the corresponding value
-       * received in the RREQ message, and the destination sequence value currently maintained by the node for the requested destination.
-       * However, the forwarding node MUST NOT modify its maintained value for the destination sequence number, even if the value
-       * received in the incoming RREQ is larger than the value currently maintained by the forwarding node.
-       */
-      if ((rreqHeader.GetUnknownSeqno () || (int32_t (toDst.GetSeqNo ()) - int32_t (rreqHeader.GetDstSeqno ()) >= 0))
-          && toDst.GetValidSeqNo () )
+      rreqHeader.SetDst (left.front ().m_dst);
+      rreqHeader.SetDstSeqno (left.front ().m_dstSeqNo);
+      rreqHeader.SetDestinationOnly (left.front ().m_destinationOnly);
+      rreqHeader.SetUnknownSeqno (left.front ().m_unknownSeqNo);
+      left.erase (left.begin ());
+      RoutingTableEntry zoneDst;
+      check = LookupZoneRoute (rreqHeader.GetDst (), zoneDst) && zoneDst.GetFlag () == VALID ? 1 : 0;
+    }
+  rreqHeader.SetDestinations (left);
+  // Only a RREQ for a single destination is steered along the zone route to it
+  if (!left.empty ())
+    {
+      check = 0;
+    }
+  Ipv4Address dst = rreqHeader.GetDst ();
+
+  // The expanding ring bounds the search only: a RREQ within reach of the destination zone is routed to it
+  if (check == 0 && rreqHeader.GetTtl () < 2)
+    {
+      NS_LOG_DEBUG ("TTL exceeded. Drop RREQ origin " << src << " destination " << dst );
+      return;
+    }
+  if (rreqHeader.GetTtl () > 0)
+    {
+      rreqHeader.SetTtl (rreqHeader.GetTtl () - 1);
+    }
+
+  if (relayOnly)
+    {
+      Time loadDelay = GetLoadDelay ();
+      for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+             m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
         {
-          if (!rreqHeader.GetDestinationOnly () && toDst.GetFlag () == VALID)
-            {
-              m_routingTable2.LookupRoute (origin, toOrigin);
-              SendReplyByIntermediateNode (toDst, toOrigin, rreqHeader.GetGratuitousRrep ());
-              return;
-            }
-          rreqHeader.SetDstSeqno (toDst.GetSeqNo ());
-          rreqHeader.SetUnknownSeqno (false);
+          Ipv4Address destination = j->second.GetMask () == Ipv4Mask::GetOnes () ? Ipv4Address ("255.255.255.255") : j->second.GetBroadcast ();
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))) + loadDelay, &RoutingProtocol::RelayBordercast, this,
+                               j->first, rreqHeader, bordercastHeader, destination);
         }
+      return;
     }
 
-  SocketIpTtlTag tag;
-  p->RemovePacketTag (tag);
-  if (tag.GetTtl () < 2)
+  // A RREQ for a destination another discovery already looks for waits for the RREP of that one
+  if (check == 0 && EnableRequestMerging && mprRelay && rreqHeader.GetDestinations ().empty ())
     {
-      NS_LOG_DEBUG ("TTL exceeded. Drop RREQ origin " << src << " destination " << dst );
+      if (m_discoveryMerge.Hold (rreqHeader))
+        {
+          NS_LOG_DEBUG ("Hold RREQ of " << origin << " for " << dst << ", a discovery is in flight");
+          return;
+        }
+      m_discoveryMerge.Record (rreqHeader, m_requestMergeTime);
+      Simulator::Schedule (m_requestMergeTime, &RoutingProtocol::ReleaseHeldRequests, this, dst);
+    }
+  if (check == 0)  //if(toDst.GetFlag () == IN_SEARCH)
+    {
+      BroadcastRequest (rreqHeader, mprRelay);
       return;
     }
 
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (rreqHeader);
+      TypeHeader tHeader (SHINGO_RREQ);
+      packet->AddHeader (tHeader);
+      //bordercast先のルートへのnexthopに送信したい
+      RoutingTableEntry rt;
+      if (LookupZoneRoute (rreqHeader.GetDst (), rt))
+        {
+          NS_LOG_LOGIC ("Hop: " << rt.GetHop() << "dest" << rt.GetDestination() << "next" << rt.GetNextHop());
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))) + GetLoadDelay (), &RoutingProtocol::SendTo, this, socket, packet, rt.GetNextHop ());
+          return;
+        }
+    }
+  // The zone route went away in the meantime: search on as if the destination were not in the zone
+  BroadcastRequest (rreqHeader, mprRelay);
+}
+
+void
+RoutingProtocol::BroadcastRequest (RreqHeader const & rreqHeader, bool mprRelay)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  Ipv4Address origin = rreqHeader.GetOrigin ();
+  uint32_t id = rreqHeader.GetId ();
+  if (m_rreqDissemination == RREQ_MPR)
+    {
+      if (mprRelay && !m_mprRelayCache.IsDuplicate (origin, id))
+        {
+          RelayRequestToMprs (rreqHeader);
+        }
+      return;
+    }
+  // A busy relay re-broadcasts late, so that lightly loaded paths win the discovery
+  Time loadDelay = GetLoadDelay ();
   for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
          m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
     {
@@ -1181,15 +1960,10 @@ int check = 0;
       //ttl.SetTtl (tag.GetTtl () - 1);
       //packet->AddPacketTag (ttl);
       packet->AddHeader (rreqHeader);
-      //TypeHeader tHeader (AODVTYPE_RREQ);
-      //packet->AddHeader (tHeader);
+      TypeHeader tHeader (SHINGO_RREQ);
+      packet->AddHeader (tHeader);
       // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
       Ipv4Address destination;
-
-//broadcast or unicast
-if(check == 0)  //if(toDst.GetFlag () == IN_SEARCH)
-  {
-//printf("0 \n");
       if (iface.GetMask () == Ipv4Mask::GetOnes ())
         {
           destination = Ipv4Address ("255.255.255.255");
@@ -1199,287 +1973,2311 @@ if(check == 0)  //if(toDst.GetFlag () == IN_SEARCH)
           destination = iface.GetBroadcast ();
         }
       m_lastBcastTime = Simulator::Now ();
-      Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendTo, this, socket, packet, destination);
-    }else if(check == 1)  //else if(toDst.GetFlag () == DISCOVER)
-    {
-//printf("1 \n");
-//bordercast先のルートへのnexthopに送信したい
-  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
-  m_routingTable.GetListOfAllRoutes (allRoutes);
-  //m_lastBcastTime = Simulator::Now ();
-  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
-    {
-      RoutingTableEntry rt;
-      rt = i->second;
-      if(i->second.GetDestination() == rreqHeader.GetDst ())
+      if (m_rreqDissemination == RREQ_BORDERCAST)
         {
-         NS_LOG_LOGIC ("Hop: " << i->second.GetHop() << "dest" << i->second.GetDestination() << "next" << i->second.GetNextHop());
-         destination = i->second.GetNextHop();
-         Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendTo, this, socket, packet, destination);
-return;
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))) + loadDelay, &RoutingProtocol::Bordercast, this, socket, rreqHeader, destination);
+        }
+      else if (m_rreqDissemination == RREQ_GOSSIP)
+        {
+          Time rad = MicroSeconds (m_uniformRandomVariable->GetInteger (0, m_gossipAssessmentDelay.GetMicroSeconds ()));
+          Simulator::Schedule (rad + loadDelay, &RoutingProtocol::GossipRequest, this, socket, packet, destination, origin, id);
+        }
+      else
+        {
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))) + loadDelay, &RoutingProtocol::RelayRequest, this, socket, packet, destination, origin, id);
         }
     }
-    }
-
-    }
-
 }
 
-bool
-RoutingProtocol::IsMyOwnAddress (Ipv4Address src)
+void
+RoutingProtocol::ReleaseHeldRequests (Ipv4Address dst)
 {
-//printf("IsMyOwnAddress \n");
-  NS_LOG_FUNCTION (this << src);
-  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
-         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+  NS_LOG_FUNCTION (this << dst);
+  // No RREP came back through this node: the held RREQs go on by themselves
+  std::vector<RreqHeader> held = m_discoveryMerge.Release (dst);
+  for (std::vector<RreqHeader>::const_iterator i = held.begin (); i != held.end (); ++i)
     {
-      Ipv4InterfaceAddress iface = j->second;
-      if (src == iface.GetLocal ())
-        {
-          return true;
-        }
+      NS_LOG_DEBUG ("Release RREQ of " << i->GetOrigin () << " for " << dst);
+      BroadcastRequest (*i, true);
     }
-//printf("false\n");
-  return false;
 }
 
-
-void
-RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender)
+bool
+RoutingProtocol::ReplyToRequest (RreqHeader & rreqHeader, Ipv4Address src)
 {
-  //printf("RecvReply\n");
-  NS_LOG_FUNCTION (this << " src " << sender);
-  RrepHeader rrepHeader;
-  p->RemoveHeader (rrepHeader);
-  Ipv4Address dst = rrepHeader.GetDst ();
-  NS_LOG_LOGIC ("RREP destination " << dst << " RREP origin " << rrepHeader.GetOrigin ());
-
-  uint8_t hop = rrepHeader.GetHopCount () + 1;
-  rrepHeader.SetHopCount (hop);
+  NS_LOG_FUNCTION (this << rreqHeader.GetDst () << src);
+  Ipv4Address origin = rreqHeader.GetOrigin ();
+  RoutingTableEntry2 toOrigin;
+  m_routingTable2.LookupRoute (origin, toOrigin);
 
-/*
-  // If RREP is Hello message
-  if (dst == rrepHeader.GetOrigin ())
+  //  A node generates a RREP if either:
+  //  (i)  it is itself the destination, or a member of the anycast group it is sent to,
+  if (IsMyOwnAddress (rreqHeader.GetDst ()) || IsAnycastMember (rreqHeader.GetDst ()))
     {
-      //ProcessHello (rrepHeader, receiver);
-      return;
+      NS_LOG_DEBUG ("Send reply since I am the destination");
+      SendReply (rreqHeader, toOrigin);
+      return true;
     }
-*/
+
   /*
-   * If the route table entry to the destination is created or updated, then the following actions occur:
-   * -  the route is marked as active,
-   * -  the destination sequence number is marked as valid,
-   * -  the next hop in the route entry is assigned to be the node from which the RREP is received,
-   *    which is indicated by the source IP address field in the IP header,
-   * -  the hop count is set to the value of the hop count from RREP message + 1
-   * -  the expiry time is set to the current time plus the value of the Lifetime in the RREP message,
-   * -  and the destination sequence number is the Destination Sequence Number in the RREP message.
+   * (ii) or it has an active route to the destination, the destination sequence number in the node's existing route table entry for the destination
+   *      is valid and greater than or equal to the Destination Sequence Number of the RREQ, and the "destination only" flag is NOT set.
    */
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (receiver));
-  RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ dst, /*validSeqNo=*/ true, /*seqno=*/ rrepHeader.GetDstSeqno (),
-                                          /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),/*hop=*/ hop,
-                                          /*nextHop=*/ sender, /*lifeTime=*/ rrepHeader.GetLifeTime ());
   RoutingTableEntry2 toDst;
+  Ipv4Address dst = rreqHeader.GetDst ();
   if (m_routingTable2.LookupRoute (dst, toDst))
     {
       /*
-       * The existing entry is updated only in the following circumstances:
-       * (i) the sequence number in the routing table is marked as invalid in route table entry.
+       * Drop RREQ for this destination, This node RREP will make a loop.
        */
-      if (!toDst.GetValidSeqNo ())
-        {
-          m_routingTable2.Update (newEntry);
-        }
-      // (ii)the Destination Sequence Number in the RREP is greater than the node's copy of the destination sequence number and the known value is valid,
-      else if ((int32_t (rrepHeader.GetDstSeqno ()) - int32_t (toDst.GetSeqNo ())) > 0)
+      if (toDst.GetNextHop () == src)
         {
-          m_routingTable2.Update (newEntry);
+          NS_LOG_DEBUG ("Drop RREQ from " << src << ", dest next hop " << toDst.GetNextHop ());
+          return true;
         }
-      else
+      /*
+       * The Destination Sequence number for the requested destination is set to the maximum of the corresponding value
+       * received in the RREQ message, and the destination sequence value currently maintained by the node for the requested destination.
+       * However, the forwarding node MUST NOT modify its maintained value for the destination sequence number, even if the value
+       * received in the incoming RREQ is larger than the value currently maintained by the forwarding node.
+       */
+      if ((rreqHeader.GetUnknownSeqno () || (int32_t (toDst.GetSeqNo ()) - int32_t (rreqHeader.GetDstSeqno ()) >= 0))
+          && toDst.GetValidSeqNo () )
         {
-          // (iii) the sequence numbers are the same, but the route is marked as inactive.
-          if ((rrepHeader.GetDstSeqno () == toDst.GetSeqNo ()) && (toDst.GetFlag () != VALID))
+          if (!rreqHeader.GetDestinationOnly () && toDst.GetFlag () == VALID
+              && (!EnableRouteCache || toDst.GetLifeTime () >= m_cachedReplyMinLifetime))
             {
-              m_routingTable2.Update (newEntry);
-            }
-          // (iv)  the sequence numbers are the same, and the New Hop Count is smaller than the hop count in route table entry.
-          else if ((rrepHeader.GetDstSeqno () == toDst.GetSeqNo ()) && (hop < toDst.GetHop ()))
-            {
-              m_routingTable2.Update (newEntry);
+              SendReplyByIntermediateNode (toDst, toOrigin, rreqHeader.GetGratuitousRrep ());
+              return true;
             }
+          rreqHeader.SetDstSeqno (toDst.GetSeqNo ());
+          rreqHeader.SetUnknownSeqno (false);
         }
     }
-  else
+
+  /*
+   * (iii) or it has the destination in its zone with a sequence number as fresh as the one of the RREQ:
+   *       the zone route is spliced to the reverse route instead of carrying the RREQ to the destination.
+   */
+  RoutingTableEntry zoneRoute;
+  if (EnableProxyReply && !rreqHeader.GetDestinationOnly ()
+      && LookupZoneRoute (dst, zoneRoute) && zoneRoute.GetFlag () == VALID
+      && (rreqHeader.GetUnknownSeqno () || int32_t (zoneRoute.GetSeqNo ()) - int32_t (rreqHeader.GetDstSeqno ()) >= 0))
     {
-      // The forward route for this destination is created if it does not already exist.
-      NS_LOG_LOGIC ("add new route");
-      m_routingTable2.AddRoute (newEntry);
+      NS_LOG_DEBUG ("Send proxy reply since " << dst << " is in my zone");
+      SendProxyReply (dst, zoneRoute, toOrigin);
+      return true;
     }
+  return false;
+}
 
-  // Acknowledge receipt of the RREP by sending a RREP-ACK message back
-  if (rrepHeader.GetAckRequired ())
+void
+RoutingProtocol::RelayRequest (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination, Ipv4Address origin, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << origin << id);
+  if (EnableQueryDetection && IsQueryCovered (origin, id))
     {
-      SendReplyAck (sender);
-      rrepHeader.SetAckRequired (false);
+      NS_LOG_DEBUG ("Drop RREQ " << id << " of " << origin << ", the zone is already covered");
+      return;
     }
+  SendTo (socket, packet, destination);
+}
 
-  NS_LOG_LOGIC ("receiver " << receiver << " origin " << rrepHeader.GetOrigin ());
-  if (IsMyOwnAddress (rrepHeader.GetOrigin ()))
+bool
+RoutingProtocol::IsQueryCovered (Ipv4Address origin, uint32_t id)
+{
+  if (m_zoneRadius == 0)
     {
-      if (toDst.GetFlag () == IN_SEARCH || toDst.GetFlag () == DISCOVER)
+      return false;
+    }
+  // A peripheral member is covered once it, or the neighbor it is reached through, relayed the query:
+  // it then lies within the zone of a node the query already went through.
+  uint32_t peripheral = 0;
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+  m_routingTable.GetListOfAllRoutes (allRoutes);
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+    {
+      if (i->second.GetFlag () != VALID || i->second.GetHop () != m_zoneRadius)
         {
-          m_routingTable2.Update (newEntry);
-          m_addressReqTimer[dst].Remove ();
-          m_addressReqTimer.erase (dst);
+          continue;
+        }
+      peripheral++;
+      if (!m_queryDetection.HasRelayed (origin, id, i->second.GetDestination ())
+          && !m_queryDetection.HasRelayed (origin, id, i->second.GetNextHop ()))
+        {
+          return false;
         }
-      m_routingTable2.LookupRoute (dst, toDst);
-      SendPacketFromQueue2 (dst, toDst.GetRoute ());
-      return;
     }
+  return peripheral > 0;
+}
 
-  RoutingTableEntry2 toOrigin;
-  if (!m_routingTable2.LookupRoute (rrepHeader.GetOrigin (), toOrigin) || toOrigin.GetFlag () == IN_SEARCH)
+void
+RoutingProtocol::Bordercast (Ptr<Socket> socket, RreqHeader rreqHeader, Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  Ipv4Address origin = rreqHeader.GetOrigin ();
+  uint32_t id = rreqHeader.GetId ();
+  std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator iface = m_socketAddresses.find (socket);
+  if (iface == m_socketAddresses.end ())
     {
-      return; // Impossible! drop.
+      return;
     }
-  toOrigin.SetLifeTime (std::max (m_activeRouteTimeout, toOrigin.GetLifeTime ()));
-  m_routingTable2.Update (toOrigin);
-
-  // Update information about precursors
-  if (m_routingTable2.LookupValidRoute (rrepHeader.GetDst (), toDst))
+  BordercastHeader bordercastHeader (iface->second.GetLocal (), m_zoneRadius - 1);
+  uint32_t peripheral = 0;
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+  m_routingTable.GetListOfAllRoutes (allRoutes);
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
     {
-      toDst.InsertPrecursor (toOrigin.GetNextHop ());
-      m_routingTable2.Update (toDst);
-
-      RoutingTableEntry2 toNextHopToDst;
-      m_routingTable2.LookupRoute (toDst.GetNextHop (), toNextHopToDst);
-      toNextHopToDst.InsertPrecursor (toOrigin.GetNextHop ());
-      m_routingTable2.Update (toNextHopToDst);
-
-      toOrigin.InsertPrecursor (toDst.GetNextHop ());
-      m_routingTable2.Update (toOrigin);
-
-      RoutingTableEntry2 toNextHopToOrigin;
-      m_routingTable2.LookupRoute (toOrigin.GetNextHop (), toNextHopToOrigin);
-      toNextHopToOrigin.InsertPrecursor (toDst.GetNextHop ());
-      m_routingTable2.Update (toNextHopToOrigin);
+      if (m_zoneRadius == 0 || i->second.GetFlag () != VALID || i->second.GetHop () != m_zoneRadius)
+        {
+          continue;
+        }
+      peripheral++;
+      if (EnableQueryDetection && (m_queryDetection.HasRelayed (origin, id, i->second.GetDestination ())
+                                   || m_queryDetection.HasRelayed (origin, id, i->second.GetNextHop ())))
+        {
+          continue;
+        }
+      if (!bordercastHeader.AddTarget (i->second.GetDestination ()) || !bordercastHeader.AddRelay (i->second.GetNextHop ()))
+        {
+          break;
+        }
     }
-/*
-  SocketIpTtlTag tag;
-  p->RemovePacketTag (tag);
-  if (tag.GetTtl () < 2)
+  Ptr<Packet> packet = Create<Packet> ();
+  if (peripheral == 0)
     {
-      NS_LOG_DEBUG ("TTL exceeded. Drop RREP destination " << dst << " origin " << rrepHeader.GetOrigin ());
-      return;
+      // Nothing lies at the zone border, e.g. at the edge of the network: fall back to a broadcast
+      packet->AddHeader (rreqHeader);
+    }
+  else if (bordercastHeader.GetTargets ().empty ())
+    {
+      NS_LOG_DEBUG ("Drop RREQ " << id << " of " << origin << ", the zone is already covered");
+      return;
+    }
+  else
+    {
+      packet->AddHeader (bordercastHeader);
+      rreqHeader.SetBordercast (true);
+      packet->AddHeader (rreqHeader);
+    }
+  TypeHeader tHeader (SHINGO_RREQ);
+  packet->AddHeader (tHeader);
+  SendTo (socket, packet, destination);
+}
+
+void
+RoutingProtocol::RelayBordercast (Ptr<Socket> socket, RreqHeader rreqHeader, BordercastHeader bordercastHeader, Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  uint8_t hopsLeft = bordercastHeader.GetHopsLeft ();
+  if (hopsLeft == 0)
+    {
+      return;
+    }
+  BordercastHeader next (bordercastHeader.GetBordercaster (), hopsLeft - 1);
+  std::vector<Ipv4Address> const & targets = bordercastHeader.GetTargets ();
+  for (std::vector<Ipv4Address>::const_iterator i = targets.begin (); i != targets.end (); ++i)
+    {
+      // Only the targets on a shortest path through this node
+      RoutingTableEntry rt;
+      if (!m_routingTable.LookupRoute (*i, rt) || rt.GetFlag () != VALID || rt.GetHop () != hopsLeft)
+        {
+          continue;
+        }
+      if (EnableQueryDetection && m_queryDetection.HasRelayed (rreqHeader.GetOrigin (), rreqHeader.GetId (), *i))
+        {
+          continue;
+        }
+      if (!next.AddTarget (*i) || !next.AddRelay (rt.GetNextHop ()))
+        {
+          break;
+        }
+    }
+  if (next.GetTargets ().empty ())
+    {
+      return;
+    }
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (next);
+  rreqHeader.SetBordercast (true);
+  packet->AddHeader (rreqHeader);
+  TypeHeader tHeader (SHINGO_RREQ);
+  packet->AddHeader (tHeader);
+  SendTo (socket, packet, destination);
+}
+
+std::set<Ipv4Address> const &
+RoutingProtocol::GetMprs ()
+{
+  std::set<Ipv4Address> neighbors;
+  std::map<Ipv4Address, Ipv4Address> twoHops;
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+  m_routingTable.GetListOfAllRoutes (allRoutes);
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+    {
+      if (i->second.GetFlag () != VALID)
+        {
+          continue;
+        }
+      if (i->second.GetHop () == 1)
+        {
+          neighbors.insert (i->second.GetDestination ());
+        }
+      else if (i->second.GetHop () == 2)
+        {
+          twoHops[i->second.GetDestination ()] = i->second.GetNextHop ();
+        }
+    }
+  return m_mprSelection.Compute (neighbors, twoHops);
+}
+
+uint8_t
+RoutingProtocol::AdvanceRequest (RreqHeader & rreqHeader, uint16_t metric, Ipv4Address firstHop)
+{
+  uint8_t hop = rreqHeader.GetHopCount () + 1;
+  rreqHeader.SetHopCount (hop);
+  rreqHeader.SetMetric (metric);
+  rreqHeader.SetFirstHop (firstHop);
+  return hop;
+}
+
+void
+RoutingProtocol::RelayRequestToMprs (RreqHeader const & rreqHeader)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  // A busy relay re-broadcasts late, so that lightly loaded paths win the discovery
+  Time loadDelay = GetLoadDelay ();
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination = j->second.GetMask () == Ipv4Mask::GetOnes () ? Ipv4Address ("255.255.255.255") : j->second.GetBroadcast ();
+      m_lastBcastTime = Simulator::Now ();
+      Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))) + loadDelay, &RoutingProtocol::SendRequestToMprs, this,
+                           j->first, rreqHeader, destination);
+    }
+}
+
+void
+RoutingProtocol::SendRequestToMprs (Ptr<Socket> socket, RreqHeader rreqHeader, Ipv4Address destination)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << rreqHeader.GetId ());
+  if (EnableQueryDetection && IsQueryCovered (rreqHeader.GetOrigin (), rreqHeader.GetId ()))
+    {
+      NS_LOG_DEBUG ("Drop RREQ " << rreqHeader.GetId () << " of " << rreqHeader.GetOrigin () << ", the zone is already covered");
+      return;
+    }
+  Ptr<Packet> packet = Create<Packet> ();
+  // Without two-hop knowledge, e.g. with a zone radius of 1, every neighbor re-broadcasts
+  std::set<Ipv4Address> const & mprs = GetMprs ();
+  if (m_zoneRadius >= 2 && !mprs.empty ())
+    {
+      MprSetHeader mprSetHeader;
+      for (std::set<Ipv4Address>::const_iterator i = mprs.begin (); i != mprs.end (); ++i)
+        {
+          if (!mprSetHeader.AddRelay (*i))
+            {
+              break;
+            }
+        }
+      packet->AddHeader (mprSetHeader);
+      rreqHeader.SetMprFlood (true);
+    }
+  packet->AddHeader (rreqHeader);
+  TypeHeader tHeader (SHINGO_RREQ);
+  packet->AddHeader (tHeader);
+  SendTo (socket, packet, destination);
+}
+
+void
+RoutingProtocol::GossipRequest (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination, Ipv4Address origin, uint32_t id)
+{
+  NS_LOG_FUNCTION (this << origin << id);
+  // Every copy heard so far came from a different sender
+  uint32_t copies = m_queryDetection.GetRelayerCount (origin, id);
+  if (copies >= m_gossipCounterThreshold)
+    {
+      NS_LOG_DEBUG ("Drop RREQ " << id << " of " << origin << ", " << copies << " copies heard");
+      return;
+    }
+  if (m_gossipNeighbors > 0)
+    {
+      uint32_t neighbors = m_nb.GetSize ();
+      std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+      m_routingTable.GetListOfAllRoutes (allRoutes);
+      uint32_t zoneNeighbors = 0;
+      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+        {
+          if (i->second.GetFlag () == VALID && i->second.GetHop () == 1)
+            {
+              zoneNeighbors++;
+            }
+        }
+      neighbors = std::max (neighbors, zoneNeighbors);
+      if (neighbors > m_gossipNeighbors
+          && m_uniformRandomVariable->GetValue (0, 1) >= double (m_gossipNeighbors) / neighbors)
+        {
+          NS_LOG_DEBUG ("Drop RREQ " << id << " of " << origin << " with " << neighbors << " neighbors");
+          return;
+        }
+    }
+  RelayRequest (socket, packet, destination, origin, id);
+}
+
+void
+RoutingProtocol::ObserveHopCount (uint32_t hops)
+{
+  GetHopCap ();
+  m_diameterEstimate = std::max (m_diameterEstimate, hops);
+}
+
+void
+RoutingProtocol::SinkBeaconTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  if (IsMyOwnAddress (m_sink))
+    {
+      m_sinkSeqNo++;
+      SendSinkBeacon (0);
+      m_sinkBeaconTimer.Schedule (m_sinkBeaconInterval);
+      return;
+    }
+  std::map<Ipv4Address, uint32_t>::const_iterator best = m_sinkOffers.begin ();
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = m_sinkOffers.begin (); i != m_sinkOffers.end (); ++i)
+    {
+      if (i->second < best->second)
+        {
+          best = i;
+        }
+    }
+  if (best == m_sinkOffers.end ())
+    {
+      return;
+    }
+  // The parent keeps its place unless another neighbor is closer to the sink by more than the hysteresis
+  std::map<Ipv4Address, uint32_t>::const_iterator parent = m_sinkOffers.find (m_sinkParent);
+  if (parent != m_sinkOffers.end () && parent->second <= best->second + m_sinkHysteresis)
+    {
+      best = parent;
+    }
+  SetSinkParent (best->first, best->second);
+  SendSinkBeacon (best->second);
+}
+
+void
+RoutingProtocol::RecvSinkBeacon (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender)
+{
+  SinkBeaconHeader beacon;
+  packet->RemoveHeader (beacon);
+  NS_LOG_FUNCTION (this << beacon);
+  if (beacon.GetSink () != m_sink || m_sink == Ipv4Address () || IsMyOwnAddress (m_sink)
+      || beacon.GetHopCount () >= m_netDiameter)
+    {
+      return;
+    }
+  uint32_t hop = beacon.GetHopCount () + 1;
+  int32_t age = int32_t (beacon.GetSeqNo ()) - int32_t (m_sinkSeqNo);
+  if (age < 0)
+    {
+      NS_LOG_DEBUG ("Drop stale beacon " << beacon.GetSeqNo () << " from " << sender);
+      return;
+    }
+  if (age > 0)
+    {
+      /*
+       * Only the neighbors heard forwarding the latest beacon can be parents: they picked their own parent
+       * for it before, so the tree has no loop.
+       */
+      m_sinkSeqNo = beacon.GetSeqNo ();
+      m_sinkOffers.clear ();
+      m_sinkOffers[sender] = hop;
+      m_sinkReceiver = receiver;
+      m_sinkBeaconTimer.Cancel ();
+      m_sinkBeaconTimer.Schedule (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10)));
+      return;
+    }
+  m_sinkOffers[sender] = hop;
+  // A neighbor as close to the sink as the parent is closer than this node: it shares the load of the tree
+  if (EnableMultipath && !m_sinkBeaconTimer.IsRunning () && sender != m_sinkParent && hop <= m_sinkHop)
+    {
+      AddSinkPath (sender, hop);
+    }
+  // Once the beacon is forwarded, only a neighbor closer than every node below this one can become the parent
+  if (!m_sinkBeaconTimer.IsRunning () && hop + m_sinkHysteresis < m_sinkHop)
+    {
+      SetSinkParent (sender, hop);
+    }
+}
+
+void
+RoutingProtocol::SetSinkParent (Ipv4Address parent, uint32_t hop)
+{
+  NS_LOG_FUNCTION (this << parent << hop);
+  m_sinkParent = parent;
+  m_sinkHop = hop;
+  if (EnableMultipath)
+    {
+      m_multipath.Clear (m_sink);
+      m_multipath.SetPrimary (m_sink, parent, Ipv4Address ());
+      for (std::map<Ipv4Address, uint32_t>::const_iterator i = m_sinkOffers.begin (); i != m_sinkOffers.end (); ++i)
+        {
+          if (i->first != parent && i->second <= hop)
+            {
+              AddSinkPath (i->first, i->second);
+            }
+        }
+    }
+  int32_t interface = m_ipv4->GetInterfaceForAddress (m_sinkReceiver);
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (interface);
+  Ipv4InterfaceAddress iface = m_ipv4->GetAddress (interface, 0);
+  // The route outlives two lost beacons
+  Time lifetime = 3 * m_sinkBeaconInterval;
+  RoutingTableEntry2 toSink;
+  if (m_routingTable2.LookupRoute (m_sink, toSink))
+    {
+      toSink.SetNextHop (parent);
+      toSink.SetOutputDevice (dev);
+      toSink.SetInterface (iface);
+      toSink.SetHop (hop);
+      toSink.SetFlag (VALID);
+      toSink.SetLifeTime (lifetime);
+      m_routingTable2.Update (toSink);
+    }
+  else
+    {
+      RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ m_sink, /*validSeqNo=*/ false, /*seqNo=*/ 0,
+                                              /*iface=*/ iface, /*hops=*/ hop, /*nextHop=*/ parent, /*lifeTime=*/ lifetime);
+      m_routingTable2.AddRoute (newEntry);
+      m_routingTable2.LookupRoute (m_sink, toSink);
+    }
+  SendPacketFromQueue2 (m_sink, toSink.GetRoute ());
+}
+
+void
+RoutingProtocol::AddSinkPath (Ipv4Address neighbor, uint32_t hop)
+{
+  MultipathTable::Path path;
+  path.m_nextHop = neighbor;
+  path.m_hops = hop;
+  path.m_metric = hop * LinkQuality::PERFECT_LINK;
+  // As long as the route to the sink
+  path.m_expire = Simulator::Now () + 3 * m_sinkBeaconInterval;
+  m_multipath.AddPath (m_sink, path);
+}
+
+void
+RoutingProtocol::SendSinkBeacon (uint32_t hop)
+{
+  NS_LOG_FUNCTION (this << m_sinkSeqNo << hop);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      SinkBeaconHeader beacon (m_sink, m_sinkSeqNo, std::min<uint32_t> (hop, 255));
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (beacon);
+      TypeHeader tHeader (SHINGO_SINK_BEACON);
+      packet->AddHeader (tHeader);
+      Ipv4Address destination = j->second.GetMask () == Ipv4Mask::GetOnes () ? Ipv4Address ("255.255.255.255") : j->second.GetBroadcast ();
+      SendTo (j->first, packet, destination);
+    }
+}
+
+uint32_t
+RoutingProtocol::GetHopCap ()
+{
+  Time elapsed = Simulator::Now () - m_diameterWindowStart;
+  if (elapsed >= m_diameterWindow)
+    {
+      m_lastDiameterEstimate = elapsed < 2 * m_diameterWindow ? m_diameterEstimate : 0;
+      m_diameterEstimate = 0;
+      m_diameterWindowStart = Simulator::Now ();
+    }
+  // A RREQ stopped by the cap can not show a longer path: the zone diameter margin lets the estimate grow
+  uint32_t estimate = std::max<uint32_t> (std::max (m_diameterEstimate, m_lastDiameterEstimate), m_ttlThreshold);
+  return std::min<uint32_t> (estimate + 2 * std::max<uint32_t> (m_zoneRadius, 1), m_netDiameter);
+}
+
+bool
+RoutingProtocol::IsAnycastMember (Ipv4Address dst)
+{
+  if (dst != m_anycastGroup || m_anycastGroup == Ipv4Address ())
+    {
+      return false;
+    }
+  for (std::set<Ipv4Address>::const_iterator i = m_anycastMembers.begin (); i != m_anycastMembers.end (); ++i)
+    {
+      if (IsMyOwnAddress (*i))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+RoutingProtocol::IsRequestedDestination (RreqHeader const & rreqHeader)
+{
+  if (IsMyOwnAddress (rreqHeader.GetDst ()) || IsAnycastMember (rreqHeader.GetDst ()))
+    {
+      return true;
+    }
+  for (std::vector<RreqHeader::Destination>::const_iterator d = rreqHeader.GetDestinations ().begin ();
+       d != rreqHeader.GetDestinations ().end (); ++d)
+    {
+      if (IsMyOwnAddress (d->m_dst) || IsAnycastMember (d->m_dst))
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+bool
+RoutingProtocol::LookupZoneRoute (Ipv4Address dst, RoutingTableEntry & rt)
+{
+  if (dst != m_anycastGroup || m_anycastGroup == Ipv4Address ())
+    {
+      // The zone routes through a neighbor that does not hear this node stay, but are not used until it is cleared
+      return m_routingTable.LookupRoute (dst, rt) && !m_blacklist.IsBlacklisted (rt.GetNextHop ());
+    }
+  bool found = false;
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+  m_routingTable.GetListOfAllRoutes (allRoutes);
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+    {
+      if (m_anycastMembers.count (i->first) && i->second.GetFlag () == VALID && i->second.GetHop () > 0
+          && !m_blacklist.IsBlacklisted (i->second.GetNextHop ())
+          && (!found || i->second.GetHop () < rt.GetHop ()))
+        {
+          rt = i->second;
+          found = true;
+        }
+    }
+  return found;
+}
+
+bool
+RoutingProtocol::IsMyOwnAddress (Ipv4Address src)
+{
+//printf("IsMyOwnAddress \n");
+  NS_LOG_FUNCTION (this << src);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
+         m_socketAddresses.begin (); j != m_socketAddresses.end (); ++j)
+    {
+      Ipv4InterfaceAddress iface = j->second;
+      if (src == iface.GetLocal ())
+        {
+          return true;
+        }
+    }
+//printf("false\n");
+  return false;
+}
+
+
+void
+RoutingProtocol::RecvReply (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address sender)
+{
+  //printf("RecvReply\n");
+  NS_LOG_FUNCTION (this << " src " << sender);
+  RrepHeader rrepHeader;
+  p->RemoveHeader (rrepHeader);
+  Ipv4Address dst = rrepHeader.GetDst ();
+  NS_LOG_LOGIC ("RREP destination " << dst << " RREP origin " << rrepHeader.GetOrigin ());
+
+  // If RREP is Hello message
+  if (dst == rrepHeader.GetOrigin ())
+    {
+      if (rrepHeader.GetMobility ())
+        {
+          PositionHeader positionHeader;
+          p->RemoveHeader (positionHeader);
+          m_linkExpiration.Update (dst, positionHeader.GetPosition (), positionHeader.GetVelocity ());
+        }
+      ProcessHello (rrepHeader, receiver);
+      return;
+    }
+
+  uint8_t hop = rrepHeader.GetHopCount () + 1;
+  rrepHeader.SetHopCount (hop);
+  rrepHeader.SetMetric (LinkQuality::Accumulate (rrepHeader.GetMetric (), GetLinkMetric (sender)));
+  rrepHeader.SetExpiration (std::min (rrepHeader.GetExpiration (), GetLinkExpiration (sender)));
+  ObserveHopCount (hop);
+
+  /*
+   * If the route table entry to the destination is created or updated, then the following actions occur:
+   * -  the route is marked as active,
+   * -  the destination sequence number is marked as valid,
+   * -  the next hop in the route entry is assigned to be the node from which the RREP is received,
+   *    which is indicated by the source IP address field in the IP header,
+   * -  the hop count is set to the value of the hop count from RREP message + 1
+   * -  the expiry time is set to the current time plus the value of the Lifetime in the RREP message,
+   * -  and the destination sequence number is the Destination Sequence Number in the RREP message.
+   */
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (receiver));
+  RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ dst, /*validSeqNo=*/ true, /*seqno=*/ rrepHeader.GetDstSeqno (),
+                                          /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),/*hop=*/ hop,
+                                          /*nextHop=*/ sender, /*lifeTime=*/ rrepHeader.GetLifeTime ());
+  newEntry.SetMetric (rrepHeader.GetMetric ());
+  RoutingTableEntry2 toDst;
+  if (m_routingTable2.LookupRoute (dst, toDst))
+    {
+      /*
+       * The existing entry is updated only in the following circumstances:
+       * (i) the sequence number in the routing table is marked as invalid in route table entry.
+       */
+      if (!toDst.GetValidSeqNo ())
+        {
+          m_routingTable2.Update (newEntry);
+          m_multipath.Clear (dst);
+        }
+      // (ii)the Destination Sequence Number in the RREP is greater than the node's copy of the destination sequence number and the known value is valid,
+      else if ((int32_t (rrepHeader.GetDstSeqno ()) - int32_t (toDst.GetSeqNo ())) > 0)
+        {
+          m_routingTable2.Update (newEntry);
+          m_multipath.Clear (dst);
+        }
+      else
+        {
+          // (iii) the sequence numbers are the same, but the route is marked as inactive.
+          if ((rrepHeader.GetDstSeqno () == toDst.GetSeqNo ()) && (toDst.GetFlag () != VALID))
+            {
+              m_routingTable2.Update (newEntry);
+            }
+          // (iv)  the sequence numbers are the same, and the new path is better than the one in route table entry.
+          else if ((rrepHeader.GetDstSeqno () == toDst.GetSeqNo ())
+                   && IsBetterPath (hop, rrepHeader.GetMetric (), toDst.GetHop (), toDst.GetMetric ()))
+            {
+              m_routingTable2.Update (newEntry);
+            }
+          // Another reply to the same discovery, no longer than the route, is a loop free path besides it
+          else if (EnableMultipath && rrepHeader.GetDstSeqno () == toDst.GetSeqNo () && toDst.GetFlag () == VALID
+                   && sender != toDst.GetNextHop () && hop <= toDst.GetHop ())
+            {
+              MultipathTable::Path path;
+              path.m_nextHop = sender;
+              path.m_hops = hop;
+              path.m_metric = rrepHeader.GetMetric ();
+              path.m_expire = Simulator::Now () + std::min (rrepHeader.GetLifeTime (), rrepHeader.GetExpiration ());
+              m_multipath.SetPrimary (dst, toDst.GetNextHop (), Ipv4Address ());
+              m_multipath.AddPath (dst, path);
+            }
+        }
+    }
+  else
+    {
+      // The forward route for this destination is created if it does not already exist.
+      NS_LOG_LOGIC ("add new route");
+      m_routingTable2.AddRoute (newEntry);
+    }
+
+  // A route to a hot destination is kept to answer the RREQs of the next sources
+  if (EnableRouteCache)
+    {
+      m_popularity.Record (dst);
+      if (m_popularity.IsHot (dst))
+        {
+          UpdateRouteLifeTime (dst, m_hotRouteTimeout);
+        }
+    }
+
+  // Acknowledge receipt of the RREP by sending a RREP-ACK message back
+  if (rrepHeader.GetAckRequired ())
+    {
+      SendReplyAck (sender, receiver);
+      rrepHeader.SetAckRequired (false);
+    }
+  if (EnableRequestMerging)
+    {
+      AnswerHeldRequests (rrepHeader);
+    }
+
+  RecordRouteExpiration (dst, sender, rrepHeader.GetExpiration ());
+
+  NS_LOG_LOGIC ("receiver " << receiver << " origin " << rrepHeader.GetOrigin ());
+  if (IsMyOwnAddress (rrepHeader.GetOrigin ()))
+    {
+      if (toDst.GetFlag () == IN_SEARCH || toDst.GetFlag () == DISCOVER)
+        {
+          m_routingTable2.Update (newEntry);
+          m_addressReqTimer[dst].Remove ();
+          m_addressReqTimer.erase (dst);
+          RecordRouteExpiration (dst, sender, rrepHeader.GetExpiration ());
+        }
+      // Look for a new route before the predicted break, while this one carries the data
+      if (m_routeExpiration.find (dst) != m_routeExpiration.end ())
+        {
+          if (m_routeExpirationTimer.find (dst) == m_routeExpirationTimer.end ())
+            {
+              Timer timer (Timer::CANCEL_ON_DESTROY);
+              m_routeExpirationTimer[dst] = timer;
+            }
+          m_routeExpirationTimer[dst].SetFunction (&RoutingProtocol::RouteExpirationTimerExpire, this);
+          m_routeExpirationTimer[dst].Remove ();
+          m_routeExpirationTimer[dst].SetArguments (dst);
+          m_routeExpirationTimer[dst].Schedule (std::max (GetRouteExpiration (dst) - m_linkExpirationGuard, Seconds (0)));
+        }
+      m_routingTable2.LookupRoute (dst, toDst);
+      if (toDst.GetFlag () == VALID)
+        {
+          FinishLocalRepair (dst, true);
+        }
+      SendPacketFromQueue2 (dst, toDst.GetRoute ());
+      return;
+    }
+
+  RoutingTableEntry2 toOrigin;
+  if (!m_routingTable2.LookupRoute (rrepHeader.GetOrigin (), toOrigin) || toOrigin.GetFlag () == IN_SEARCH)
+    {
+      // The gratuitous RREP of a proxy follows the zone route to the destination
+      RoutingTableEntry zoneRoute;
+      if (m_routingTable.LookupRoute (rrepHeader.GetOrigin (), zoneRoute) && zoneRoute.GetFlag () == VALID
+          && zoneRoute.GetHop () > 0)
+        {
+          Ptr<Packet> packet = Create<Packet> ();
+          packet->AddHeader (rrepHeader);
+          TypeHeader tHeader (SHINGO_RREP);
+          packet->AddHeader (tHeader);
+          Ptr<Socket> socket = FindSocketWithInterfaceAddress (zoneRoute.GetInterface ());
+          NS_ASSERT (socket);
+          SendTo (socket, packet, zoneRoute.GetNextHop ());
+        }
+      return; // Impossible! drop.
+    }
+  toOrigin.SetLifeTime (std::max (m_activeRouteTimeout, toOrigin.GetLifeTime ()));
+  m_routingTable2.Update (toOrigin);
+
+  // Update information about precursors
+  if (m_routingTable2.LookupValidRoute (rrepHeader.GetDst (), toDst))
+    {
+      toDst.InsertPrecursor (toOrigin.GetNextHop ());
+      m_routingTable2.Update (toDst);
+
+      RoutingTableEntry2 toNextHopToDst;
+      m_routingTable2.LookupRoute (toDst.GetNextHop (), toNextHopToDst);
+      toNextHopToDst.InsertPrecursor (toOrigin.GetNextHop ());
+      m_routingTable2.Update (toNextHopToDst);
+
+      toOrigin.InsertPrecursor (toDst.GetNextHop ());
+      m_routingTable2.Update (toOrigin);
+
+      RoutingTableEntry2 toNextHopToOrigin;
+      m_routingTable2.LookupRoute (toOrigin.GetNextHop (), toNextHopToOrigin);
+      toNextHopToOrigin.InsertPrecursor (toDst.GetNextHop ());
+      m_routingTable2.Update (toNextHopToOrigin);
+    }
+/*
+  SocketIpTtlTag tag;
+  p->RemovePacketTag (tag);
+  if (tag.GetTtl () < 2)
+    {
+      NS_LOG_DEBUG ("TTL exceeded. Drop RREP destination " << dst << " origin " << rrepHeader.GetOrigin ());
+      return;
+    }
+*/
+
+  RequestReplyAck (rrepHeader, toOrigin.GetNextHop ());
+  Ptr<Packet> packet = Create<Packet> ();
+  //SocketIpTtlTag ttl;
+  //ttl.SetTtl (tag.GetTtl () - 1);
+  //packet->AddPacketTag (ttl);
+  packet->AddHeader (rrepHeader);
+  TypeHeader tHeader (SHINGO_RREP);
+  packet->AddHeader (tHeader);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+  NS_ASSERT (socket);
+  SendTo (socket, packet, toOrigin.GetNextHop ());
+}
+
+void
+RoutingProtocol::AnswerHeldRequests (RrepHeader const & rrepHeader)
+{
+  NS_LOG_FUNCTION (this << rrepHeader.GetDst ());
+  std::vector<RreqHeader> held = m_discoveryMerge.TakeAnswered (rrepHeader.GetDst (), rrepHeader.GetDstSeqno ());
+  for (std::vector<RreqHeader>::const_iterator i = held.begin (); i != held.end (); ++i)
+    {
+      RoutingTableEntry2 toHeld;
+      if (i->GetOrigin () == rrepHeader.GetOrigin () || !m_routingTable2.LookupValidRoute (i->GetOrigin (), toHeld))
+        {
+          continue;
+        }
+      RoutingTableEntry2 toDst;
+      if (m_routingTable2.LookupValidRoute (rrepHeader.GetDst (), toDst))
+        {
+          toDst.InsertPrecursor (toHeld.GetNextHop ());
+          m_routingTable2.Update (toDst);
+          toHeld.InsertPrecursor (toDst.GetNextHop ());
+        }
+      toHeld.SetLifeTime (std::max (m_activeRouteTimeout, toHeld.GetLifeTime ()));
+      m_routingTable2.Update (toHeld);
+
+      NS_LOG_DEBUG ("Copy RREP for " << rrepHeader.GetDst () << " to the held RREQ of " << i->GetOrigin ());
+      RrepHeader copy = rrepHeader;
+      copy.SetOrigin (i->GetOrigin ());
+      RequestReplyAck (copy, toHeld.GetNextHop ());
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (copy);
+      TypeHeader tHeader (SHINGO_RREP);
+      packet->AddHeader (tHeader);
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (toHeld.GetInterface ());
+      NS_ASSERT (socket);
+      SendTo (socket, packet, toHeld.GetNextHop ());
+    }
+}
+
+void
+RoutingProtocol::RecvReplyAck (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (this);
+  // The neighbor got the RREP: the link works both ways
+  std::map<Ipv4Address, Timer>::iterator timer = m_replyAckTimer.find (neighbor);
+  if (timer != m_replyAckTimer.end ())
+    {
+      timer->second.Remove ();
+      m_replyAckTimer.erase (timer);
+    }
+  m_replyAckMissCount.erase (neighbor);
+  m_blacklist.Remove (neighbor);
+  RoutingTableEntry2 rt;
+  if (m_routingTable2.LookupRoute (neighbor, rt))
+    {
+      rt.SetFlag (VALID);
+      m_routingTable2.Update (rt);
+    }
+}
+
+
+void
+RoutingProtocol::SendReplyAck (Ipv4Address neighbor, Ipv4Address receiver)
+{
+  NS_LOG_FUNCTION (this << " to " << neighbor);
+  RrepAckHeader h;
+  TypeHeader typeHeader (SHINGO_RREP_ACK);
+  Ptr<Packet> packet = Create<Packet> ();
+  //SocketIpTtlTag tag;
+  //tag.SetTtl (1);
+  //packet->AddPacketTag (tag);
+  packet->AddHeader (h);
+  packet->AddHeader (typeHeader);
+  // Answer on the interface the RREP came on, whether or not a route to the neighbor is known
+  Ipv4InterfaceAddress iface = m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (iface);
+  NS_ASSERT (socket);
+  SendTo (socket, packet, neighbor);
+}
+
+void
+RoutingProtocol::RequestReplyAck (RrepHeader & rrepHeader, Ipv4Address neighbor)
+{
+  if (!EnableReplyAck)
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << " from " << neighbor);
+  rrepHeader.SetAckRequired (true);
+  // The first RREP_ACK outstanding decides for the link
+  if (m_replyAckTimer.find (neighbor) == m_replyAckTimer.end ())
+    {
+      Timer timer (Timer::CANCEL_ON_DESTROY);
+      m_replyAckTimer[neighbor] = timer;
+    }
+  if (m_replyAckTimer[neighbor].IsRunning ())
+    {
+      return;
+    }
+  m_replyAckTimer[neighbor].SetFunction (&RoutingProtocol::AckTimerExpire, this);
+  m_replyAckTimer[neighbor].SetArguments (neighbor, m_blackListTimeout);
+  m_replyAckTimer[neighbor].Schedule (m_nextHopWait);
+}
+
+void
+RoutingProtocol::RecvError (Ptr<Packet> p, Ipv4Address src)
+{
+  NS_LOG_FUNCTION (this << " from " << src);
+  RerrHeader rerrHeader;
+  p->RemoveHeader (rerrHeader);
+  // Only the routes through the sender of the RERR are broken
+  std::map<Ipv4Address, uint32_t> dstWithNextHopSrc;
+  std::map<Ipv4Address, uint32_t> unreachable;
+  m_routingTable2.GetListOfDestinationWithNextHop (src, dstWithNextHopSrc);
+  std::pair<Ipv4Address, uint32_t> un;
+  while (rerrHeader.RemoveUnDestination (un))
+    {
+      if (dstWithNextHopSrc.find (un.first) != dstWithNextHopSrc.end ())
+        {
+          unreachable.insert (un);
+        }
+    }
+
+  std::vector<Ipv4Address> precursors;
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin ();
+       i != unreachable.end (); )
+    {
+      if (!rerrHeader.AddUnDestination (i->first, i->second))
+        {
+          TypeHeader typeHeader (SHINGO_RERR);
+          Ptr<Packet> packet = Create<Packet> ();
+          packet->AddHeader (rerrHeader);
+          packet->AddHeader (typeHeader);
+          SendRerrMessage (packet, precursors);
+          rerrHeader.Clear ();
+        }
+      else
+        {
+          RoutingTableEntry2 toDst;
+          m_routingTable2.LookupRoute (i->first, toDst);
+          toDst.GetPrecursors (precursors);
+          ++i;
+        }
+    }
+  if (rerrHeader.GetDestCount () != 0)
+    {
+      TypeHeader typeHeader (SHINGO_RERR);
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (rerrHeader);
+      packet->AddHeader (typeHeader);
+      SendRerrMessage (packet, precursors);
+    }
+  m_routingTable2.InvalidateRoutesWithDst (unreachable);
+}
+
+void
+RoutingProtocol::SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop)
+{
+  NS_LOG_FUNCTION (this << nextHop);
+  if (!EnableRouteErrors && !EnableLocalRepair)
+    {
+      return;
+    }
+  RerrHeader rerrHeader;
+  std::vector<Ipv4Address> precursors;
+  std::map<Ipv4Address, uint32_t> unreachable;
+
+  m_routingTable2.GetListOfDestinationWithNextHop (nextHop, unreachable);
+  RoutingTableEntry2 toNextHop;
+  if (m_routingTable2.LookupRoute (nextHop, toNextHop) && toNextHop.GetFlag () == VALID)
+    {
+      unreachable.insert (std::make_pair (nextHop, toNextHop.GetSeqNo ()));
+    }
+  if (unreachable.empty ())
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("Link to " << nextHop << " broke, " << unreachable.size () << " destinations unreachable");
+  // The destinations still in the zone through another neighbor, or repaired locally, are not reported
+  std::map<Ipv4Address, uint32_t> reported;
+  std::vector<RoutingTableEntry2> repairs;
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = unreachable.begin (); i != unreachable.end (); ++i)
+    {
+      RoutingTableEntry zoneRoute;
+      if (LookupZoneRoute (i->first, zoneRoute) && zoneRoute.GetFlag () == VALID
+          && zoneRoute.GetNextHop () != nextHop)
+        {
+          continue;
+        }
+      RoutingTableEntry2 toDst;
+      m_routingTable2.LookupRoute (i->first, toDst);
+      if (EnableLocalRepair && !toDst.IsPrecursorListEmpty () && GetRepairTtl (toDst) > 0)
+        {
+          repairs.push_back (toDst);
+          continue;
+        }
+      reported.insert (*i);
+    }
+  // One RERR carries every destination the broken link made unreachable
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = reported.begin (); i
+       != reported.end (); )
+    {
+      if (!rerrHeader.AddUnDestination (i->first, i->second))
+        {
+          NS_LOG_LOGIC ("Send RERR message with maximum size.");
+          TypeHeader typeHeader (SHINGO_RERR);
+          Ptr<Packet> packet = Create<Packet> ();
+          packet->AddHeader (rerrHeader);
+          packet->AddHeader (typeHeader);
+          SendRerrMessage (packet, precursors);
+          rerrHeader.Clear ();
+        }
+      else
+        {
+          RoutingTableEntry2 toDst;
+          m_routingTable2.LookupRoute (i->first, toDst);
+          toDst.GetPrecursors (precursors);
+          ++i;
+        }
+    }
+  if (rerrHeader.GetDestCount () != 0)
+    {
+      TypeHeader typeHeader (SHINGO_RERR);
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (rerrHeader);
+      packet->AddHeader (typeHeader);
+      SendRerrMessage (packet, precursors);
+    }
+  m_routingTable2.InvalidateRoutesWithDst (unreachable);
+  for (std::vector<RoutingTableEntry2>::const_iterator i = repairs.begin (); i != repairs.end (); ++i)
+    {
+      StartLocalRepair (*i);
+    }
+}
+
+bool
+RoutingProtocol::SalvagePacket (Ptr<const Packet> p, const Ipv4Header & header,
+                                UnicastForwardCallback ucb, ErrorCallback ecb, RoutingTableEntry2 const & toDst)
+{
+  NS_LOG_FUNCTION (this << p->GetUid ());
+  if (!EnableLocalRepair)
+    {
+      return false;
+    }
+  bool repairing = m_localRepairStart.find (toDst.GetDestination ()) != m_localRepairStart.end ();
+  if (!repairing && toDst.GetFlag () != IN_SEARCH && GetRepairTtl (toDst) == 0)
+    {
+      return false;
+    }
+  QueueEntry newEntry (p, header, ucb, ecb);
+  if (!m_queue2.Enqueue (newEntry))
+    {
+      return false;
+    }
+  if (!repairing && toDst.GetFlag () != IN_SEARCH)
+    {
+      StartLocalRepair (toDst);
+    }
+  return true;
+}
+
+uint16_t
+RoutingProtocol::GetRepairTtl (RoutingTableEntry2 const & toDst) const
+{
+  if (!toDst.GetValidSeqNo ())
+    {
+      return 0;
+    }
+  // A node with the destination in its zone answers, so the ring stops a zone radius short of it
+  uint16_t hops = toDst.GetHop () > m_zoneRadius ? toDst.GetHop () - m_zoneRadius : 1;
+  if (hops > m_maxRepairTtl)
+    {
+      return 0;
+    }
+  return hops + m_localAddTtl;
+}
+
+bool
+RoutingProtocol::StartLocalRepair (RoutingTableEntry2 const & toDst)
+{
+  Ipv4Address dst = toDst.GetDestination ();
+  NS_LOG_FUNCTION (this << dst);
+  if (m_localRepairStart.find (dst) != m_localRepairStart.end ())
+    {
+      return true;
+    }
+  if (GetRepairTtl (toDst) == 0)
+    {
+      return false;
+    }
+  NS_LOG_DEBUG ("Repair route to " << dst << " locally, " << toDst.GetHop () << " hops");
+  m_localRepairStart[dst] = Simulator::Now ();
+  std::vector<Ipv4Address> & precursors = m_localRepairPrecursors[dst];
+  precursors.clear ();
+  toDst.GetPrecursors (precursors);
+  SendRequest (dst);
+  return true;
+}
+
+void
+RoutingProtocol::FinishLocalRepair (Ipv4Address dst, bool repaired)
+{
+  NS_LOG_FUNCTION (this << dst << repaired);
+  std::map<Ipv4Address, Time>::iterator start = m_localRepairStart.find (dst);
+  if (start == m_localRepairStart.end ())
+    {
+      return;
+    }
+  m_localRepairTrace (dst, Simulator::Now () - start->second, repaired);
+  m_localRepairStart.erase (start);
+  std::vector<Ipv4Address> precursors = m_localRepairPrecursors[dst];
+  m_localRepairPrecursors.erase (dst);
+  RoutingTableEntry2 toDst;
+  if (repaired)
+    {
+      // The upstream nodes go on using the route through this node
+      if (m_routingTable2.LookupRoute (dst, toDst))
+        {
+          for (std::vector<Ipv4Address>::const_iterator i = precursors.begin (); i != precursors.end (); ++i)
+            {
+              toDst.InsertPrecursor (*i);
+            }
+          m_routingTable2.Update (toDst);
+        }
+      return;
+    }
+  NS_LOG_DEBUG ("Local repair of the route to " << dst << " failed. Drop all packets with dst " << dst);
+  m_queue2.DropPacketWithDst (dst);
+  uint32_t seqNo = 0;
+  if (m_routingTable2.LookupRoute (dst, toDst))
+    {
+      seqNo = toDst.GetSeqNo ();
+      m_routingTable2.DeleteRoute (dst);
+    }
+  RerrHeader rerrHeader;
+  rerrHeader.AddUnDestination (dst, seqNo);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (rerrHeader);
+  packet->AddHeader (TypeHeader (SHINGO_RERR));
+  SendRerrMessage (packet, precursors);
+}
+
+void
+RoutingProtocol::SendRerrWhenNoRouteToForward (Ipv4Address dst,
+                                               uint32_t dstSeqNo, Ipv4Address origin)
+{
+  NS_LOG_FUNCTION (this);
+  if (!EnableRouteErrors)
+    {
+      return;
+    }
+  // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+  if (m_rerrCount == m_rerrRateLimit)
+    {
+      // Just make sure that the RerrRateLimit timer is running and will expire
+      NS_ASSERT (m_rreqRateLimitTimer.IsRunning ());
+      // discard the packet and return
+      NS_LOG_LOGIC ("RerrRateLimit reached at " << Simulator::Now ().GetSeconds () << " with timer delay left "
+                                                << m_rreqRateLimitTimer.GetDelayLeft ().GetSeconds ()
+                                                << "; suppressing RERR");
+      return;
+    }
+  RerrHeader rerrHeader;
+  rerrHeader.AddUnDestination (dst, dstSeqNo);
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (rerrHeader);
+  packet->AddHeader (TypeHeader (SHINGO_RERR));
+  RoutingTableEntry2 toOrigin;
+  if (m_routingTable2.LookupValidRoute (origin, toOrigin))
+    {
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Unicast RERR to the source of the data transmission");
+      SendTo (socket, packet, toOrigin.GetNextHop ());
+      m_rerrCount++;
+    }
+  else
+    {
+      for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator i =
+             m_socketAddresses.begin (); i != m_socketAddresses.end (); ++i)
+        {
+          Ptr<Socket> socket = i->first;
+          Ipv4InterfaceAddress iface = i->second;
+          NS_ASSERT (socket);
+          NS_LOG_LOGIC ("Broadcast RERR message from interface " << iface.GetLocal ());
+          // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+          Ipv4Address destination;
+          if (iface.GetMask () == Ipv4Mask::GetOnes ())
+            {
+              destination = Ipv4Address ("255.255.255.255");
+            }
+          else
+            {
+              destination = iface.GetBroadcast ();
+            }
+          m_lastBcastTime = Simulator::Now ();
+          SendTo (socket, packet->Copy (), destination);
+        }
+      m_rerrCount++;
+    }
+}
+
+void
+RoutingProtocol::SendRerrMessage (Ptr<Packet> packet, std::vector<Ipv4Address> precursors)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (!EnableRouteErrors || precursors.empty ())
+    {
+      NS_LOG_LOGIC ("No precursors");
+      return;
+    }
+  // A node SHOULD NOT originate more than RERR_RATELIMIT RERR messages per second.
+  if (m_rerrCount == m_rerrRateLimit)
+    {
+      // Just make sure that the RerrRateLimit timer is running and will expire
+      NS_ASSERT (m_rreqRateLimitTimer.IsRunning ());
+      // discard the packet and return
+      NS_LOG_LOGIC ("RerrRateLimit reached at " << Simulator::Now ().GetSeconds () << " with timer delay left "
+                                                << m_rreqRateLimitTimer.GetDelayLeft ().GetSeconds ()
+                                                << "; suppressing RERR");
+      return;
+    }
+  // If there is only one precursor, RERR SHOULD be unicast toward that precursor
+  if (precursors.size () == 1)
+    {
+      RoutingTableEntry2 toPrecursor;
+      if (m_routingTable2.LookupValidRoute (precursors.front (), toPrecursor))
+        {
+          Ptr<Socket> socket = FindSocketWithInterfaceAddress (toPrecursor.GetInterface ());
+          NS_ASSERT (socket);
+          NS_LOG_LOGIC ("one precursor => unicast RERR to " << toPrecursor.GetDestination () << " from " << toPrecursor.GetInterface ().GetLocal ());
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendTo, this, socket, packet, precursors.front ());
+          m_rerrCount++;
+        }
+      return;
+    }
+
+  //  Should only transmit RERR on those interfaces which have precursor nodes for the broken route
+  std::vector<Ipv4InterfaceAddress> ifaces;
+  RoutingTableEntry2 toPrecursor;
+  for (std::vector<Ipv4Address>::const_iterator i = precursors.begin (); i != precursors.end (); ++i)
+    {
+      if (m_routingTable2.LookupValidRoute (*i, toPrecursor)
+          && std::find (ifaces.begin (), ifaces.end (), toPrecursor.GetInterface ()) == ifaces.end ())
+        {
+          ifaces.push_back (toPrecursor.GetInterface ());
+        }
+    }
+
+  for (std::vector<Ipv4InterfaceAddress>::const_iterator i = ifaces.begin (); i != ifaces.end (); ++i)
+    {
+      Ptr<Socket> socket = FindSocketWithInterfaceAddress (*i);
+      NS_ASSERT (socket);
+      NS_LOG_LOGIC ("Broadcast RERR message from interface " << i->GetLocal ());
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (i->GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = i->GetBroadcast ();
+        }
+      m_lastBcastTime = Simulator::Now ();
+      Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendTo, this, socket, packet->Copy (), destination);
+    }
+  m_rerrCount++;
+}
+
+void
+RoutingProtocol::HandleLinkFailure (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (this << neighbor);
+  m_helloSchedule.RecordChange ();
+  m_helloLifetimes.erase (neighbor);
+  m_linkQuality.Remove (neighbor);
+  m_linkExpiration.Remove (neighbor);
+  m_neighborLoad.erase (neighbor);
+  if (EnableMultipath)
+    {
+      // The routes with another path keep going and leave the RERR
+      FailOverPaths (neighbor);
+    }
+  if (EnableHello)
+    {
+      // Withdraw the zone routes first, so that the RERR leaves out the destinations still in the zone
+      BreakZoneLink (neighbor);
+    }
+  SendRerrWhenBreaksLinkToNextHop (neighbor);
+}
+
+void
+RoutingProtocol::BreakZoneLink (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (m_mainAddress << " lost the neighbor " << neighbor);
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE)
+    {
+      if (m_zoneNeighbors.erase (neighbor) > 0 && UpdateOwnNeighborSet ())
+        {
+          UpdateZoneRoutes ();
+        }
+      return;
+    }
+  m_zoneMultipath.RemoveNextHop (neighbor);
+  RoutingTableEntry toNeighbor;
+  if (!m_routingTable.LookupRoute (neighbor, toNeighbor) || toNeighbor.GetHop () != 1)
+    {
+      return;
+    }
+  std::map<Ipv4Address, RoutingTableEntry> dstsWithNextHop;
+  m_routingTable.GetListOfDestinationWithNextHop (neighbor, dstsWithNextHop);
+  for (std::map<Ipv4Address, RoutingTableEntry>::iterator i = dstsWithNextHop.begin (); i
+       != dstsWithNextHop.end (); )
+    {
+      // A zone route with another as short path goes on through it, unadvertised
+      MultipathTable::Path path;
+      if (EnableMultipath && i->second.GetHop () > 1 && m_zoneMultipath.TakeBestPath (i->first, path))
+        {
+          NS_LOG_DEBUG ("Zone route to " << i->first << " fails over to " << path.m_nextHop);
+          i->second.SetNextHop (path.m_nextHop);
+          i->second.SetMetric (path.m_metric);
+          i->second.SetLifeTime (Simulator::Now ());
+          i->second.SetHoldTime (path.m_expire - Simulator::Now ());
+          m_routingTable.Update (i->second);
+          dstsWithNextHop.erase (i++);
+          continue;
+        }
+      i->second.SetSeqNo (i->second.GetSeqNo () + 1);
+      i->second.SetEntriesChanged (true);
+      if (!m_advRoutingTable.Update (i->second))
+        {
+          m_advRoutingTable.AddRoute (i->second);
+        }
+      m_routingTable.DeleteRoute (i->first);
+      ++i;
+    }
+  m_zoneChanges += dstsWithNextHop.size ();
+  m_flapDamping.RecordFlap (neighbor);
+  ScheduleTriggeredUpdate (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+}
+
+void
+RoutingProtocol::HelloTimerExpire ()
+{
+  NS_LOG_FUNCTION (this);
+  NS_LOG_LOGIC (m_mainAddress << " saw " << m_helloSchedule.GetChanges () << " neighbor changes in "
+                              << m_helloSchedule.GetInterval ().GetSeconds () << "s");
+  bool grew = m_helloSchedule.Adapt ();
+  // The neighbors would extrapolate a motion this node no longer follows
+  Ptr<MobilityModel> mobility = m_ipv4->GetObject<MobilityModel> ();
+  bool turned = EnableLinkExpiration && mobility != 0
+    && CalculateDistance (mobility->GetVelocity (), m_advertisedVelocity) > 0;
+  // The neighbors still hold the lifetime of the last hello, so a longer interval is announced at once
+  Time delay = m_helloSchedule.GetSuppressDelay (m_lastBcastTime, Simulator::Now (), grew || turned);
+  if (delay.IsStrictlyPositive ())
+    {
+      NS_LOG_LOGIC ("Control broadcast sent " << (Simulator::Now () - m_lastBcastTime).GetSeconds () << "s ago, hello skipped");
+      m_helloTimer.Schedule (delay);
+      return;
+    }
+  SendHello ();
+  m_helloTimer.Schedule (m_helloSchedule.GetInterval () + MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+}
+
+void
+RoutingProtocol::SendHello ()
+{
+  NS_LOG_FUNCTION (this);
+  /* Broadcast a RREP with TTL = 1 with the RREP message fields set as follows:
+   *   Destination IP Address         The node's IP address.
+   *   Destination Sequence Number    The node's latest zone sequence number.
+   *   Hop Count                      0
+   *   Lifetime                       AllowedHelloLoss * HelloInterval
+   */
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
+       != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      RoutingTableEntry ownEntry;
+      m_routingTable.LookupRoute (iface.GetBroadcast (),ownEntry);
+      RrepHeader helloHeader (/*prefix size=*/ 0, /*hops=*/ 0, /*dst=*/ iface.GetLocal (), /*dst seqno=*/ ownEntry.GetSeqNo (),
+                                               /*origin=*/ iface.GetLocal (),/*lifetime=*/ m_helloSchedule.GetLifetime ());
+      Ptr<Packet> packet = Create<Packet> ();
+      Ptr<MobilityModel> mobility = m_ipv4->GetObject<MobilityModel> ();
+      if (EnableLinkExpiration && mobility != 0)
+        {
+          helloHeader.SetMobility (true);
+          PositionHeader positionHeader (mobility->GetPosition (), mobility->GetVelocity ());
+          packet->AddHeader (positionHeader);
+          m_advertisedVelocity = mobility->GetVelocity ();
+        }
+      packet->AddHeader (helloHeader);
+      TypeHeader tHeader (SHINGO_RREP);
+      packet->AddHeader (tHeader);
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      SendTo (socket, packet, destination);
+    }
+}
+
+void
+RoutingProtocol::ProcessHello (RrepHeader const & rrepHeader, Ipv4Address receiver)
+{
+  Ipv4Address neighbor = rrepHeader.GetDst ();
+  NS_LOG_FUNCTION (m_mainAddress << " received a hello from " << neighbor);
+  m_helloLifetimes[neighbor] = rrepHeader.GetLifeTime ();
+  m_nb.Update (neighbor, rrepHeader.GetLifeTime ());
+  if (EnableLinkQuality)
+    {
+      m_linkQuality.Receive (neighbor, GetProbeInterval (neighbor));
+    }
+  if (m_blacklist.IsBlacklisted (neighbor))
+    {
+      return;
+    }
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE)
+    {
+      bool known = m_zoneNeighbors.find (neighbor) != m_zoneNeighbors.end ();
+      m_zoneNeighbors[neighbor] = std::max (m_zoneNeighbors[neighbor], Simulator::Now () + rrepHeader.GetLifeTime ());
+      if (!known && UpdateOwnNeighborSet ())
+        {
+          UpdateZoneRoutes ();
+        }
+      return;
+    }
+  if (m_zoneRadius == 0 || rrepHeader.GetDstSeqno () % 2 == 1)
+    {
+      return;
+    }
+  RoutingTableEntry toNeighbor;
+  bool known = m_routingTable.LookupRoute (neighbor, toNeighbor);
+  if (known && toNeighbor.GetHop () == 1)
+    {
+      // The hellos keep the one-hop entry between the periodic updates of the neighbor
+      toNeighbor.SetLifeTime (Simulator::Now ());
+      toNeighbor.SetMetric (GetLinkMetric (neighbor));
+      m_routingTable.Update (toNeighbor);
+      return;
+    }
+  if (known && toNeighbor.GetSeqNo () > rrepHeader.GetDstSeqno ())
+    {
+      return;
+    }
+  // A neighbor coming into range joins the zone before its next periodic update
+  NS_LOG_DEBUG ("Hello from new neighbor " << neighbor << ", adding its one-hop zone entry");
+  RoutingTableEntry newEntry (
+    /*device=*/ m_ipv4->GetNetDevice (m_ipv4->GetInterfaceForAddress (receiver)), /*dst=*/
+    neighbor, /*seqno=*/
+    rrepHeader.GetDstSeqno (),
+    /*iface=*/ m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0),
+    /*hops=*/ 1, /*next hop=*/
+    neighbor, /*lifetime=*/
+    Simulator::Now (), /*settlingTime*/
+    m_settlingTime, /*entries changed*/
+    true);
+  newEntry.SetFlag (VALID);
+  newEntry.SetHoldTime (std::min (GetIarpHoldTime (), GetLinkExpiration (neighbor)));
+  newEntry.SetMetric (GetLinkMetric (neighbor));
+  if (known)
+    {
+      m_routingTable.Update (newEntry);
+    }
+  else
+    {
+      m_routingTable.AddRoute (newEntry);
+    }
+  if (!m_advRoutingTable.Update (newEntry))
+    {
+      m_advRoutingTable.AddRoute (newEntry);
+    }
+  m_zoneChanges++;
+  ScheduleTriggeredUpdate (MicroSeconds (m_uniformRandomVariable->GetInteger (0,1000)));
+}
+
+Time
+RoutingProtocol::GetNeighborLifetime (Ipv4Address neighbor) const
+{
+  if (!EnableHello)
+    {
+      return GetIarpHoldTime ();
+    }
+  // The control messages of a neighbor stand in for the hellos it skipped
+  std::map<Ipv4Address, Time>::const_iterator i = m_helloLifetimes.find (neighbor);
+  if (i != m_helloLifetimes.end ())
+    {
+      return i->second;
+    }
+  return m_helloSchedule.GetLifetime ();
+}
+
+Time
+RoutingProtocol::GetProbeInterval (Ipv4Address neighbor) const
+{
+  if (!EnableHello)
+    {
+      return m_periodicUpdateInterval;
+    }
+  // A neighbor skips a hello only for another broadcast, so it is heard once per hello interval
+  std::map<Ipv4Address, Time>::const_iterator i = m_helloLifetimes.find (neighbor);
+  if (i != m_helloLifetimes.end ())
+    {
+      return Time (i->second / m_allowedHelloLoss);
+    }
+  return m_helloSchedule.GetInterval ();
+}
+
+uint16_t
+RoutingProtocol::GetLinkMetric (Ipv4Address neighbor)
+{
+  uint16_t cost = EnableLinkQuality ? m_linkQuality.GetLinkCost (neighbor) : uint16_t (LinkQuality::PERFECT_LINK);
+  std::map<Ipv4Address, uint8_t>::const_iterator i = m_neighborLoad.find (neighbor);
+  if (EnableLoadBalancing && i != m_neighborLoad.end ())
+    {
+      // A busy neighbor costs more than an idle one, so that the paths as short through idle nodes take the flows
+      cost = LinkQuality::Accumulate (cost, uint16_t (m_loadWeight * LinkQuality::PERFECT_LINK * i->second / 255));
+    }
+  return cost;
+}
+
+uint8_t
+RoutingProtocol::GetLocalLoad ()
+{
+  double load = 0;
+  for (std::map<uint32_t, Ptr<WifiMacQueue> >::const_iterator i = m_macQueues.begin (); i != m_macQueues.end (); ++i)
+    {
+      // The limit of the queue is in packets or in bytes
+      QueueSize maxSize = i->second->GetMaxSize ();
+      if (maxSize.GetValue () == 0)
+        {
+          continue;
+        }
+      uint32_t size = maxSize.GetUnit () == QueueSizeUnit::PACKETS ? i->second->GetNPackets () : i->second->GetNBytes ();
+      load = std::max (load, double (size) / maxSize.GetValue ());
+    }
+  if (m_queue.GetMaxQueueLen () > 0)
+    {
+      load = std::max (load, double (m_queue.GetSize ()) / m_queue.GetMaxQueueLen ());
+    }
+  if (m_queue2.GetMaxQueueLen () > 0)
+    {
+      load = std::max (load, double (m_queue2.GetSize ()) / m_queue2.GetMaxQueueLen ());
+    }
+  return uint8_t (std::min (load, 1.0) * 255);
+}
+
+Time
+RoutingProtocol::GetLoadDelay ()
+{
+  if (!EnableLoadBalancing)
+    {
+      return Seconds (0);
+    }
+  // The copies of a RREQ over idle nodes reach the destination first and win the route
+  return MicroSeconds (m_maxLoadDelay.GetMicroSeconds () * GetLocalLoad () / 255);
+}
+
+bool
+RoutingProtocol::IsBetterPath (uint16_t hops, uint16_t metric, uint16_t curHops, uint16_t curMetric) const
+{
+  if (!EnableLinkQuality && !EnableLoadBalancing)
+    {
+      return hops < curHops;
+    }
+  // Paths of about the same cost do not take turns with every measurement
+  return metric < curMetric * (1 - m_metricHysteresis);
+}
+
+Time
+RoutingProtocol::GetLinkExpiration (Ipv4Address neighbor) const
+{
+  Ptr<MobilityModel> mobility = m_ipv4->GetObject<MobilityModel> ();
+  if (!EnableLinkExpiration || mobility == 0)
+    {
+      return Time::Max ();
+    }
+  Time expiration = m_linkExpiration.GetExpirationTime (neighbor, mobility->GetPosition (), mobility->GetVelocity ());
+  // A neighbor still heard beyond the range predicts nothing: the range does not fit the channel
+  return expiration.IsStrictlyPositive () ? expiration : Time::Max ();
+}
+
+Time
+RoutingProtocol::GetRouteExpiration (Ipv4Address dst) const
+{
+  std::map<Ipv4Address, Time>::const_iterator i = m_routeExpiration.find (dst);
+  if (i == m_routeExpiration.end ())
+    {
+      return Time::Max ();
+    }
+  return std::max (i->second - Simulator::Now (), Seconds (0));
+}
+
+void
+RoutingProtocol::RecordRouteExpiration (Ipv4Address dst, Ipv4Address nextHop, Time expiration)
+{
+  RoutingTableEntry2 toDst;
+  if (!m_routingTable2.LookupValidRoute (dst, toDst) || toDst.GetNextHop () != nextHop)
+    {
+      return;
+    }
+  if (expiration == Time::Max ())
+    {
+      m_routeExpiration.erase (dst);
+      return;
+    }
+  NS_LOG_DEBUG ("Route to " << dst << " via " << nextHop << " predicted to break in " << expiration.GetSeconds () << "s");
+  m_routeExpiration[dst] = Simulator::Now () + expiration;
+  if (toDst.GetLifeTime () > expiration)
+    {
+      toDst.SetLifeTime (expiration);
+      m_routingTable2.Update (toDst);
+    }
+}
+
+void
+RoutingProtocol::RouteExpirationTimerExpire (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  // An idle route expires before its break anyway
+  RoutingTableEntry2 toDst;
+  if (m_routingTable2.LookupValidRoute (dst, toDst))
+    {
+      NS_LOG_DEBUG ("Route to " << dst << " about to break, looking for a new one");
+      RefreshRoute (dst);
+    }
+}
+
+void
+RoutingProtocol::RefreshRoute (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  m_routeRefresh.insert (dst);
+  SendRequest (dst);
+}
+
+void
+RoutingProtocol::ScheduleRouteRefresh (Ipv4Address dst)
+{
+  if (m_routeRefreshTimer.find (dst) == m_routeRefreshTimer.end ())
+    {
+      Timer timer (Timer::CANCEL_ON_DESTROY);
+      m_routeRefreshTimer[dst] = timer;
+    }
+  RoutingTableEntry2 toDst;
+  if (m_routeRefreshTimer[dst].IsRunning () || !m_routingTable2.LookupValidRoute (dst, toDst))
+    {
+      return;
+    }
+  m_routeRefreshTimer[dst].SetFunction (&RoutingProtocol::RouteRefreshTimerExpire, this);
+  m_routeRefreshTimer[dst].SetArguments (dst);
+  m_routeRefreshTimer[dst].Schedule (std::max (toDst.GetLifeTime () - m_routeRefreshLead, Seconds (0)));
+}
+
+void
+RoutingProtocol::RouteRefreshTimerExpire (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  RoutingTableEntry2 toDst;
+  if (!m_routingTable2.LookupValidRoute (dst, toDst))
+    {
+      // A broken route is left to the RERR, an expired one to the next packet
+      return;
+    }
+  if (toDst.GetLifeTime () > m_routeRefreshLead)
+    {
+      // The flow kept the route alive meanwhile
+      ScheduleRouteRefresh (dst);
+      return;
+    }
+  // A flow that stopped, or sent nothing since the last refresh, lets its route expire
+  Time lastUse = m_lastRouteUse[dst];
+  std::map<Ipv4Address, Time>::const_iterator refreshed = m_lastRouteRefresh.find (dst);
+  if (Simulator::Now () - lastUse > m_activeFlowTimeout
+      || (refreshed != m_lastRouteRefresh.end () && refreshed->second >= lastUse))
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("Route to " << dst << " expires in " << toDst.GetLifeTime ().GetSeconds () << "s, refreshing it");
+  m_lastRouteRefresh[dst] = Simulator::Now ();
+  // The current route carries the data while the RREQ travels, though not beyond its predicted break
+  Time bridge = std::min (m_netTraversalTime, GetRouteExpiration (dst));
+  if (toDst.GetLifeTime () < bridge)
+    {
+      toDst.SetLifeTime (bridge);
+      m_routingTable2.Update (toDst);
+    }
+  RefreshRoute (dst);
+  ScheduleRouteRefresh (dst);
+}
+
+uint32_t
+RoutingProtocol::GetFlowHash (Ptr<const Packet> p, Ipv4Header const & header) const
+{
+  uint16_t srcPort = 0;
+  uint16_t dstPort = 0;
+  if (header.GetProtocol () == UdpL4Protocol::PROT_NUMBER)
+    {
+      UdpHeader udpHeader;
+      p->PeekHeader (udpHeader);
+      srcPort = udpHeader.GetSourcePort ();
+      dstPort = udpHeader.GetDestinationPort ();
+    }
+  else if (header.GetProtocol () == TcpL4Protocol::PROT_NUMBER)
+    {
+      TcpHeader tcpHeader;
+      p->PeekHeader (tcpHeader);
+      srcPort = tcpHeader.GetSourcePort ();
+      dstPort = tcpHeader.GetDestinationPort ();
+    }
+  return MultipathTable::GetFlowHash (header.GetSource (), header.GetDestination (), header.GetProtocol (), srcPort, dstPort);
+}
+
+Ptr<Ipv4Route>
+RoutingProtocol::SelectPath (Ptr<Ipv4Route> route, Ipv4Address dst, uint32_t flow, bool zone)
+{
+  if (!EnableMultipath)
+    {
+      return route;
+    }
+  Ipv4Address nextHop = (zone ? m_zoneMultipath : m_multipath).Select (dst, route->GetGateway (), flow);
+  if (nextHop == route->GetGateway () || m_blacklist.IsBlacklisted (nextHop))
+    {
+      return route;
+    }
+  NS_LOG_LOGIC ("Flow " << flow << " to " << dst << " goes via " << nextHop << " instead of " << route->GetGateway ());
+  Ptr<Ipv4Route> path = Create<Ipv4Route> ();
+  path->SetDestination (route->GetDestination ());
+  path->SetSource (route->GetSource ());
+  path->SetGateway (nextHop);
+  path->SetOutputDevice (route->GetOutputDevice ());
+  return path;
+}
+
+void
+RoutingProtocol::AddReversePath (RreqHeader const & rreqHeader, Ipv4Address src, Ipv4Address firstHop, uint16_t metric)
+{
+  NS_LOG_FUNCTION (this << rreqHeader.GetOrigin () << src << firstHop);
+  Ipv4Address origin = rreqHeader.GetOrigin ();
+  uint16_t hop = rreqHeader.GetHopCount () + 1;
+  RoutingTableEntry2 toOrigin;
+  // A copy of the discovery the reverse route comes from is loop free if it is no longer than the route
+  if (!m_routingTable2.LookupValidRoute (origin, toOrigin) || toOrigin.GetSeqNo () != rreqHeader.GetOriginSeqno ()
+      || hop > toOrigin.GetHop ())
+    {
+      return;
+    }
+  MultipathTable::Path path;
+  path.m_nextHop = src;
+  path.m_lastHop = firstHop;
+  path.m_hops = hop;
+  path.m_metric = metric;
+  path.m_expire = Simulator::Now () + Time (2 * m_netTraversalTime - 2 * hop * m_nodeTraversalTime);
+  if (!m_multipath.AddPath (origin, path))
+    {
+      return;
+    }
+  NS_LOG_DEBUG ("Path to " << origin << " via " << src << " and " << firstHop << " kept");
+  // The destination answers over the new path too, so that the origin gets it as well
+  if (IsMyOwnAddress (rreqHeader.GetDst ()))
+    {
+      toOrigin.SetNextHop (src);
+      toOrigin.SetHop (hop);
+      SendReply (rreqHeader, toOrigin);
+    }
+}
+
+void
+RoutingProtocol::FailOverPaths (Ipv4Address neighbor)
+{
+  NS_LOG_FUNCTION (this << neighbor);
+  m_multipath.RemoveNextHop (neighbor);
+  std::map<Ipv4Address, uint32_t> broken;
+  m_routingTable2.GetListOfDestinationWithNextHop (neighbor, broken);
+  for (std::map<Ipv4Address, uint32_t>::const_iterator i = broken.begin (); i != broken.end (); ++i)
+    {
+      RoutingTableEntry2 toDst;
+      MultipathTable::Path path;
+      if (!m_routingTable2.LookupValidRoute (i->first, toDst) || !m_multipath.TakeBestPath (i->first, path))
+        {
+          continue;
+        }
+      NS_LOG_DEBUG ("Route to " << i->first << " fails over from " << neighbor << " to " << path.m_nextHop);
+      toDst.SetNextHop (path.m_nextHop);
+      toDst.SetHop (path.m_hops);
+      toDst.SetMetric (path.m_metric);
+      toDst.SetLifeTime (path.m_expire - Simulator::Now ());
+      m_routingTable2.Update (toDst);
+      // The prediction held for the broken path
+      m_routeExpiration.erase (i->first);
+      RecordRouteExpiration (i->first, path.m_nextHop, GetLinkExpiration (path.m_nextHop));
+    }
+}
+
+
+//RecvIarp後動く、データ更新して送信するやつ
+void
+RoutingProtocol::SendTriggeredUpdate ()
+{
+  NS_LOG_FUNCTION (m_mainAddress << " is sending a triggered update");
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
+  m_advRoutingTable.GetListOfAllRoutes (allRoutes);
+  bool sent = false;
+  Time heldBack = Seconds (0);
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
+       != m_socketAddresses.end (); ++j)
+    {
+      IarpHeader iarpHeader;
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      Ptr<Packet> packet = Create<Packet> ();
+      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+        {
+        //ホップ数設定
+        if(i->second.GetHop() < m_zoneRadius){
+          NS_LOG_LOGIC ("Destination: " << i->second.GetDestination ()
+                                        << " SeqNo:" << i->second.GetSeqNo () << " HopCount:"
+                                        << i->second.GetHop () + 1);
+          RoutingTableEntry temp = i->second;
+          // Flapping routes wait for the periodic update or their reuse; link breaks still go out
+          if (EnableFlapDamping && !(temp.GetSeqNo () % 2) && m_flapDamping.IsSuppressed (temp.GetDestination ()))
+            {
+              Time reuse = m_flapDamping.GetReuseDelay (temp.GetDestination ());
+              heldBack = heldBack.IsZero () ? reuse : std::min (heldBack, reuse);
+              NS_LOG_DEBUG ("Route to " << temp.GetDestination () << " is flapping, suppressed for " << reuse.GetSeconds () << "s");
+              continue;
+            }
+          if ((i->second.GetEntriesChanged () == true) && (!m_advRoutingTable.AnyRunningEvent (temp.GetDestination ())))
+            {
+              iarpHeader.SetDst (i->second.GetDestination ());
+              iarpHeader.SetDstSeqno (i->second.GetSeqNo ());
+              iarpHeader.SetHopCount (i->second.GetHop () + 1);
+              iarpHeader.SetMetric (i->second.GetMetric ());
+              temp.SetFlag (VALID);
+              temp.SetEntriesChanged (false);
+              m_advRoutingTable.DeleteIpv4Event (temp.GetDestination ());
+              if (!(temp.GetSeqNo () % 2))
+                {
+                  m_routingTable.Update (temp);
+                }
+              packet->AddHeader (iarpHeader);
+              m_advRoutingTable.DeleteRoute (temp.GetDestination ());
+              NS_LOG_DEBUG ("Deleted this route from the advertised table");
+            }
+          else
+            {
+              EventId event = m_advRoutingTable.GetEventId (temp.GetDestination ());
+              NS_ASSERT (event.GetUid () != 0);
+              NS_LOG_DEBUG ("EventID " << event.GetUid () << " associated with "
+                                       << temp.GetDestination () << " has not expired, waiting in adv table");
+            }
+        }
+        }
+      if (packet->GetSize () >= 12 && iarpHeader.GetHopCount() <= m_zoneRadius) //ホップ数設定
+        {
+          RoutingTableEntry temp2;
+          m_routingTable.LookupRoute (m_ipv4->GetAddress (1, 0).GetBroadcast (), temp2);
+          iarpHeader.SetDst (m_ipv4->GetAddress (1, 0).GetLocal ());
+          iarpHeader.SetDstSeqno (temp2.GetSeqNo ());
+          iarpHeader.SetHopCount (temp2.GetHop () + 1);
+          iarpHeader.SetMetric (temp2.GetMetric ());
+          NS_LOG_DEBUG ("Adding my update as well to the packet");
+          packet->AddHeader (iarpHeader);
+          IarpUpdateHeader updateHeader (GetIarpHoldTime (), GetLocalLoad ());
+          packet->AddHeader (updateHeader);
+          TypeHeader tHeader (SHINGO_IARP);
+          packet->AddHeader (tHeader);
+          // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+          Ipv4Address destination;
+          if (iface.GetMask () == Ipv4Mask::GetOnes ())
+            {
+              destination = Ipv4Address ("255.255.255.255");
+            }
+          else
+            {
+              destination = iface.GetBroadcast ();
+            }
+          SendTo (socket, packet, destination);
+          sent = true;
+          NS_LOG_FUNCTION ("Sent Triggered Update from "
+                           << iarpHeader.GetDst ()
+                           << " with packet id : " << packet->GetUid () << " and packet Size: " << packet->GetSize ());
+        }
+      else
+        {
+          NS_LOG_FUNCTION ("Update not sent as there are no updates to be triggered");
+        }
+    }
+  if (sent)
+    {
+      m_nextTriggeredUpdate = Simulator::Now () + m_minTriggeredUpdateInterval;
+    }
+  if (!heldBack.IsZero ())
+    {
+      ScheduleTriggeredUpdate (heldBack);
+    }
+}
+
+void
+RoutingProtocol::ScheduleTriggeredUpdate (Time delay)
+{
+  // One pending triggered update carries every change seen until it expires
+  delay = std::max (delay, m_nextTriggeredUpdate - Simulator::Now ());
+  if (m_triggeredExpireTimer.IsRunning ())
+    {
+      if (m_triggeredExpireTimer.GetDelayLeft () <= delay)
+        {
+          return;
+        }
+      m_triggeredExpireTimer.Cancel ();
+    }
+  m_triggeredExpireTimer.Schedule (delay);
+}
+
+//ブロードキャストで経路情報の更新するやつ?
+void
+RoutingProtocol::SendPeriodicUpdate ()
+{
+  if (m_zoneRadius == 0)
+    {
+      // Pure reactive mode: nothing to advertise, keep the timer for a later radius increase
+      m_periodicUpdateTimer.Schedule (m_periodicUpdateInterval);
+      return;
     }
-*/
+  std::map<Ipv4Address, RoutingTableEntry> removedAddresses, allRoutes;
+  m_routingTable.Purge (removedAddresses);
+  m_zoneChanges += removedAddresses.size ();
+  m_flapDamping.Purge ();
+  if (EnableAdaptiveUpdateInterval)
+    {
+      // Adapt before sending, so that the hold time advertised below covers the next interval
+      AdaptPeriodicUpdateInterval ();
+    }
+  MergeTriggerPeriodicUpdates ();
+  m_routingTable.GetListOfAllRoutes (allRoutes);
+  if (allRoutes.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (m_mainAddress << " is sending out its periodic update");
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
+       != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      Ptr<Packet> packet = Create<Packet> ();
+      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+        {
+          IarpHeader iarpHeader;
+          if (i->second.GetHop () == 0)
+            {
+              RoutingTableEntry ownEntry;
+              iarpHeader.SetDst (m_ipv4->GetAddress (1,0).GetLocal ());
+              iarpHeader.SetDstSeqno (i->second.GetSeqNo () + 2);
+              iarpHeader.SetHopCount (i->second.GetHop () + 1);
+              iarpHeader.SetMetric (i->second.GetMetric ());
+              m_routingTable.LookupRoute (m_ipv4->GetAddress (1,0).GetBroadcast (),ownEntry);
+              ownEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
+              m_routingTable.Update (ownEntry);
+              packet->AddHeader (iarpHeader);
 
-  Ptr<Packet> packet = Create<Packet> ();
-  //SocketIpTtlTag ttl;
-  //ttl.SetTtl (tag.GetTtl () - 1);
-  //packet->AddPacketTag (ttl);
-  packet->AddHeader (rrepHeader);
-  //TypeHeader tHeader (AODVTYPE_RREP);
-  //packet->AddHeader (tHeader);
-  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
-  NS_ASSERT (socket);
-  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), MY_PORT));
+              NS_LOG_DEBUG ("Forwarding the update for " << i->first);
+              NS_LOG_DEBUG ("Forwarding details are, Destination: " << iarpHeader.GetDst ()
+                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
+                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
+                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
+            }
+          else if (i -> second.GetHop() < m_zoneRadius) //ホップ数設定
+            {
+              iarpHeader.SetDst (i->second.GetDestination ());
+              iarpHeader.SetDstSeqno ((i->second.GetSeqNo ()));
+              iarpHeader.SetHopCount (i->second.GetHop () + 1);
+              iarpHeader.SetMetric (i->second.GetMetric ());
+              packet->AddHeader (iarpHeader);
+
+              NS_LOG_DEBUG ("Forwarding the update for " << i->first);
+              NS_LOG_DEBUG ("Forfwarding details are, Destination: " << iarpHeader.GetDst ()
+                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
+                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
+                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
+            }
+/*
+          NS_LOG_DEBUG ("Forwarding the update for " << i->first);
+          NS_LOG_DEBUG ("Forwarding details are, Destination: " << iarpHeader.GetDst ()
+                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
+                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
+                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
+*/
+        }
+      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator rmItr = removedAddresses.begin (); rmItr
+           != removedAddresses.end (); ++rmItr)
+        {
+          IarpHeader removedHeader;
+          removedHeader.SetDst (rmItr->second.GetDestination ());
+          removedHeader.SetDstSeqno (rmItr->second.GetSeqNo () + 1);
+          removedHeader.SetHopCount (rmItr->second.GetHop () + 1);
+          packet->AddHeader (removedHeader);
+          NS_LOG_DEBUG ("Update for removed record is: Destination: " << removedHeader.GetDst ()
+                                                                      << " SeqNo:" << removedHeader.GetDstSeqno ()
+                                                                      << " HopCount:" << removedHeader.GetHopCount ());
+        }
+      IarpUpdateHeader updateHeader (GetIarpHoldTime (), GetLocalLoad ());
+      packet->AddHeader (updateHeader);
+      TypeHeader tHeader (SHINGO_IARP);
+      packet->AddHeader (tHeader);
+      socket->Send (packet);
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      SendTo (socket, packet, destination);
+      NS_LOG_FUNCTION ("PeriodicUpdate Packet UID is : " << packet->GetUid ());
+    }
+  m_periodicUpdateTimer.Schedule (m_periodicUpdateInterval + MicroSeconds (25 * m_uniformRandomVariable->GetInteger (0,1000)));
 }
+
 void
-RoutingProtocol::RecvReplyAck (Ipv4Address neighbor)
+RoutingProtocol::ScheduleZoneSolicit ()
 {
-  NS_LOG_FUNCTION (this);
-  RoutingTableEntry2 rt;
-  if (m_routingTable2.LookupRoute (neighbor, rt))
+  // Start () and NotifyInterfaceUp () may both ask for a solicit; a single pending one covers them
+  if (m_zoneSolicitTimer.IsRunning () || m_zoneRadius == 0 || m_zoneEngine == ZONE_ENGINE_LINK_STATE)
     {
-      rt.m_ackTimer.Cancel ();
-      rt.SetFlag (VALID);
-      m_routingTable2.Update (rt);
+      return;
     }
+  m_zoneSolicitTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,m_zoneSolicitJitter.GetMicroSeconds ())));
 }
 
-
+//起動時・参加時に隣接ノードのゾーン表を要求するやつ
 void
-RoutingProtocol::SendReplyAck (Ipv4Address neighbor)
+RoutingProtocol::SendZoneSolicit ()
 {
-  NS_LOG_FUNCTION (this << " to " << neighbor);
-  RrepAckHeader h;
-  //TypeHeader typeHeader (SHINGO_RREP_ACK);
-  Ptr<Packet> packet = Create<Packet> ();
-  //SocketIpTtlTag tag;
-  //tag.SetTtl (1);
-  //packet->AddPacketTag (tag);
-  packet->AddHeader (h);
-  //packet->AddHeader (typeHeader);
-  RoutingTableEntry toNeighbor;
-  m_routingTable.LookupRoute (neighbor, toNeighbor);
-  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toNeighbor.GetInterface ());
-  NS_ASSERT (socket);
-  socket->SendTo (packet, 0, InetSocketAddress (neighbor, MY_PORT));
+  NS_LOG_FUNCTION (m_mainAddress << " is soliciting the zone tables of its neighbors");
+  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
+       != m_socketAddresses.end (); ++j)
+    {
+      Ptr<Socket> socket = j->first;
+      Ipv4InterfaceAddress iface = j->second;
+      // Advertise the own entry with a fresh sequence number, as a periodic update would
+      RoutingTableEntry ownEntry;
+      m_routingTable.LookupRoute (iface.GetBroadcast (),ownEntry);
+      ownEntry.SetSeqNo (ownEntry.GetSeqNo () + 2);
+      m_routingTable.Update (ownEntry);
+      IarpHeader iarpHeader (iface.GetLocal (), 1, ownEntry.GetSeqNo ());
+      Ptr<Packet> packet = Create<Packet> ();
+      packet->AddHeader (iarpHeader);
+      IarpUpdateHeader updateHeader (GetIarpHoldTime (), GetLocalLoad ());
+      packet->AddHeader (updateHeader);
+      TypeHeader tHeader (SHINGO_ZONE_SOLICIT);
+      packet->AddHeader (tHeader);
+      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+      Ipv4Address destination;
+      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      SendTo (socket, packet, destination);
+    }
 }
 
+void
+RoutingProtocol::RecvZoneSolicit (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender)
+{
+  NS_LOG_FUNCTION (m_mainAddress << " received a zone solicit from " << sender);
+  if (m_zoneRadius == 0)
+    {
+      return;
+    }
+  // The solicit carries the solicitor's own entry, which makes it our neighbor right away
+  RecvIarp (packet, receiver, sender);
+  m_zoneSolicitors.insert (sender);
+  // Solicits heard during the jitter are answered together
+  if (!m_zoneReplyTimer.IsRunning ())
+    {
+      m_zoneReplyTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,m_zoneSolicitJitter.GetMicroSeconds ())));
+    }
+}
 
-//RecvIarp後動く、データ更新して送信するやつ
 void
-RoutingProtocol::SendTriggeredUpdate ()
+RoutingProtocol::SendZoneReply ()
 {
-  NS_LOG_FUNCTION (m_mainAddress << " is sending a triggered update");
+  if (m_zoneSolicitors.empty ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (m_mainAddress << " is answering " << m_zoneSolicitors.size () << " zone solicits");
   std::map<Ipv4Address, RoutingTableEntry> allRoutes;
-  m_advRoutingTable.GetListOfAllRoutes (allRoutes);
+  m_routingTable.GetListOfAllRoutes (allRoutes);
   for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
        != m_socketAddresses.end (); ++j)
     {
-      IarpHeader iarpHeader;
       Ptr<Socket> socket = j->first;
       Ipv4InterfaceAddress iface = j->second;
       Ptr<Packet> packet = Create<Packet> ();
       for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
         {
-        //ホップ数設定
-        if(i->second.GetHop() < 2){
-          NS_LOG_LOGIC ("Destination: " << i->second.GetDestination ()
-                                        << " SeqNo:" << i->second.GetSeqNo () << " HopCount:"
-                                        << i->second.GetHop () + 1);
-          RoutingTableEntry temp = i->second;
-          if ((i->second.GetEntriesChanged () == true) && (!m_advRoutingTable.AnyRunningEvent (temp.GetDestination ())))
+          if (i->second.GetHop () == 0 || i->second.GetFlag () != VALID
+              || m_zoneSolicitors.find (i->second.GetDestination ()) != m_zoneSolicitors.end ())
             {
-              iarpHeader.SetDst (i->second.GetDestination ());
-              iarpHeader.SetDstSeqno (i->second.GetSeqNo ());
-              iarpHeader.SetHopCount (i->second.GetHop () + 1);
-              temp.SetFlag (VALID);
-              temp.SetEntriesChanged (false);
-              m_advRoutingTable.DeleteIpv4Event (temp.GetDestination ());
-              if (!(temp.GetSeqNo () % 2))
-                {
-                  m_routingTable.Update (temp);
-                }
+              continue;
+            }
+          //ホップ数設定
+          if (i->second.GetHop () < m_zoneRadius)
+            {
+              IarpHeader iarpHeader (i->second.GetDestination (), i->second.GetHop () + 1, i->second.GetSeqNo (),
+                                     i->second.GetMetric ());
               packet->AddHeader (iarpHeader);
-              //TypeHeader tHeader (SHINGO_IARP);
-              //packet->AddHeader (tHeader);
-              m_advRoutingTable.DeleteRoute (temp.GetDestination ());
-              NS_LOG_DEBUG ("Deleted this route from the advertised table");
+            }
+        }
+      RoutingTableEntry ownEntry;
+      m_routingTable.LookupRoute (iface.GetBroadcast (),ownEntry);
+      IarpHeader ownHeader (iface.GetLocal (), 1, ownEntry.GetSeqNo ());
+      packet->AddHeader (ownHeader);
+      IarpUpdateHeader updateHeader (GetIarpHoldTime (), GetLocalLoad ());
+      packet->AddHeader (updateHeader);
+      TypeHeader tHeader (SHINGO_IARP);
+      packet->AddHeader (tHeader);
+      // A lone solicitor gets the table by unicast, several share one broadcast
+      Ipv4Address destination;
+      if (m_zoneSolicitors.size () == 1)
+        {
+          destination = *m_zoneSolicitors.begin ();
+        }
+      else if (iface.GetMask () == Ipv4Mask::GetOnes ())
+        {
+          destination = Ipv4Address ("255.255.255.255");
+        }
+      else
+        {
+          destination = iface.GetBroadcast ();
+        }
+      SendTo (socket, packet, destination);
+      NS_LOG_DEBUG ("Sent zone reply to " << destination << " with packet size: " << packet->GetSize ());
+    }
+  m_zoneSolicitors.clear ();
+}
+
+void
+RoutingProtocol::AdaptZoneRadius ()
+{
+  NS_LOG_FUNCTION (m_mainAddress << " IARP bytes " << m_zoneRadiusAdaptation.GetIarpBytes ()
+                                 << " RREQ bytes " << m_zoneRadiusAdaptation.GetRreqBytes ());
+  uint32_t radius = m_zoneRadiusAdaptation.Adapt (m_zoneRadius);
+  if (radius != m_zoneRadius)
+    {
+      SetZoneRadius (radius);
+    }
+  m_zoneRadiusTimer.Schedule (m_zoneRadiusAdaptInterval);
+}
+
+void
+RoutingProtocol::SetZoneRadius (uint32_t radius)
+{
+  NS_LOG_DEBUG (m_mainAddress << " changes its zone radius from " << m_zoneRadius << " to " << radius);
+  bool grown = radius > m_zoneRadius;
+  m_zoneRadius = radius;
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE)
+    {
+      // The zone graph of the larger zone fills in as the neighbor sets travel farther
+      UpdateZoneRoutes ();
+      return;
+    }
+  if (grown)
+    {
+      // Fetch the members of the larger zone instead of waiting for the next periodic updates
+      ScheduleZoneSolicit ();
+      return;
+    }
+  m_advRoutingTable.DeleteRoutesBeyond (m_zoneRadius);
+  m_routingTable.DeleteRoutesBeyond (m_zoneRadius);
+}
+
+//リンク状態方式のゾーン管理: 隣接ノード集合を送信するやつ
+void
+RoutingProtocol::SendNeighborSet ()
+{
+  bool changed = m_zoneGraph.Purge ();
+  changed = UpdateOwnNeighborSet () || changed;
+  if (changed)
+    {
+      UpdateZoneRoutes ();
+    }
+  if (m_zoneRadius > 0)
+    {
+      m_neighborSetSeqNo++;
+      // The neighbor set carries the destination sequence number the zone members answer RREQs for this node with
+      if (int32_t (m_seqNo) - int32_t (m_neighborSetSeqNo) > 0)
+        {
+          m_neighborSetSeqNo = m_seqNo;
+        }
+      for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
+           != m_socketAddresses.end (); ++j)
+        {
+          Ptr<Socket> socket = j->first;
+          Ipv4InterfaceAddress iface = j->second;
+          NeighborSetHeader neighborSetHeader (iface.GetLocal (), m_neighborSetSeqNo, std::min<uint32_t> (m_zoneRadius - 1, 255));
+          for (std::map<Ipv4Address, Time>::const_iterator i = m_zoneNeighbors.begin (); i != m_zoneNeighbors.end (); ++i)
+            {
+              neighborSetHeader.AddNeighbor (i->first);
+            }
+          Ptr<Packet> packet = Create<Packet> ();
+          packet->AddHeader (neighborSetHeader);
+          TypeHeader tHeader (SHINGO_NEIGHBOR_SET);
+          packet->AddHeader (tHeader);
+          // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+          Ipv4Address destination;
+          if (iface.GetMask () == Ipv4Mask::GetOnes ())
+            {
+              destination = Ipv4Address ("255.255.255.255");
             }
           else
             {
-              EventId event = m_advRoutingTable.GetEventId (temp.GetDestination ());
-              NS_ASSERT (event.GetUid () != 0);
-              NS_LOG_DEBUG ("EventID " << event.GetUid () << " associated with "
-                                       << temp.GetDestination () << " has not expired, waiting in adv table");
+              destination = iface.GetBroadcast ();
+            }
+          SendTo (socket, packet, destination);
+        }
+    }
+  m_neighborSetTimer.Schedule (m_neighborSetInterval + MicroSeconds (25 * m_uniformRandomVariable->GetInteger (0,1000)));
+}
+
+void
+RoutingProtocol::RecvNeighborSet (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender)
+{
+  NeighborSetHeader neighborSetHeader;
+  packet->RemoveHeader (neighborSetHeader);
+  Ipv4Address origin = neighborSetHeader.GetOrigin ();
+  NS_LOG_FUNCTION (m_mainAddress << " received the neighbor set of " << origin << " from " << sender);
+  if (m_zoneEngine != ZONE_ENGINE_LINK_STATE || IsMyOwnAddress (origin))
+    {
+      return;
+    }
+  bool changed = false;
+  if (origin == sender && !m_blacklist.IsBlacklisted (sender))
+    {
+      bool known = m_zoneNeighbors.find (sender) != m_zoneNeighbors.end ();
+      m_zoneNeighbors[sender] = Simulator::Now () + m_neighborHoldTime;
+      if (!known)
+        {
+          changed = UpdateOwnNeighborSet ();
+          // Let the new neighbor know soon that the link is symmetric
+          if (m_neighborSetTimer.GetDelayLeft () > m_minTriggeredUpdateInterval)
+            {
+              m_neighborSetTimer.Cancel ();
+              m_neighborSetTimer.Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,m_minTriggeredUpdateInterval.GetMicroSeconds ())));
             }
         }
+    }
+  if (m_zoneGraph.IsNewer (origin, neighborSetHeader.GetSeqNo ()))
+    {
+      std::set<Ipv4Address> neighbors (neighborSetHeader.GetNeighbors ().begin (), neighborSetHeader.GetNeighbors ().end ());
+      changed = m_zoneGraph.Update (origin, neighborSetHeader.GetSeqNo (), neighbors,
+                                    Simulator::Now () + m_neighborHoldTime) || changed;
+      // The zone route to the origin takes its sequence number and lasts until its neighbor sets stop
+      RoutingTableEntry toOrigin;
+      if (m_routingTable.LookupRoute (origin, toOrigin) && toOrigin.GetHop () > 0)
+        {
+          toOrigin.SetSeqNo (neighborSetHeader.GetSeqNo ());
+          toOrigin.SetLifeTime (Simulator::Now ());
+          m_routingTable.Update (toOrigin);
         }
-      if (packet->GetSize () >= 12 && iarpHeader.GetHopCount() <= 2) //ホップ数設定
+      if (origin == sender)
         {
-          RoutingTableEntry temp2;
-          m_routingTable.LookupRoute (m_ipv4->GetAddress (1, 0).GetBroadcast (), temp2);
-          iarpHeader.SetDst (m_ipv4->GetAddress (1, 0).GetLocal ());
-          iarpHeader.SetDstSeqno (temp2.GetSeqNo ());
-          iarpHeader.SetHopCount (temp2.GetHop () + 1);
-          NS_LOG_DEBUG ("Adding my update as well to the packet");
-          packet->AddHeader (iarpHeader);
-          //TypeHeader tHeader (SHINGO_IARP);
-          //packet->AddHeader (tHeader);
-          // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
+          m_mprSelection.SetLinks (origin, neighbors, Simulator::Now () + m_neighborHoldTime);
+        }
+      if (neighborSetHeader.GetHopsLeft () > 0)
+        {
+          neighborSetHeader.SetHopsLeft (neighborSetHeader.GetHopsLeft () - 1);
+          Ptr<Packet> relay = Create<Packet> ();
+          relay->AddHeader (neighborSetHeader);
+          TypeHeader tHeader (SHINGO_NEIGHBOR_SET);
+          relay->AddHeader (tHeader);
+          Ipv4InterfaceAddress iface = m_ipv4->GetAddress (m_ipv4->GetInterfaceForAddress (receiver), 0);
+          Ptr<Socket> socket = FindSocketWithInterfaceAddress (iface);
+          NS_ASSERT (socket);
           Ipv4Address destination;
           if (iface.GetMask () == Ipv4Mask::GetOnes ())
             {
@@ -1489,111 +4287,105 @@ RoutingProtocol::SendTriggeredUpdate ()
             {
               destination = iface.GetBroadcast ();
             }
-          socket->SendTo (packet, 0, InetSocketAddress (destination, MY_PORT));
-          NS_LOG_FUNCTION ("Sent Triggered Update from "
-                           << iarpHeader.GetDst ()
-                           << " with packet id : " << packet->GetUid () << " and packet Size: " << packet->GetSize ());
+          Simulator::Schedule (MicroSeconds (m_uniformRandomVariable->GetInteger (0,10000)),
+                               &RoutingProtocol::SendTo, this, socket, relay, destination);
+        }
+    }
+  if (changed)
+    {
+      UpdateZoneRoutes ();
+    }
+}
+
+bool
+RoutingProtocol::UpdateOwnNeighborSet ()
+{
+  std::set<Ipv4Address> neighbors;
+  for (std::map<Ipv4Address, Time>::iterator i = m_zoneNeighbors.begin (); i != m_zoneNeighbors.end (); )
+    {
+      if (i->second < Simulator::Now ())
+        {
+          m_zoneNeighbors.erase (i++);
         }
       else
         {
-          NS_LOG_FUNCTION ("Update not sent as there are no updates to be triggered");
+          neighbors.insert (i->first);
+          ++i;
         }
     }
+  return m_zoneGraph.Update (m_mainAddress, 0, neighbors, Simulator::GetMaximumSimulationTime ());
 }
 
-//ブロードキャストで経路情報の更新するやつ?
 void
-RoutingProtocol::SendPeriodicUpdate ()
+RoutingProtocol::UpdateZoneRoutes ()
 {
-  std::map<Ipv4Address, RoutingTableEntry> removedAddresses, allRoutes;
-  m_routingTable.Purge (removedAddresses);
-  MergeTriggerPeriodicUpdates ();
+  std::map<Ipv4Address, ZoneRoute> routes;
+  m_zoneGraph.ComputeRoutes (m_mainAddress, m_zoneRadius, routes);
+  std::map<Ipv4Address, RoutingTableEntry> allRoutes;
   m_routingTable.GetListOfAllRoutes (allRoutes);
-  if (allRoutes.empty ())
-    {
-      return;
-    }
-  NS_LOG_FUNCTION (m_mainAddress << " is sending out its periodic update");
-  for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.begin (); j
-       != m_socketAddresses.end (); ++j)
+  for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
     {
-      Ptr<Socket> socket = j->first;
-      Ipv4InterfaceAddress iface = j->second;
-      Ptr<Packet> packet = Create<Packet> ();
-      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator i = allRoutes.begin (); i != allRoutes.end (); ++i)
+      if (i->second.GetHop () > 0 && routes.find (i->first) == routes.end ())
         {
-          IarpHeader iarpHeader;
-          if (i->second.GetHop () == 0)
-            {
-              RoutingTableEntry ownEntry;
-              iarpHeader.SetDst (m_ipv4->GetAddress (1,0).GetLocal ());
-              iarpHeader.SetDstSeqno (i->second.GetSeqNo () + 2);
-              iarpHeader.SetHopCount (i->second.GetHop () + 1);
-              m_routingTable.LookupRoute (m_ipv4->GetAddress (1,0).GetBroadcast (),ownEntry);
-              ownEntry.SetSeqNo (iarpHeader.GetDstSeqno ());
-              m_routingTable.Update (ownEntry);
-              packet->AddHeader (iarpHeader);
-              //TypeHeader tHeader (SHINGO_IARP);
-              //packet->AddHeader (tHeader);
-
-              NS_LOG_DEBUG ("Forwarding the update for " << i->first);
-              NS_LOG_DEBUG ("Forwarding details are, Destination: " << iarpHeader.GetDst ()
-                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
-                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
-                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
-            }
-          else if (i -> second.GetHop() <= 2) //ホップ数設定
-            {
-              iarpHeader.SetDst (i->second.GetDestination ());
-              iarpHeader.SetDstSeqno ((i->second.GetSeqNo ()));
-              iarpHeader.SetHopCount (i->second.GetHop () + 1);
-              packet->AddHeader (iarpHeader);
-              //TypeHeader tHeader (SHINGO_IARP);
-              //packet->AddHeader (tHeader);
-
-              NS_LOG_DEBUG ("Forwarding the update for " << i->first);
-              NS_LOG_DEBUG ("Forfwarding details are, Destination: " << iarpHeader.GetDst ()
-                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
-                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
-                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
-            }
-/*
-          NS_LOG_DEBUG ("Forwarding the update for " << i->first);
-          NS_LOG_DEBUG ("Forwarding details are, Destination: " << iarpHeader.GetDst ()
-                                                                << ", SeqNo:" << iarpHeader.GetDstSeqno ()
-                                                                << ", HopCount:" << iarpHeader.GetHopCount ()
-                                                                << ", LifeTime: " << i->second.GetLifeTime ().GetSeconds ());
-*/
+          NS_LOG_DEBUG (m_mainAddress << " lost the zone route to " << i->first);
+          m_routingTable.DeleteRoute (i->first);
+          m_zoneChanges++;
         }
-      for (std::map<Ipv4Address, RoutingTableEntry>::const_iterator rmItr = removedAddresses.begin (); rmItr
-           != removedAddresses.end (); ++rmItr)
+    }
+  int32_t interface = m_ipv4->GetInterfaceForAddress (m_mainAddress);
+  Ipv4InterfaceAddress iface = m_ipv4->GetAddress (interface, 0);
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (interface);
+  for (std::map<Ipv4Address, ZoneRoute>::const_iterator i = routes.begin (); i != routes.end (); ++i)
+    {
+      RoutingTableEntry rt;
+      bool known = m_routingTable.LookupRoute (i->first, rt);
+      if (known && rt.GetHop () == i->second.m_hops && rt.GetNextHop () == i->second.m_nextHop)
         {
-          IarpHeader removedHeader;
-          removedHeader.SetDst (rmItr->second.GetDestination ());
-          removedHeader.SetDstSeqno (rmItr->second.GetSeqNo () + 1);
-          removedHeader.SetHopCount (rmItr->second.GetHop () + 1);
-          packet->AddHeader (removedHeader);
-          //TypeHeader tHeader (SHINGO_IARP);
-          //packet->AddHeader (tHeader);
-          NS_LOG_DEBUG ("Update for removed record is: Destination: " << removedHeader.GetDst ()
-                                                                      << " SeqNo:" << removedHeader.GetDstSeqno ()
-                                                                      << " HopCount:" << removedHeader.GetHopCount ());
+          continue;
         }
-      socket->Send (packet);
-      // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
-      Ipv4Address destination;
-      if (iface.GetMask () == Ipv4Mask::GetOnes ())
+      // The route carries the sequence number of the last neighbor set of the destination and is purged
+      // NeighborHoldTime after it, unless a later one refreshes it
+      RoutingTableEntry entry (/*device=*/ dev, /*dst=*/ i->first, /*seqno=*/ m_zoneGraph.GetSeqNo (i->first), /*iface=*/ iface,
+                                           /*hops=*/ i->second.m_hops, /*next hop=*/ i->second.m_nextHop,
+                                           /*lifetime=*/ Simulator::Now ());
+      entry.SetHoldTime (m_neighborHoldTime);
+      if (known)
         {
-          destination = Ipv4Address ("255.255.255.255");
+          m_routingTable.Update (entry);
         }
       else
         {
-          destination = iface.GetBroadcast ();
+          m_routingTable.AddRoute (entry);
         }
-      socket->SendTo (packet, 0, InetSocketAddress (destination, MY_PORT));
-      NS_LOG_FUNCTION ("PeriodicUpdate Packet UID is : " << packet->GetUid ());
+      m_zoneChanges++;
     }
-  m_periodicUpdateTimer.Schedule (m_periodicUpdateInterval + MicroSeconds (25 * m_uniformRandomVariable->GetInteger (0,1000)));
+}
+
+void
+RoutingProtocol::AdaptPeriodicUpdateInterval ()
+{
+  NS_LOG_FUNCTION (m_mainAddress << " saw " << m_zoneChanges << " zone changes in " << m_periodicUpdateInterval.GetSeconds () << "s");
+  // A churning zone is refreshed quickly and forgets lost members early, a stable one is advertised rarely
+  if (m_zoneChanges >= m_churnThreshold)
+    {
+      m_periodicUpdateInterval = std::max (m_minPeriodicUpdateInterval, Time (m_periodicUpdateInterval / 2));
+      Holdtimes = std::max (m_minHoldtimes, Holdtimes - 1);
+    }
+  else if (m_zoneChanges == 0)
+    {
+      m_periodicUpdateInterval = std::min (m_maxPeriodicUpdateInterval, Time (2 * m_periodicUpdateInterval));
+      Holdtimes = std::min (m_maxHoldtimes, Holdtimes + 1);
+    }
+  m_zoneChanges = 0;
+  // Entries learnt through IARP carry the hold time of their advertiser, these apply to the rest
+  m_routingTable.Setholddowntime (GetIarpHoldTime ());
+  m_advRoutingTable.Setholddowntime (GetIarpHoldTime ());
+}
+
+Time
+RoutingProtocol::GetIarpHoldTime () const
+{
+  return Time (Holdtimes * m_periodicUpdateInterval);
 }
 
 
@@ -1602,25 +4394,63 @@ RoutingProtocol::SendRequest (Ipv4Address dst)
 {
   //printf("SendRequest\n");
   NS_LOG_FUNCTION ( this << dst);
+  // A local repair tries one small ring of its own, whatever the rings of the other discoveries
+  if (m_localRepairStart.find (dst) != m_localRepairStart.end ())
+    {
+      SendRepairRequest (dst);
+      return;
+    }
+  // The destinations asked for within RreqBatchDelay share one RREQ
+  if (std::find (m_requestBatch.begin (), m_requestBatch.end (), dst) == m_requestBatch.end ())
+    {
+      m_requestBatch.push_back (dst);
+    }
+  if (m_maxRreqDestinations <= 1 || m_requestBatch.size () >= m_maxRreqDestinations)
+    {
+      m_rreqBatchTimer.Cancel ();
+      SendBatchedRequest ();
+    }
+  else if (!m_rreqBatchTimer.IsRunning ())
+    {
+      m_rreqBatchTimer.Schedule (m_rreqBatchDelay);
+    }
+}
+
+void
+RoutingProtocol::SendBatchedRequest ()
+{
+  NS_LOG_FUNCTION (this);
+  // A destination found while it waited needs no RREQ any more, unless its route is refreshed
+  std::vector<Ipv4Address> batch;
+  for (std::vector<Ipv4Address>::const_iterator i = m_requestBatch.begin (); i != m_requestBatch.end (); ++i)
+    {
+      RoutingTableEntry2 toDst;
+      if ((!m_routingTable2.LookupValidRoute (*i, toDst) || m_routeRefresh.count (*i) > 0)
+          && m_localRepairStart.find (*i) == m_localRepairStart.end ())
+        {
+          batch.push_back (*i);
+        }
+    }
+  if (batch.empty ())
+    {
+      m_requestBatch.clear ();
+      return;
+    }
   // A node SHOULD NOT originate more than RREQ_RATELIMIT RREQ messages per second.
 
   if (m_rreqCount == m_rreqRateLimit)
     {
-      Simulator::Schedule (m_rreqRateLimitTimer.GetDelayLeft () + MicroSeconds (100),
-                           &RoutingProtocol::SendRequest, this, dst);
+      m_rreqBatchTimer.Cancel ();
+      m_rreqBatchTimer.Schedule (m_rreqRateLimitTimer.GetDelayLeft () + MicroSeconds (100));
       return;
     }
   else
     {
       m_rreqCount++;
     }
+  m_requestBatch.clear ();
 
 //m_rreqCount++;
-  // Create RREQ header
-  RreqHeader rreqHeader;
-  rreqHeader.SetDst (dst);
-  //rreqHeader.SetRad(Ipv4Address("10.1.1.12"));
-
   RoutingTableEntry2 rt;
   // Using the Hop field in Routing Table to manage the expanding ring search
   uint16_t ttl = m_ttlStart;
@@ -1671,51 +4501,127 @@ if(rt.GetFlag() == DISCOVER){
 */
 
 
-  if (m_routingTable2.LookupRoute (dst, rt))
+  /*
+   * A destination outside the zone is more than ZoneRadius hops away and a RREQ reaching a node
+   * with the destination in its zone is answered, so the first ring ends just beyond the zone
+   * boundary and every next one grows by a zone diameter.
+   */
+  uint16_t hopCap = GetHopCap ();
+  uint16_t ttlStart = m_ttlStart;
+  uint16_t ttlIncrement = m_ttlIncrement;
+  if (m_zoneRing && m_zoneRadius > 0)
+    {
+      ttlStart = m_zoneRadius + 1;
+      ttlIncrement = 2 * m_zoneRadius;
+    }
+  // Every destination asks for its own ring: the RREQ reaches the widest
+  ttl = std::min (ttlStart, hopCap);
+  for (std::vector<Ipv4Address>::const_iterator dst = batch.begin (); dst != batch.end (); ++dst)
     {
-      if (rt.GetFlag () != IN_SEARCH)
+      uint16_t ring = std::min (ttlStart, hopCap);
+      if (m_routingTable2.LookupRoute (*dst, rt))
         {
-          ttl = std::min<uint16_t> (rt.GetHop () + m_ttlIncrement, m_netDiameter);
+          if (rt.GetFlag () != IN_SEARCH)
+            {
+              ring = std::min<uint16_t> (std::max<uint16_t> (rt.GetHop () + m_ttlIncrement, ttlStart), hopCap);
+            }
+          else
+            {
+              ring = rt.GetHop () + ttlIncrement;
+              if (ring > std::max (m_ttlThreshold, ttlStart))
+                {
+                  ring = hopCap;
+                }
+            }
         }
-      else
+      ttl = std::max (ttl, std::min (ring, hopCap));
+    }
+  OriginateRequest (batch, ttl);
+}
+
+void
+RoutingProtocol::SendRepairRequest (Ipv4Address dst)
+{
+  NS_LOG_FUNCTION (this << dst);
+  RoutingTableEntry2 rt;
+  if (m_localRepairStart.find (dst) == m_localRepairStart.end () || !m_routingTable2.LookupRoute (dst, rt)
+      || rt.GetFlag () == IN_SEARCH || GetRepairTtl (rt) == 0)
+    {
+      return;
+    }
+  if (m_rreqCount == m_rreqRateLimit)
+    {
+      Simulator::Schedule (m_rreqRateLimitTimer.GetDelayLeft () + MicroSeconds (100), &RoutingProtocol::SendRepairRequest, this, dst);
+      return;
+    }
+  m_rreqCount++;
+  OriginateRequest (std::vector<Ipv4Address> (1, dst), std::min<uint16_t> (GetRepairTtl (rt), GetHopCap ()));
+}
+
+void
+RoutingProtocol::OriginateRequest (std::vector<Ipv4Address> const & batch, uint16_t ttl)
+{
+  NS_LOG_FUNCTION (this << batch.front () << ttl);
+  uint16_t hopCap = GetHopCap ();
+  RoutingTableEntry2 rt;
+  // Create RREQ header
+  RreqHeader rreqHeader;
+  rreqHeader.SetDst (batch.front ());
+  std::set<Ipv4Address> refreshed;
+  for (std::vector<Ipv4Address>::const_iterator dst = batch.begin (); dst != batch.end (); ++dst)
+    {
+      bool validSeqNo = false;
+      uint32_t dstSeqNo = 0;
+      if (m_routingTable2.LookupRoute (*dst, rt))
         {
-          ttl = rt.GetHop () + m_ttlIncrement;
-          if (ttl > m_ttlThreshold)
+          // A refreshed route carries the data until the RREP replaces it
+          bool refresh = m_routeRefresh.erase (*dst) > 0 && rt.GetFlag () == VALID;
+          if (ttl >= hopCap && !refresh)
             {
-              ttl = m_netDiameter;
+              rt.IncrementRreqCnt ();
+            }
+          validSeqNo = rt.GetValidSeqNo ();
+          dstSeqNo = rt.GetSeqNo ();
+          // Only the nodes that heard of the destination after the break may answer a local repair or a refresh
+          if (m_localRepairStart.find (*dst) != m_localRepairStart.end () || refresh)
+            {
+              dstSeqNo++;
+            }
+          if (refresh)
+            {
+              refreshed.insert (*dst);
+            }
+          else
+            {
+              rt.SetHop (ttl);
+              rt.SetFlag (IN_SEARCH);
+              rt.SetLifeTime (m_pathDiscoveryTime);
+              m_routingTable2.Update (rt);
             }
         }
-      if (ttl == m_netDiameter)
+      else
         {
-          rt.IncrementRreqCnt ();
+          Ptr<NetDevice> dev = 0;
+          RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ *dst, /*validSeqNo=*/ false, /*seqno=*/ 0,
+                                                  /*iface=*/ Ipv4InterfaceAddress (),/*hop=*/ ttl,
+                                                  /*nextHop=*/ Ipv4Address (), /*lifeTime=*/ m_pathDiscoveryTime);
+          // Check if the first ring already reaches the hop cap
+          if (ttl == hopCap)
+            {
+              newEntry.IncrementRreqCnt ();
+            }
+          newEntry.SetFlag (IN_SEARCH);
+          m_routingTable2.AddRoute (newEntry);
         }
-      if (rt.GetValidSeqNo ())
+      if (dst == batch.begin ())
         {
-          rreqHeader.SetDstSeqno (rt.GetSeqNo ());
+          rreqHeader.SetDstSeqno (validSeqNo ? dstSeqNo : 0);
+          rreqHeader.SetUnknownSeqno (!validSeqNo);
         }
       else
         {
-          rreqHeader.SetUnknownSeqno (true);
-        }
-      rt.SetHop (ttl);
-      rt.SetFlag (IN_SEARCH);
-      rt.SetLifeTime (m_pathDiscoveryTime);
-      m_routingTable2.Update (rt);
-    }
-  else
-    {
-      rreqHeader.SetUnknownSeqno (true);
-      Ptr<NetDevice> dev = 0;
-      RoutingTableEntry2 newEntry (/*device=*/ dev, /*dst=*/ dst, /*validSeqNo=*/ false, /*seqno=*/ 0,
-                                              /*iface=*/ Ipv4InterfaceAddress (),/*hop=*/ ttl,
-                                              /*nextHop=*/ Ipv4Address (), /*lifeTime=*/ m_pathDiscoveryTime);
-      // Check if TtlStart == NetDiameter
-      if (ttl == m_netDiameter)
-        {
-          newEntry.IncrementRreqCnt ();
+          rreqHeader.AddDestination (*dst, validSeqNo ? dstSeqNo : 0, m_destinationOnly, !validSeqNo);
         }
-      newEntry.SetFlag (IN_SEARCH);
-      m_routingTable2.AddRoute (newEntry);
     }
 //}
   if (m_gratuitousReply)
@@ -1731,6 +4637,7 @@ if(rt.GetFlag() == DISCOVER){
   rreqHeader.SetOriginSeqno (m_seqNo);
   m_requestId++;
   rreqHeader.SetId (m_requestId);
+  rreqHeader.SetTtl (ttl);
 
   // Send RREQ as subnet directed broadcast from each interface used by aodv
   for (std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j =
@@ -1743,13 +4650,9 @@ if(rt.GetFlag() == DISCOVER){
       m_rreqIdCache.IsDuplicate (iface.GetLocal (), m_requestId);
 
       Ptr<Packet> packet = Create<Packet> ();
-      SocketIpTtlTag tag;
-      tag.SetTtl (ttl);
-      packet->RemovePacketTag (tag);
-      //packet->AddPacketTag (tag);
       packet->AddHeader (rreqHeader);
-      //TypeHeader tHeader (AODVTYPE_RREQ);
-      //packet->AddHeader (tHeader);
+      TypeHeader tHeader (SHINGO_RREQ);
+      packet->AddHeader (tHeader);
 
       // Send to all-hosts broadcast if on /32 addr, subnet-directed otherwise
       Ipv4Address destination;
@@ -1764,6 +4667,17 @@ if(rt.GetFlag() == DISCOVER){
         }
       NS_LOG_DEBUG ("Send RREQ with id " << rreqHeader.GetId () << " to socket");
       m_lastBcastTime = Simulator::Now ();
+      if (m_rreqDissemination == RREQ_BORDERCAST)
+        {
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::Bordercast, this, socket, rreqHeader, destination);
+          continue;
+        }
+      if (m_rreqDissemination == RREQ_MPR)
+        {
+          m_mprRelayCache.IsDuplicate (iface.GetLocal (), m_requestId);
+          Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendRequestToMprs, this, socket, rreqHeader, destination);
+          continue;
+        }
       Simulator::Schedule (Time (MilliSeconds (m_uniformRandomVariable->GetInteger (0, 10))), &RoutingProtocol::SendTo, this, socket, packet, destination);
 /*
   std::map<Ipv4Address, RoutingTableEntry> allRoutes;
@@ -1786,7 +4700,14 @@ break;
     }     
 */
     }
-  ScheduleRreqRetry (dst);
+  for (std::vector<Ipv4Address>::const_iterator dst = batch.begin (); dst != batch.end (); ++dst)
+    {
+      // A refresh is not retried: the route breaking sends a RREQ of its own
+      if (refreshed.count (*dst) == 0)
+        {
+          ScheduleRreqRetry (*dst);
+        }
+    }
 }
 
 
@@ -1803,18 +4724,32 @@ RoutingProtocol::SendReply (RreqHeader const & rreqHeader, RoutingTableEntry2 co
     {
       m_seqNo++;
     }
+  // Proxy RREPs carry the zone sequence number, which this RREP must not fall behind
+  RoutingTableEntry ownEntry;
+  if (m_routingTable.LookupRoute (toOrigin.GetInterface ().GetBroadcast (), ownEntry)
+      && int32_t (ownEntry.GetSeqNo ()) - int32_t (m_seqNo) > 0)
+    {
+      m_seqNo = ownEntry.GetSeqNo ();
+    }
+  if (m_zoneEngine == ZONE_ENGINE_LINK_STATE && int32_t (m_neighborSetSeqNo) - int32_t (m_seqNo) > 0)
+    {
+      m_seqNo = m_neighborSetSeqNo;
+    }
+  // The members answer for the anycast group with the same sequence number: the origin keeps the nearest one
+  uint32_t dstSeqNo = IsAnycastMember (rreqHeader.GetDst ()) ? 0 : m_seqNo;
   RrepHeader rrepHeader ( /*prefixSize=*/ 0, /*hops=*/ 0, /*dst=*/ rreqHeader.GetDst (),
-                                          /*dstSeqNo=*/ m_seqNo, /*origin=*/ toOrigin.GetDestination (), /*lifeTime=*/ m_myRouteTimeout);
+                                          /*dstSeqNo=*/ dstSeqNo, /*origin=*/ toOrigin.GetDestination (), /*lifeTime=*/ m_myRouteTimeout);
+  RequestReplyAck (rrepHeader, toOrigin.GetNextHop ());
   Ptr<Packet> packet = Create<Packet> ();
   //SocketIpTtlTag tag;
   //tag.SetTtl (toOrigin.GetHop ());
   //packet->AddPacketTag (tag);
   packet->AddHeader (rrepHeader);
-  //TypeHeader tHeader (AODVTYPE_RREP);
-  //packet->AddHeader (tHeader);
+  TypeHeader tHeader (SHINGO_RREP);
+  packet->AddHeader (tHeader);
   Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
   NS_ASSERT (socket);
-  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), MY_PORT));
+  SendTo (socket, packet, toOrigin.GetNextHop ());
 }
 
 void
@@ -1824,18 +4759,10 @@ RoutingProtocol::SendReplyByIntermediateNode (RoutingTableEntry2 & toDst, Routin
   NS_LOG_FUNCTION (this);
   RrepHeader rrepHeader (/*prefix size=*/ 0, /*hops=*/ toDst.GetHop (), /*dst=*/ toDst.GetDestination (), /*dst seqno=*/ toDst.GetSeqNo (),
                                           /*origin=*/ toOrigin.GetDestination (), /*lifetime=*/ toDst.GetLifeTime ());
-  /* If the node we received a RREQ for is a neighbor we are
-   * probably facing a unidirectional link... Better request a RREP-ack
-   */
-  if (toDst.GetHop () == 1)
-    {
-      rrepHeader.SetAckRequired (true);
-      RoutingTableEntry2 toNextHop;
-      m_routingTable2.LookupRoute (toOrigin.GetNextHop (), toNextHop);
-      toNextHop.m_ackTimer.SetFunction (&RoutingProtocol::AckTimerExpire, this);
-      toNextHop.m_ackTimer.SetArguments (toNextHop.GetDestination (), m_blackListTimeout);
-      toNextHop.m_ackTimer.SetDelay (m_nextHopWait);
-    }
+  rrepHeader.SetMetric (toDst.GetMetric ());
+  rrepHeader.SetExpiration (GetRouteExpiration (toDst.GetDestination ()));
+  // The reverse route was learnt from the RREQ only: the next hop may not hear this node
+  RequestReplyAck (rrepHeader, toOrigin.GetNextHop ());
   toDst.InsertPrecursor (toOrigin.GetNextHop ());
   toOrigin.InsertPrecursor (toDst.GetNextHop ());
   m_routingTable2.Update (toDst);
@@ -1846,11 +4773,11 @@ RoutingProtocol::SendReplyByIntermediateNode (RoutingTableEntry2 & toDst, Routin
   //tag.SetTtl (toOrigin.GetHop ());
   //packet->AddPacketTag (tag);
   packet->AddHeader (rrepHeader);
-  //TypeHeader tHeader (AODVTYPE_RREP);
-  //packet->AddHeader (tHeader);
+  TypeHeader tHeader (SHINGO_RREP);
+  packet->AddHeader (tHeader);
   Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
   NS_ASSERT (socket);
-  socket->SendTo (packet, 0, InetSocketAddress (toOrigin.GetNextHop (), MY_PORT));
+  SendTo (socket, packet, toOrigin.GetNextHop ());
 
   // Generating gratuitous RREPs
   if (gratRep)
@@ -1858,26 +4785,98 @@ RoutingProtocol::SendReplyByIntermediateNode (RoutingTableEntry2 & toDst, Routin
       RrepHeader gratRepHeader (/*prefix size=*/ 0, /*hops=*/ toOrigin.GetHop (), /*dst=*/ toOrigin.GetDestination (),
                                                  /*dst seqno=*/ toOrigin.GetSeqNo (), /*origin=*/ toDst.GetDestination (),
                                                  /*lifetime=*/ toOrigin.GetLifeTime ());
+      gratRepHeader.SetMetric (toOrigin.GetMetric ());
+      gratRepHeader.SetExpiration (GetRouteExpiration (toOrigin.GetDestination ()));
       Ptr<Packet> packetToDst = Create<Packet> ();
       //SocketIpTtlTag gratTag;
       //gratTag.SetTtl (toDst.GetHop ());
       //packetToDst->AddPacketTag (gratTag);
       packetToDst->AddHeader (gratRepHeader);
-      //TypeHeader type (AODVTYPE_RREP);
-      //packetToDst->AddHeader (type);
+      TypeHeader type (SHINGO_RREP);
+      packetToDst->AddHeader (type);
       Ptr<Socket> socket = FindSocketWithInterfaceAddress (toDst.GetInterface ());
       NS_ASSERT (socket);
       NS_LOG_LOGIC ("Send gratuitous RREP " << packet->GetUid ());
-      socket->SendTo (packetToDst, 0, InetSocketAddress (toDst.GetNextHop (), MY_PORT));
+      SendTo (socket, packetToDst, toDst.GetNextHop ());
     }
 }
 
+void
+RoutingProtocol::SendProxyReply (Ipv4Address dst, RoutingTableEntry const & zoneRoute, RoutingTableEntry2 & toOrigin)
+{
+  NS_LOG_FUNCTION (this << dst << zoneRoute.GetDestination ());
+  // The zone route stays valid as long as it is advertised again within the hold time
+  RrepHeader rrepHeader (/*prefix size=*/ 0, /*hops=*/ zoneRoute.GetHop (), /*dst=*/ dst,
+                                          /*dst seqno=*/ dst == zoneRoute.GetDestination () ? zoneRoute.GetSeqNo () : 0,
+                                          /*origin=*/ toOrigin.GetDestination (),
+                                          /*lifetime=*/ GetIarpHoldTime ());
+  rrepHeader.SetMetric (zoneRoute.GetMetric ());
+  // Zone routes tell the motion of their first link only
+  rrepHeader.SetExpiration (GetLinkExpiration (zoneRoute.GetNextHop ()));
+  toOrigin.InsertPrecursor (zoneRoute.GetNextHop ());
+  m_routingTable2.Update (toOrigin);
+  RequestReplyAck (rrepHeader, toOrigin.GetNextHop ());
+
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (rrepHeader);
+  TypeHeader tHeader (SHINGO_RREP);
+  packet->AddHeader (tHeader);
+  Ptr<Socket> socket = FindSocketWithInterfaceAddress (toOrigin.GetInterface ());
+  NS_ASSERT (socket);
+  SendTo (socket, packet, toOrigin.GetNextHop ());
+
+  // The destination does not see the RREQ: it learns the route back to the origin from a gratuitous RREP
+  RrepHeader gratRepHeader (/*prefix size=*/ 0, /*hops=*/ toOrigin.GetHop (), /*dst=*/ toOrigin.GetDestination (),
+                                             /*dst seqno=*/ toOrigin.GetSeqNo (), /*origin=*/ zoneRoute.GetDestination (),
+                                             /*lifetime=*/ toOrigin.GetLifeTime ());
+  gratRepHeader.SetMetric (toOrigin.GetMetric ());
+  gratRepHeader.SetExpiration (GetRouteExpiration (toOrigin.GetDestination ()));
+  Ptr<Packet> packetToDst = Create<Packet> ();
+  packetToDst->AddHeader (gratRepHeader);
+  TypeHeader type (SHINGO_RREP);
+  packetToDst->AddHeader (type);
+  Ptr<Socket> zoneSocket = FindSocketWithInterfaceAddress (zoneRoute.GetInterface ());
+  NS_ASSERT (zoneSocket);
+  SendTo (zoneSocket, packetToDst, zoneRoute.GetNextHop ());
+}
+
 
 void
 RoutingProtocol::SendTo (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination)
 {
+  TypeHeader tHeader;
+  packet->PeekHeader (tHeader);
+  CountControlBytes (tHeader.Get (), packet->GetSize ());
+  m_txTrace (packet);
+  std::map<Ptr<Socket>, Ipv4InterfaceAddress>::const_iterator j = m_socketAddresses.find (socket);
+  if (destination.IsBroadcast () || (j != m_socketAddresses.end () && destination == j->second.GetBroadcast ()))
+    {
+      // The neighbors refresh this node on any control message, so the next hello can wait
+      m_lastBcastTime = Simulator::Now ();
+    }
   socket->SendTo (packet, 0, InetSocketAddress (destination, MY_PORT));
+}
 
+void
+RoutingProtocol::CountControlBytes (MessageType type, uint32_t size)
+{
+  switch (type)
+    {
+    case SHINGO_IARP:
+    case SHINGO_ZONE_SOLICIT:
+    case SHINGO_NEIGHBOR_SET:
+      {
+        m_zoneRadiusAdaptation.RecordIarp (size);
+        break;
+      }
+    case SHINGO_RREQ:
+      {
+        m_zoneRadiusAdaptation.RecordRreq (size);
+        break;
+      }
+    default:
+      break;
+    }
 }
 
 void
@@ -1896,13 +4895,14 @@ RoutingProtocol::ScheduleRreqRetry (Ipv4Address dst)
   RoutingTableEntry2 rt;
   m_routingTable2.LookupRoute (dst, rt);
   Time retry;
-  if (rt.GetHop () < m_netDiameter)
+  // The hop cap moves with the diameter estimate: the rings below it are the attempts not counted yet
+  if (rt.GetRreqCnt () == 0)
     {
-      retry = 2 * m_nodeTraversalTime * (rt.GetHop () + m_timeoutBuffer);
+      // The RREQ may travel a zone radius further to the destination along the zone routes
+      retry = 2 * m_nodeTraversalTime * (rt.GetHop () + m_zoneRadius + m_timeoutBuffer);
     }
   else
     {
-      NS_ABORT_MSG_UNLESS (rt.GetRreqCnt () > 0, "Unexpected value for GetRreqCount ()");
       uint16_t backoffFactor = rt.GetRreqCnt () - 1;
       NS_LOG_LOGIC ("Applying binary exponential backoff factor " << backoffFactor);
       retry = m_netTraversalTime * (1 << backoffFactor);
@@ -1919,10 +4919,17 @@ RoutingProtocol::RouteRequestTimerExpire (Ipv4Address dst)
   RoutingTableEntry2 toDst;
   if (m_routingTable2.LookupValidRoute (dst, toDst))
     {
+      FinishLocalRepair (dst, true);
       SendPacketFromQueue2 (dst, toDst.GetRoute ());
       NS_LOG_LOGIC ("route to " << dst << " found");
       return;
     }
+  if (m_localRepairStart.find (dst) != m_localRepairStart.end ())
+    {
+      m_addressReqTimer.erase (dst);
+      FinishLocalRepair (dst, false);
+      return;
+    }
   /*
    *  If a route discovery has been attempted RreqRetries times at the maximum TTL without
    *  receiving any RREP, all data packets destined for the corresponding destination SHOULD be
@@ -1930,7 +4937,7 @@ RoutingProtocol::RouteRequestTimerExpire (Ipv4Address dst)
    */
   if (toDst.GetRreqCnt () == m_rreqRetries)
     {
-      NS_LOG_LOGIC ("route discovery to " << dst << " has been attempted RreqRetries (" << m_rreqRetries << ") times with ttl " << m_netDiameter);
+      NS_LOG_LOGIC ("route discovery to " << dst << " has been attempted RreqRetries (" << m_rreqRetries << ") times with ttl " << toDst.GetHop ());
       m_addressReqTimer.erase (dst);
       m_routingTable2.DeleteRoute (dst);
       NS_LOG_DEBUG ("Route not found. Drop all packets with dst " << dst);
@@ -1955,8 +4962,16 @@ RoutingProtocol::RouteRequestTimerExpire (Ipv4Address dst)
 void
 RoutingProtocol::AckTimerExpire (Ipv4Address neighbor, Time blacklistTimeout)
 {
-  NS_LOG_FUNCTION (this);
-  m_routingTable2.MarkLinkAsUnidirectional (neighbor, blacklistTimeout);
+  NS_LOG_FUNCTION (this << neighbor);
+  // A single RREP-ACK lost to a collision says nothing about the link
+  if (++m_replyAckMissCount[neighbor] < m_replyAckMisses)
+    {
+      NS_LOG_DEBUG ("RREP-ACK " << m_replyAckMissCount[neighbor] << " in a row missed from " << neighbor);
+      return;
+    }
+  m_replyAckMissCount.erase (neighbor);
+  m_blacklist.Insert (neighbor, blacklistTimeout);
+  m_multipath.RemoveNextHop (neighbor);
 }
 
 
@@ -2017,7 +5032,39 @@ RoutingProtocol::NotifyInterfaceUp (uint32_t i)
     {
       m_mainAddress = iface.GetLocal ();
     }
+
+  // Allow neighbor manager use this interface for layer 2 feedback if possible
+  Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice> ();
+  if (wifi != 0)
+    {
+      Ptr<WifiMac> mac = wifi->GetMac ();
+      if (mac != 0)
+        {
+          mac->TraceConnectWithoutContext ("TxErrHeader", m_nb.GetTxErrorCallback ());
+          m_nb.AddArpCache (l3->GetInterface (i)->GetArpCache ());
+          // The queue of the frames waiting for the channel, part of the load of the node.
+          // A MAC without a single Txop (e.g. with QoS) leaves the load to the routing buffers.
+          PointerValue txop;
+          if (mac->GetAttributeFailSafe ("Txop", txop) && txop.Get<Txop> () != 0
+              && txop.Get<Txop> ()->GetWifiMacQueue () != 0)
+            {
+              m_macQueues[i] = txop.Get<Txop> ()->GetWifiMacQueue ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("No MAC queue on interface " << i << ", its load is not advertised");
+            }
+        }
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Interface " << i << " is not a WifiNetDevice, its load is not advertised");
+    }
   NS_ASSERT (m_mainAddress != Ipv4Address ());
+  if (EnableZoneSolicit)
+    {
+      ScheduleZoneSolicit ();
+    }
 }
 
 void
@@ -2025,6 +5072,18 @@ RoutingProtocol::NotifyInterfaceDown (uint32_t i)
 {
   Ptr<Ipv4L3Protocol> l3 = m_ipv4->GetObject<Ipv4L3Protocol> ();
   Ptr<NetDevice> dev = l3->GetNetDevice (i);
+  // Disable layer 2 link state monitoring (if possible)
+  Ptr<WifiNetDevice> wifi = dev->GetObject<WifiNetDevice> ();
+  if (wifi != 0)
+    {
+      Ptr<WifiMac> mac = wifi->GetMac ();
+      if (mac != 0)
+        {
+          mac->TraceDisconnectWithoutContext ("TxErrHeader", m_nb.GetTxErrorCallback ());
+          m_nb.DelArpCache (l3->GetInterface (i)->GetArpCache ());
+        }
+    }
+  m_macQueues.erase (i);
   Ptr<Socket> socket = FindSocketWithInterfaceAddress (m_ipv4->GetAddress (i,0));
   NS_ASSERT (socket);
   socket->Close ();
@@ -2137,6 +5196,7 @@ RoutingProtocol::RreqRateLimitTimerExpire ()
 {
   NS_LOG_FUNCTION (this);
   m_rreqCount = 0;
+  m_rerrCount = 0;
   m_rreqRateLimitTimer.Schedule (Seconds (1));
 }
 
@@ -2216,7 +5276,8 @@ RoutingProtocol::SendPacketFromQueue2 (Ipv4Address dst, Ptr<Ipv4Route> route)
     {
       DeferredRouteOutputTag tag;
       Ptr<Packet> p = ConstCast<Packet> (queueEntry.GetPacket ());
-      if (p->RemovePacketTag (tag)
+      bool deferred = p->RemovePacketTag (tag);
+      if (deferred
           && tag.oif != -1
           && tag.oif != m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ()))
         {
@@ -2225,8 +5286,12 @@ RoutingProtocol::SendPacketFromQueue2 (Ipv4Address dst, Ptr<Ipv4Route> route)
         }
       UnicastForwardCallback ucb = queueEntry.GetUnicastForwardCallback ();
       Ipv4Header header = queueEntry.GetIpv4Header ();
-      header.SetSource (route->GetSource ());
-      header.SetTtl (header.GetTtl () + 1); // compensate extra TTL decrement by fake loopback routing
+      // A packet salvaged by a local repair keeps the header it was forwarded with
+      if (deferred)
+        {
+          header.SetSource (route->GetSource ());
+          header.SetTtl (header.GetTtl () + 1); // compensate extra TTL decrement by fake loopback routing
+        }
       ucb (route, p, header);
     }
 }
@@ -6,19 +6,52 @@
 #include "shingo-table.h"
 #include "shingo-neighbor.h"
 #include "shingo-dpd.h"
+#include "shingo-damping.h"
+#include "shingo-hello.h"
+#include "shingo-zone-radius.h"
+#include "shingo-zone-graph.h"
+#include "shingo-query-detection.h"
+#include "shingo-mpr.h"
+#include "shingo-popularity.h"
+#include "shingo-discovery-merge.h"
+#include "shingo-blacklist.h"
+#include "shingo-link-quality.h"
+#include "shingo-link-expiration.h"
+#include "shingo-multipath.h"
 #include "ns3/node.h"
 #include "ns3/random-variable-stream.h"
 #include "ns3/output-stream-wrapper.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-interface.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/traced-callback.h"
 #include <map>
+#include <set>
 
 namespace ns3
 {
+
+class WifiMacQueue;
+
 namespace shingo
 {
 
+/// Protocol maintaining the zone routes
+enum ZoneEngine
+{
+  ZONE_ENGINE_IARP,       ///< DSDV-derived distance vector of RecvIarp
+  ZONE_ENGINE_LINK_STATE  ///< neighbor sets and breadth first search of the zone graph
+};
+
+/// How a RREQ is carried beyond the zone
+enum RreqDissemination
+{
+  RREQ_FLOOD,      ///< every node re-broadcasts the RREQ
+  RREQ_BORDERCAST, ///< the RREQ follows the zone routes to the peripheral nodes
+  RREQ_MPR,        ///< only the multipoint relays of the sender re-broadcast the RREQ
+  RREQ_GOSSIP      ///< a node re-broadcasts the RREQ unless it overheard enough copies
+};
+
 class RoutingProtocol : public Ipv4RoutingProtocol
 {
   public:
@@ -92,6 +125,29 @@ class RoutingProtocol : public Ipv4RoutingProtocol
    * \returns the enable route aggregation (RA) flag
    */
   bool GetEnableRAFlag () const;
+  /**
+   * Get the hop count of a destination in the zone (IARP) table
+   * \param dst the destination address
+   * \returns the hop count, or 0 if dst is not a valid member of the zone
+   */
+  uint32_t GetZoneHopCount (Ipv4Address dst);
+  /**
+   * Get the zone radius currently in use
+   * \returns the zone radius in hops
+   */
+  uint32_t GetZoneRadius () const;
+  /**
+   * Get the periodic update interval currently in use
+   * \returns the periodic update interval
+   */
+  Time GetPeriodicUpdateInterval () const;
+  /**
+   * TracedCallback signature for the end of a local repair
+   * \param [in] dst the destination of the repaired route
+   * \param [in] delay the time from the link break to the end of the repair
+   * \param [in] repaired true if a new route was found
+   */
+  typedef void (* LocalRepairTracedCallback)(Ipv4Address dst, Time delay, bool repaired);
 
   private:
    //経路更新の時間間隔
@@ -150,6 +206,66 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   UnicastForwardCallback m_scb;
   /// Error callback for own packets
   ErrorCallback m_ecb;
+  /// Flag that is used to enable or disable the zone solicit sent on start-up and on interface up
+  bool EnableZoneSolicit;
+  /// Maximum random delay before a zone solicit, or the zone table answering it, is sent
+  Time m_zoneSolicitJitter;
+  /// Neighbors whose zone solicit is answered when m_zoneReplyTimer expires
+  std::set<Ipv4Address> m_zoneSolicitors;
+  /// Zone radius in hops currently in use; 0 means pure reactive routing
+  uint32_t m_zoneRadius;
+  /// Flag that is used to enable or disable the adaptation of the zone radius
+  bool EnableAdaptiveZoneRadius;
+  /// Smallest zone radius the adaptation may choose
+  uint32_t m_minZoneRadius;
+  /// Largest zone radius the adaptation may choose
+  uint32_t m_maxZoneRadius;
+  /// Time over which the control load is measured before the zone radius is adapted
+  Time m_zoneRadiusAdaptInterval;
+  /// Ratio between IARP and RREQ bytes beyond which the zone radius changes
+  double m_zoneRadiusAdaptRatio;
+  /// Zone radius chosen from the IARP and RREQ bytes sent and received since the last adaptation
+  ZoneRadiusAdaptation m_zoneRadiusAdaptation;
+  /// Flag that is used to enable or disable the adaptation of the periodic update interval to the churn
+  bool EnableAdaptiveUpdateInterval;
+  /// Shortest periodic update interval the adaptation may choose
+  Time m_minPeriodicUpdateInterval;
+  /// Longest periodic update interval the adaptation may choose
+  Time m_maxPeriodicUpdateInterval;
+  /// Smallest Holdtimes the adaptation may choose
+  uint32_t m_minHoldtimes;
+  /// Largest Holdtimes the adaptation may choose
+  uint32_t m_maxHoldtimes;
+  /// Zone changes per update interval from which the node speeds its updates up
+  uint32_t m_churnThreshold;
+  /// Zone members added, changed or lost, neighbors included, since the last periodic update
+  uint32_t m_zoneChanges;
+  /// Minimum time between two triggered updates
+  Time m_minTriggeredUpdateInterval;
+  /// Earliest time the next triggered update may be sent
+  Time m_nextTriggeredUpdate;
+  /// Flag that is used to enable or disable the damping of flapping routes in the triggered updates
+  bool EnableFlapDamping;
+  /// Half-life of the flap penalty
+  Time m_flapHalfLife;
+  /// Flap penalty above which the changes of a route are left to the periodic updates
+  double m_flapSuppressThreshold;
+  /// Flap penalty below which a suppressed route is triggered again
+  double m_flapReuseThreshold;
+  /// Flap penalties of the zone destinations
+  FlapDamping m_flapDamping;
+  /// Protocol maintaining the zone routes
+  ZoneEngine m_zoneEngine;
+  /// Interval between two neighbor sets of the link-state zone engine
+  Time m_neighborSetInterval;
+  /// Time a neighbor, or the neighbor set of a zone member, is kept without being heard again
+  Time m_neighborHoldTime;
+  /// Sequence number of the own neighbor set
+  uint32_t m_neighborSetSeqNo;
+  /// Neighbors heard directly and the time they expire
+  std::map<Ipv4Address, Time> m_zoneNeighbors;
+  /// Zone topology of the link-state zone engine
+  ZoneGraph m_zoneGraph;
 
 /***********************IERP******************************/
   /// Routing table
@@ -166,6 +282,120 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   /// Number of RREQs used for RREQ rate control
   uint16_t m_rreqCount;
 
+  uint16_t m_rerrRateLimit;           ///< Maximum number of RERR per second.
+
+  /// Number of RERRs used for RERR rate control
+  uint16_t m_rerrCount;
+
+  /// Flag that is used to enable or disable the route errors sent on link breaks
+  bool EnableRouteErrors;
+
+  /// Flag that is used to enable or disable the local repair of the routes of the other nodes
+  bool EnableLocalRepair;
+
+  uint16_t m_maxRepairTtl;            ///< Largest TTL of a local repair RREQ before LocalAddTtl.
+
+  uint16_t m_localAddTtl;             ///< TTL added to a local repair RREQ.
+
+  /// Start of the local repairs in progress, by destination
+  std::map<Ipv4Address, Time> m_localRepairStart;
+
+  /// Precursors of the routes under local repair, by destination
+  std::map<Ipv4Address, std::vector<Ipv4Address> > m_localRepairPrecursors;
+
+  /// Flag that is used to enable or disable the hello messages
+  bool EnableHello;
+
+  Time m_helloInterval;               ///< Initial interval between two hello messages.
+
+  Time m_minHelloInterval;            ///< Shortest hello interval the adaptation may choose.
+
+  Time m_maxHelloInterval;            ///< Longest hello interval the adaptation may choose.
+
+  uint16_t m_allowedHelloLoss;        ///< Number of hello messages which may be lost for a valid link.
+
+  uint32_t m_helloChurnThreshold;     ///< Neighbor changes per hello interval from which the interval is halved.
+
+  /// Hello interval adapted to the neighbors opened or lost since the hello timer last expired
+  HelloSchedule m_helloSchedule;
+
+  /// Neighbor lifetime advertised by the last hello of every neighbor
+  std::map<Ipv4Address, Time> m_helloLifetimes;
+
+  /// Flag that is used to select the zone and IERP routes by their ETX metric instead of their hop count
+  bool EnableLinkQuality;
+
+  Time m_linkQualityWindow;           ///< Span of the window the delivery ratio of a link is measured over.
+
+  double m_metricHysteresis;          ///< Fraction by which a path metric must beat the current one to replace it.
+
+  /// Delivery ratio of the links to the neighbors
+  LinkQuality m_linkQuality;
+
+  /// Last RREQ id processed of every origin and the best metric it came with
+  std::map<Ipv4Address, std::pair<uint32_t, uint16_t> > m_rreqBestMetric;
+
+  /// Flag that is used to predict the link breaks from the motion the hellos advertise
+  bool EnableLinkExpiration;
+
+  double m_transmissionRange;         ///< Transmission range the link breaks are predicted for, in meters.
+
+  Time m_linkExpirationGuard;         ///< Time before the predicted break of its route the source looks for a new one.
+
+  /// Motion of the neighbors
+  LinkExpiration m_linkExpiration;
+
+  /// Velocity advertised by the last hello
+  Vector m_advertisedVelocity;
+
+  /// Time the first link to break of every IERP route is predicted to break
+  std::map<Ipv4Address, Time> m_routeExpiration;
+
+  /// Timers looking for a new route to the destinations of this node before their predicted break
+  std::map<Ipv4Address, Timer> m_routeExpirationTimer;
+
+  /// Destinations whose next RREQ looks for a new route while the current one stays in use
+  std::set<Ipv4Address> m_routeRefresh;
+
+  /// Flag that is used to refresh the IERP routes of the active flows of this node before they expire
+  bool EnableRouteRefresh;
+
+  Time m_routeRefreshLead;            ///< Time before its route expires an active flow looks for a new one.
+
+  Time m_activeFlowTimeout;           ///< Time after its last packet a flow of this node stays active.
+
+  /// Last packet this node sent over the IERP route to every destination
+  std::map<Ipv4Address, Time> m_lastRouteUse;
+
+  /// Last refresh of the IERP route to every destination
+  std::map<Ipv4Address, Time> m_lastRouteRefresh;
+
+  /// Timers refreshing the IERP routes of the active flows before they expire
+  std::map<Ipv4Address, Timer> m_routeRefreshTimer;
+
+  /// Flag that is used to keep several paths per destination and spread the flows over them
+  bool EnableMultipath;
+
+  uint32_t m_maxPaths;                ///< Maximum number of paths kept per destination.
+
+  /// Equally short zone paths besides the ones of the zone table
+  MultipathTable m_zoneMultipath;
+
+  /// Link disjoint IERP paths besides the ones of the IERP table
+  MultipathTable m_multipath;
+
+  /// Flag that is used to steer the routes and the route discoveries around busy nodes
+  bool EnableLoadBalancing;
+
+  double m_loadWeight;                ///< Number of links a neighbor with full queues adds to the link metric.
+  Time m_maxLoadDelay;                ///< RREQ re-broadcast delay of a node with full queues.
+
+  /// Load advertised by every neighbor in its last IARP update
+  std::map<Ipv4Address, uint8_t> m_neighborLoad;
+
+  /// MAC queue of every wifi interface
+  std::map<uint32_t, Ptr<WifiMacQueue> > m_macQueues;
+
   /// Request sequence number
   uint32_t m_seqNo;
 
@@ -175,6 +405,60 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   /// Handle duplicated RREQ
   IdCache m_rreqIdCache;
 
+  /// Relayers heard per RREQ
+  QueryDetectionCache m_queryDetection;
+
+  /// Flag that is used to enable or disable dropping the RREQ relays into zones the query already covered
+  bool EnableQueryDetection;
+
+  /// Flag that is used to enable or disable the RREPs of the nodes having the destination in their zone
+  bool EnableProxyReply;
+
+  /// How a RREQ is carried beyond the zone
+  RreqDissemination m_rreqDissemination;
+
+  /// Multipoint relays selected from the two-hop zone
+  MprSelection m_mprSelection;
+
+  /// RREQs re-broadcast as a multipoint relay
+  IdCache m_mprRelayCache;
+
+  /// Maximum random delay during which a gossiping node counts the copies of a RREQ
+  Time m_gossipAssessmentDelay;
+
+  /// Copies of a RREQ heard from which a gossiping node does not re-broadcast it
+  uint32_t m_gossipCounterThreshold;
+
+  /// Neighbors beyond which a gossiping node re-broadcasts with a probability falling with its neighbor count; 0 disables
+  uint32_t m_gossipNeighbors;
+
+  /// Popularity of the destinations of the RREQs, RREPs and data packets seen
+  DestinationPopularity m_popularity;
+
+  /// Flag that is used to enable or disable keeping the routes to the hot destinations to answer RREQs
+  bool EnableRouteCache;
+
+  /// Number of destinations whose routes are kept as hot at once
+  uint32_t m_routeCacheSize;
+
+  /// Half-life of the popularity of a destination
+  Time m_popularityHalfLife;
+
+  /// Lifetime given to a route to a hot destination each time it is learnt or used
+  Time m_hotRouteTimeout;
+
+  /// Remaining lifetime a route needs for this node to answer a RREQ with it
+  Time m_cachedReplyMinLifetime;
+
+  /// Route discoveries relayed by this node and the RREQs waiting for their RREP
+  DiscoveryMerge m_discoveryMerge;
+
+  /// Flag that is used to enable or disable holding the RREQs for a destination another discovery looks for
+  bool EnableRequestMerging;
+
+  /// Time a relayed discovery holds the RREQs of the other origins for the same destination
+  Time m_requestMergeTime;
+
   uint16_t m_ttlStart;                ///< Initial TTL value for RREQ.
 
   uint16_t m_ttlIncrement;            ///< TTL increment for each attempt using the expanding ring search for RREQ dissemination.
@@ -182,6 +466,44 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   uint16_t m_ttlThreshold;            ///< Maximum TTL value for expanding ring search, TTL = NetDiameter is used beyond this value.
 
   uint32_t m_netDiameter;             ///< Net diameter measures the maximum possible number of hops between two nodes in the network
+
+  bool m_zoneRing;                    ///< Start the expanding ring search beyond the zone and grow it by zone diameters
+
+  Time m_diameterWindow;              ///< Period over which the largest hop count seen is kept
+
+  Time m_diameterWindowStart;         ///< Start of the current diameter window
+
+  uint32_t m_diameterEstimate;        ///< Largest hop count seen in the current diameter window
+
+  uint32_t m_lastDiameterEstimate;    ///< Largest hop count seen in the previous diameter window
+
+  Ipv4Address m_sink;                 ///< Sink of the collection tree, none disables the tree
+
+  Time m_sinkBeaconInterval;          ///< Interval between two beacons of the sink
+
+  uint32_t m_sinkHysteresis;          ///< Hops by which a neighbor must beat the parent to replace it
+
+  uint32_t m_sinkSeqNo;               ///< Latest beacon sequence number sent or heard
+
+  Ipv4Address m_sinkParent;           ///< Neighbor toward the sink
+
+  uint32_t m_sinkHop;                 ///< Hops to the sink through the parent
+
+  std::map<Ipv4Address, uint32_t> m_sinkOffers; ///< Hops to the sink through each neighbor heard forwarding the latest beacon
+
+  Ipv4Address m_sinkReceiver;         ///< Interface the latest beacon was first received on
+
+  Ipv4Address m_anycastGroup;         ///< Anycast group address, none disables anycast
+
+  std::string m_anycastMemberList;    ///< Space separated addresses of the members of the anycast group
+
+  std::set<Ipv4Address> m_anycastMembers; ///< Members of the anycast group
+
+  std::vector<Ipv4Address> m_requestBatch; ///< Destinations waiting to share the next RREQ
+
+  Time m_rreqBatchDelay;              ///< Time a RREQ waits for other destinations to share it
+
+  uint32_t m_maxRreqDestinations;     ///< Maximum number of destinations of a RREQ, 1 disables the batching
   uint16_t m_timeoutBuffer;           ///< Provide a buffer for the timeout.
 
   Time m_nodeTraversalTime;
@@ -197,6 +519,20 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   Time m_nextHopWait;                  ///< Period of our waiting for the neighbour's RREP_ACK
   Time m_blackListTimeout;             ///< Time for which the node is put into the blacklist
 
+  /// Flag that is used to enable or disable the RREP-ACKs detecting the unidirectional links
+  bool EnableReplyAck;
+
+  uint32_t m_replyAckMisses;           ///< Number of RREP-ACKs in a row a neighbor misses before it is blacklisted.
+
+  /// RREP-ACKs in a row every neighbor missed
+  std::map<Ipv4Address, uint32_t> m_replyAckMissCount;
+
+  /// Timers waiting for the RREP_ACK of a neighbor
+  std::map<Ipv4Address, Timer> m_replyAckTimer;
+
+  /// Neighbors over unidirectional links, shared by IERP and the zone engine
+  LinkBlacklist m_blacklist;
+
   bool m_destinationOnly;              ///< Indicates only the destination may respond to this RREQ.
 
   bool m_gratuitousReply;              ///< Indicates whether a gratuitous RREP should be unicast to the node
@@ -285,17 +621,206 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   /// Receive RREQ
   void RecvRequest (Ptr<Packet> p, Ipv4Address receiver, Ipv4Address src);
 
+  /**
+   * Relay a RREQ unless query detection finds the zone already covered
+   * \param socket the socket to send on
+   * \param packet the RREQ
+   * \param destination the broadcast address
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   */
+  void RelayRequest (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination, Ipv4Address origin, uint32_t id);
+  /**
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   * \returns true if every peripheral zone member lies within the zone of a node heard relaying the RREQ
+   */
+  bool IsQueryCovered (Ipv4Address origin, uint32_t id);
+  /**
+   * Bordercast a RREQ to the peripheral nodes not yet covered by the query,
+   * or broadcast it if the zone has no peripheral node
+   * \param socket the socket to send on
+   * \param rreqHeader the RREQ
+   * \param destination the broadcast address
+   */
+  void Bordercast (Ptr<Socket> socket, RreqHeader rreqHeader, Ipv4Address destination);
+  /**
+   * Forward a bordercast one hop further toward the targets this node reaches
+   * \param socket the socket to send on
+   * \param rreqHeader the RREQ
+   * \param bordercastHeader the bordercast tree the RREQ was received with
+   * \param destination the broadcast address
+   */
+  void RelayBordercast (Ptr<Socket> socket, RreqHeader rreqHeader, BordercastHeader bordercastHeader, Ipv4Address destination);
+  /**
+   * \returns the multipoint relays selected from the one and two-hop zone members
+   */
+  std::set<Ipv4Address> const & GetMprs ();
+  /**
+   * Broadcast a RREQ listing the multipoint relays that are to re-broadcast it,
+   * unless query detection finds the zone already covered
+   * \param socket the socket to send on
+   * \param rreqHeader the RREQ
+   * \param destination the broadcast address
+   */
+  void SendRequestToMprs (Ptr<Socket> socket, RreqHeader rreqHeader, Ipv4Address destination);
+  /**
+   * Rewrite a received RREQ for relaying: one more hop, and the path metric and first relay up to this node
+   * \param rreqHeader the RREQ
+   * \param metric the path metric from the origin to this node
+   * \param firstHop the first relay of the RREQ
+   * \returns the new hop count
+   */
+  uint8_t AdvanceRequest (RreqHeader & rreqHeader, uint16_t metric, Ipv4Address firstHop);
+  /**
+   * Re-broadcast a relayed RREQ to the multipoint relays of this node on every interface,
+   * after the jitter and the load delay
+   * \param rreqHeader the RREQ, already rewritten for relaying
+   */
+  void RelayRequestToMprs (RreqHeader const & rreqHeader);
+  /**
+   * Re-broadcast a RREQ at the end of its assessment delay, unless enough copies were heard meanwhile
+   * \param socket the socket to send on
+   * \param packet the RREQ
+   * \param destination the broadcast address
+   * \param origin the RREQ origin
+   * \param id the RREQ ID
+   */
+  void GossipRequest (Ptr<Socket> socket, Ptr<Packet> packet, Ipv4Address destination, Ipv4Address origin, uint32_t id);
+  /**
+   * Account the hop count of a RREQ or RREP in the network diameter estimate
+   * \param hops the hops travelled
+   */
+  void ObserveHopCount (uint32_t hops);
+  /**
+   * \returns the hops a RREQ may travel: the largest hop count seen in the last two
+   * diameter windows, at least TtlThreshold, plus a zone diameter, bounded by NetDiameter
+   */
+  uint32_t GetHopCap ();
+  /**
+   * Flood a new beacon at the sink, or at any other node pick the parent among the
+   * neighbors heard forwarding the latest beacon and forward it
+   */
+  void SinkBeaconTimerExpire ();
+  /**
+   * Receive a beacon of the collection tree
+   * \param packet the packet holding the beacon
+   * \param receiver the address of the receiving interface
+   * \param sender the neighbor the packet came from
+   */
+  void RecvSinkBeacon (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender);
+  /**
+   * Point the route to the sink at a parent
+   * \param parent the neighbor toward the sink
+   * \param hop the hops to the sink through the parent
+   */
+  void SetSinkParent (Ipv4Address parent, uint32_t hop);
+  /**
+   * Keep a neighbor closer to the sink than this node as a path to the sink besides the parent
+   * \param neighbor the neighbor
+   * \param hop the hops to the sink through the neighbor
+   */
+  void AddSinkPath (Ipv4Address neighbor, uint32_t hop);
+  /**
+   * Broadcast the latest beacon
+   * \param hop the hops from the sink of this node
+   */
+  void SendSinkBeacon (uint32_t hop);
+  /**
+   * \param dst the destination address
+   * \returns true if dst is the anycast group and this node is one of its members
+   */
+  bool IsAnycastMember (Ipv4Address dst);
+  /**
+   * \param rreqHeader the RREQ
+   * \returns true if this node is one of the destinations of the RREQ
+   */
+  bool IsRequestedDestination (RreqHeader const & rreqHeader);
+  /**
+   * Look up the zone route to a destination; the anycast group resolves to its nearest member in the zone
+   * \param dst the destination address
+   * \param rt the zone routing table entry found
+   * \returns true if a route was found
+   */
+  bool LookupZoneRoute (Ipv4Address dst, RoutingTableEntry & rt);
+
   /// Receive RREP
   void RecvReply (Ptr<Packet> p, Ipv4Address my,Ipv4Address src);
   /// Receive RREP_ACK
   void RecvReplyAck (Ipv4Address neighbor);
+  /// Receive RERR from node with address src
+  void RecvError (Ptr<Packet> p, Ipv4Address src);
+  /**
+   * Buffer a data packet to forward while its route is repaired locally
+   * \param p the packet
+   * \param header the IP header of the packet
+   * \param ucb the unicast forward callback
+   * \param ecb the error callback
+   * \param toDst the invalid route to the destination of the packet
+   * \returns true if the packet was buffered
+   */
+  bool SalvagePacket (Ptr<const Packet> p, const Ipv4Header & header,
+                      UnicastForwardCallback ucb, ErrorCallback ecb, RoutingTableEntry2 const & toDst);
+  /**
+   * \param toDst the broken route
+   * \returns the TTL of the RREQ repairing the route, 0 if the destination is too far to repair it locally
+   */
+  uint16_t GetRepairTtl (RoutingTableEntry2 const & toDst) const;
+  /**
+   * Start a small ring RREQ for a broken route of the other nodes, unless one runs already
+   * \param toDst the broken route, precursors included
+   * \returns true if the route is under repair
+   */
+  bool StartLocalRepair (RoutingTableEntry2 const & toDst);
+  /**
+   * End a local repair: restore the precursors, or drop the buffered packets and send the RERR
+   * \param dst the destination of the route
+   * \param repaired whether a new route was found
+   */
+  void FinishLocalRepair (Ipv4Address dst, bool repaired);
 
   /// Send packet
   void
   Send (Ptr<Ipv4Route>, Ptr<const Packet>, const Ipv4Header &);
 
-  /// Send RREQ
+  /// Send RREQ, shared with the other destinations asked for within RreqBatchDelay
   void SendRequest (Ipv4Address dst);
+  /// Send one RREQ for all the destinations waiting in the batch
+  void SendBatchedRequest ();
+  /**
+   * Send the RREQ of a local repair on its own, with the small ring of the repair
+   * \param dst the destination of the broken route
+   */
+  void SendRepairRequest (Ipv4Address dst);
+  /**
+   * Originate a RREQ and start the discovery of its destinations
+   * \param batch the destinations, the main one first
+   * \param ttl the ring of the RREQ
+   */
+  void OriginateRequest (std::vector<Ipv4Address> const & batch, uint16_t ttl);
+  /**
+   * Answer a RREQ for its main destination
+   * \param rreqHeader the RREQ; the destination sequence number is raised to the one known here
+   * \param src the neighbor the RREQ came from
+   * \returns true if the RREQ must not go on for this destination: a RREP was sent, or the RREQ came back
+   */
+  bool ReplyToRequest (RreqHeader & rreqHeader, Ipv4Address src);
+  /**
+   * Re-broadcast a RREQ with the configured dissemination
+   * \param rreqHeader the RREQ, hop count and TTL already updated
+   * \param mprRelay whether this node is a multipoint relay of the sender
+   */
+  void BroadcastRequest (RreqHeader const & rreqHeader, bool mprRelay);
+  /**
+   * Re-broadcast the RREQs held for dst if no RREP answered them
+   * \param dst the destination of the discovery
+   */
+  void ReleaseHeldRequests (Ipv4Address dst);
+  /**
+   * Copy a RREP along the reverse routes of the RREQs held for its destination
+   * \param rrepHeader the RREP, hop count already updated
+   */
+  void AnswerHeldRequests (RrepHeader const & rrepHeader);
 
 /// Send RREP
   void SendReply (RreqHeader const & rreqHeader, RoutingTableEntry2 const & toOrigin);
@@ -305,9 +830,162 @@ class RoutingProtocol : public Ipv4RoutingProtocol
    * \param gratRep indicates whether a gratuitous RREP should be unicast to destination
    */
   void SendReplyByIntermediateNode (RoutingTableEntry2 & toDst, RoutingTableEntry2 & toOrigin, bool gratRep);
+  /** Send RREP on behalf of a destination in the zone, and a gratuitous RREP to the destination
+   * \param dst the destination of the RREQ, the zone route destination or the anycast group
+   * \param zoneRoute zone routing table entry to destination
+   * \param toOrigin routing table entry to originator
+   */
+  void SendProxyReply (Ipv4Address dst, RoutingTableEntry const & zoneRoute, RoutingTableEntry2 & toOrigin);
   
-  /// Send RREP_ACK
-  void SendReplyAck (Ipv4Address neighbor);
+  /**
+   * Send RREP_ACK
+   * \param neighbor the neighbor the RREP came from
+   * \param receiver the address of the interface the RREP came on
+   */
+  void SendReplyAck (Ipv4Address neighbor, Ipv4Address receiver);
+  /**
+   * Ask the next hop of a RREP toward the origin for a RREP_ACK, blacklisting it if none comes
+   * \param rrepHeader the RREP to send
+   * \param neighbor the next hop the RREP is sent to
+   */
+  void RequestReplyAck (RrepHeader & rrepHeader, Ipv4Address neighbor);
+  /**
+   * Initiate RERR: invalidate the routes through a broken link and tell their precursors
+   * \param nextHop the neighbor the link to which broke
+   */
+  void SendRerrWhenBreaksLinkToNextHop (Ipv4Address nextHop);
+  /**
+   * Forward RERR
+   * \param packet the RERR packet
+   * \param precursors the precursors of the unreachable destinations
+   */
+  void SendRerrMessage (Ptr<Packet> packet, std::vector<Ipv4Address> precursors);
+  /**
+   * Send RERR toward the origin of a data packet this node has no route to forward
+   * \param dst the destination of the data packet
+   * \param dstSeqNo the last known sequence number of dst, 0 if none
+   * \param origin the origin of the data packet
+   */
+  void SendRerrWhenNoRouteToForward (Ipv4Address dst, uint32_t dstSeqNo, Ipv4Address origin);
+  /**
+   * Handle the loss of a neighbor: break the zone routes and the IERP routes through it
+   * \param neighbor the neighbor the link to which broke
+   */
+  void HandleLinkFailure (Ipv4Address neighbor);
+  /**
+   * Withdraw the zone routes through a lost neighbor, as an IARP update with infinite metric would
+   * \param neighbor the lost neighbor
+   */
+  void BreakZoneLink (Ipv4Address neighbor);
+
+  /// Send a hello, a RREP to itself, unless another control broadcast made it needless
+  void HelloTimerExpire ();
+  /// Broadcast a hello on every interface
+  void SendHello ();
+  /**
+   * Refresh the neighbor and its one-hop zone entry from its hello
+   * \param rrepHeader the hello
+   * \param receiver the address of the receiving interface
+   */
+  void ProcessHello (RrepHeader const & rrepHeader, Ipv4Address receiver);
+  /**
+   * \param neighbor the neighbor heard
+   * \returns the time a neighbor is kept open after any control message from it
+   */
+  Time GetNeighborLifetime (Ipv4Address neighbor) const;
+  /**
+   * \param neighbor the neighbor heard
+   * \returns the interval the neighbor broadcasts at least once in
+   */
+  Time GetProbeInterval (Ipv4Address neighbor) const;
+  /**
+   * \param neighbor the neighbor
+   * \returns the cost of the link to the neighbor, that of a perfect link if link quality is disabled,
+   * plus the load of the neighbor if load balancing is enabled
+   */
+  uint16_t GetLinkMetric (Ipv4Address neighbor);
+  /**
+   * \returns how full the fuller of the MAC queues and the routing buffers is, from 0 (empty) to 255 (full)
+   */
+  uint8_t GetLocalLoad ();
+  /**
+   * \returns the delay a RREQ re-broadcast takes on top of the jitter, zero if load balancing is disabled
+   */
+  Time GetLoadDelay ();
+  /**
+   * Compare two paths to a destination
+   * \param hops the hop count of the new path
+   * \param metric the metric of the new path
+   * \param curHops the hop count of the current path
+   * \param curMetric the metric of the current path
+   * \returns true if the new path replaces the current one
+   */
+  bool IsBetterPath (uint16_t hops, uint16_t metric, uint16_t curHops, uint16_t curMetric) const;
+  /**
+   * \param neighbor the neighbor
+   * \returns the time left until the link to the neighbor is predicted to break, Time::Max () if unknown
+   */
+  Time GetLinkExpiration (Ipv4Address neighbor) const;
+  /**
+   * \param dst the destination
+   * \returns the time left until the IERP route to dst is predicted to break, Time::Max () if unknown
+   */
+  Time GetRouteExpiration (Ipv4Address dst) const;
+  /**
+   * Cap the lifetime of an IERP route at the predicted break of its first link to break
+   * \param dst the destination
+   * \param nextHop the next hop the prediction holds for
+   * \param expiration the time left until the route breaks
+   */
+  void RecordRouteExpiration (Ipv4Address dst, Ipv4Address nextHop, Time expiration);
+  /**
+   * Look for a new route before the predicted break of the route of this node
+   * \param dst the destination
+   */
+  void RouteExpirationTimerExpire (Ipv4Address dst);
+  /**
+   * Send a RREQ for a destination while its valid route stays in use
+   * \param dst the destination
+   */
+  void RefreshRoute (Ipv4Address dst);
+  /**
+   * Check the IERP route of a flow of this node shortly before it expires
+   * \param dst the destination
+   */
+  void ScheduleRouteRefresh (Ipv4Address dst);
+  /**
+   * Refresh the IERP route of a flow of this node that is about to expire, if the flow is active
+   * \param dst the destination
+   */
+  void RouteRefreshTimerExpire (Ipv4Address dst);
+  /**
+   * \param p the packet, starting with its transport header
+   * \param header the IP header
+   * \returns the hash of the flow of the packet
+   */
+  uint32_t GetFlowHash (Ptr<const Packet> p, Ipv4Header const & header) const;
+  /**
+   * Send a flow over one of the paths to its destination
+   * \param route the route of the primary path
+   * \param dst the destination
+   * \param flow the hash of the flow
+   * \param zone true for a zone route, false for an IERP route
+   * \returns the route of the path the flow is sent over
+   */
+  Ptr<Ipv4Route> SelectPath (Ptr<Ipv4Route> route, Ipv4Address dst, uint32_t flow, bool zone);
+  /**
+   * Keep the path a duplicate RREQ came over to its origin, and answer it at the destination
+   * \param rreqHeader the RREQ
+   * \param src the neighbor the copy came from
+   * \param firstHop the first node the copy reached from the origin
+   * \param metric the metric of the path the copy came over
+   */
+  void AddReversePath (RreqHeader const & rreqHeader, Ipv4Address src, Ipv4Address firstHop, uint16_t metric);
+  /**
+   * Move the IERP routes through a lost neighbor to their best other path
+   * \param neighbor the lost neighbor
+   */
+  void FailOverPaths (Ipv4Address neighbor);
 
   /**
    * Send packet to destination scoket
@@ -354,17 +1032,86 @@ class RoutingProtocol : public Ipv4RoutingProtocol
   /// Merge periodic updates
   void
   MergeTriggerPeriodicUpdates ();
+  /// Schedule a zone solicit unless one is already pending
+  void
+  ScheduleZoneSolicit ();
+  /// Broadcast a zone solicit carrying the own IARP entry
+  void
+  SendZoneSolicit ();
+  /**
+   * Receive a zone solicit
+   * \param packet the packet holding the solicitor's own IARP entry
+   * \param receiver the address of the receiving interface
+   * \param sender the solicitor
+   */
+  void
+  RecvZoneSolicit (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender);
+  /// Answer the pending zone solicits with the zone table
+  void
+  SendZoneReply ();
+  /// Adapt the zone radius to the control load measured since the last call
+  void
+  AdaptZoneRadius ();
+  /**
+   * Change the zone radius, dropping the members beyond a smaller radius
+   * \param radius the new zone radius
+   */
+  void
+  SetZoneRadius (uint32_t radius);
+  /**
+   * Send the pending zone changes with the coalescing triggered update timer
+   * \param delay the delay wanted by the caller, stretched to the minimum triggered update interval
+   */
+  void
+  ScheduleTriggeredUpdate (Time delay);
+  /// Send the own neighbor set, flooded to ZoneRadius - 1 hops
+  void
+  SendNeighborSet ();
+  /**
+   * Receive a neighbor set, relaying it while it has hops left
+   * \param packet the packet holding the neighbor set
+   * \param receiver the address of the receiving interface
+   * \param sender the neighbor the packet came from
+   */
+  void
+  RecvNeighborSet (Ptr<Packet> packet, Ipv4Address receiver, Ipv4Address sender);
+  /**
+   * Drop the expired neighbors and store the own neighbor set in the zone graph
+   * \returns true if the own neighbor set changed
+   */
+  bool
+  UpdateOwnNeighborSet ();
+  /// Recompute the zone routes from the zone graph and apply the differences to the zone table
+  void
+  UpdateZoneRoutes ();
+  /// Adapt the periodic update interval and Holdtimes to the zone changes seen since the last periodic update
+  void
+  AdaptPeriodicUpdateInterval ();
+  /**
+   * Get the hold time advertised with the IARP updates
+   * \returns Holdtimes times the periodic update interval
+   */
+  Time
+  GetIarpHoldTime () const;
+  /**
+   * Account the bytes of a control packet sent or received
+   * \param type the message type
+   * \param size the packet size
+   */
+  void
+  CountControlBytes (MessageType type, uint32_t size);
   /// Notify that packet is dropped for some reason
   void
   Drop (Ptr<const Packet>, const Ipv4Header &, Socket::SocketErrno);
 
   /// RREQ rate limit timer
   Timer m_rreqRateLimitTimer;
-  /// Reset RREQ count and schedule RREQ rate limit timer with delay 1 sec.
+  /// Reset RREQ and RERR counts and schedule RREQ rate limit timer with delay 1 sec.
   void RreqRateLimitTimerExpire ();
 
   /**
-   * Mark link to neighbor node as unidirectional for blacklistTimeout
+   * Count a missed RREP-ACK; after ReplyAckMisses in a row, mark link to neighbor
+   * node as unidirectional for blacklistTimeout, for IERP and the zone engine alike
    *
    * \param neighbor the IP address of the neightbor node
    * \param blacklistTimeout the black list timeout time
@@ -373,8 +1120,28 @@ class RoutingProtocol : public Ipv4RoutingProtocol
 
   /// Timer to trigger periodic updates from a node
   Timer m_periodicUpdateTimer;
-  /// Timer used by the trigger updates in case of Weighted Settling Time is used
+  /// Timer coalescing all the pending triggered updates into one
   Timer m_triggeredExpireTimer;
+  /// Timer to send the zone solicit
+  Timer m_zoneSolicitTimer;
+  /// Timer to answer the zone solicits received during the reply jitter
+  Timer m_zoneReplyTimer;
+  /// Timer to adapt the zone radius
+  Timer m_zoneRadiusTimer;
+  /// Timer to send the neighbor set of the link-state zone engine
+  Timer m_neighborSetTimer;
+  /// Timer to send or forward the beacons of the collection tree
+  Timer m_sinkBeaconTimer;
+  /// Timer to send the RREQ shared by the destinations of the batch
+  Timer m_rreqBatchTimer;
+  /// Timer to send the hello messages
+  Timer m_helloTimer;
+  /// Trace of the control packets sent
+  TracedCallback<Ptr<const Packet> > m_txTrace;
+  /// Trace of the control packets received
+  TracedCallback<Ptr<const Packet> > m_rxTrace;
+  /// Trace of the local repairs ended
+  TracedCallback<Ipv4Address, Time, bool> m_localRepairTrace;
 
   /// Keep track of the last bcast time
   Time m_lastBcastTime;
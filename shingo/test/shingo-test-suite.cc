@@ -2,6 +2,22 @@
 
 // Include a header file from your module to test.
 #include "ns3/shingo.h"
+#include "ns3/shingo-damping.h"
+#include "ns3/shingo-hello.h"
+#include "ns3/shingo-zone-radius.h"
+#include "ns3/shingo-table.h"
+#include "ns3/shingo-zone-graph.h"
+#include "ns3/shingo-query-detection.h"
+#include "ns3/shingo-mpr.h"
+#include "ns3/shingo-popularity.h"
+#include "ns3/shingo-discovery-merge.h"
+#include "ns3/shingo-blacklist.h"
+#include "ns3/shingo-link-quality.h"
+#include "ns3/shingo-link-expiration.h"
+#include "ns3/shingo-multipath.h"
+#include "ns3/shingo-packet.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +62,908 @@ ShingoTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Flap damping: suppression above the threshold, half-life decay and reuse
+class FlapDampingTestCase : public TestCase
+{
+public:
+  FlapDampingTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the penalty after one half-life
+  void CheckHalfLife ();
+  /// Check that the route is reused once the reuse delay has elapsed
+  void CheckReuse ();
+
+  shingo::FlapDamping m_damping;
+  Ipv4Address m_dst;
+};
+
+FlapDampingTestCase::FlapDampingTestCase ()
+  : TestCase ("Shingo route flap damping"),
+    m_damping (Seconds (15), 2000, 750),
+    m_dst ("10.0.0.1")
+{
+}
+
+void
+FlapDampingTestCase::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_damping.IsSuppressed (m_dst), false, "Unknown destination is suppressed");
+  NS_TEST_EXPECT_MSG_EQ (m_damping.RecordFlap (m_dst), false, "Suppressed after one flap");
+  NS_TEST_EXPECT_MSG_EQ (m_damping.RecordFlap (m_dst), false, "Suppressed at the threshold");
+  NS_TEST_EXPECT_MSG_EQ (m_damping.RecordFlap (m_dst), true, "Not suppressed above the threshold");
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_damping.GetPenalty (m_dst), 3000, 1e-6, "Wrong penalty");
+  // 3000 decays to 750 in two half-lives
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_damping.GetReuseDelay (m_dst).GetSeconds (), 30, 0.01, "Wrong reuse delay");
+  Simulator::Schedule (Seconds (15), &FlapDampingTestCase::CheckHalfLife, this);
+  Simulator::Schedule (m_damping.GetReuseDelay (m_dst), &FlapDampingTestCase::CheckReuse, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+FlapDampingTestCase::CheckHalfLife ()
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_damping.GetPenalty (m_dst), 1500, 1e-6, "Penalty not halved after one half-life");
+  NS_TEST_EXPECT_MSG_EQ (m_damping.IsSuppressed (m_dst), true, "Reused above the reuse threshold");
+}
+
+void
+FlapDampingTestCase::CheckReuse ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_damping.IsSuppressed (m_dst), false, "Still suppressed after the reuse delay");
+  NS_TEST_EXPECT_MSG_EQ (m_damping.GetSize (), 1, "Destination forgotten before its penalty decayed");
+}
+
+// Zone graph: breadth first search up to the radius over symmetric links
+class ZoneGraphTestCase : public TestCase
+{
+public:
+  ZoneGraphTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ZoneGraphTestCase::ZoneGraphTestCase ()
+  : TestCase ("Shingo link-state zone graph")
+{
+}
+
+void
+ZoneGraphTestCase::DoRun (void)
+{
+  // Chain a - b - c - d, with e hearing b one way only
+  Ipv4Address a ("10.0.0.1"), b ("10.0.0.2"), c ("10.0.0.3"), d ("10.0.0.4"), e ("10.0.0.5");
+  std::set<Ipv4Address> na, nb, nc, ne;
+  na.insert (b);
+  nb.insert (a);
+  nb.insert (c);
+  nb.insert (e);
+  nc.insert (b);
+  nc.insert (d);
+  shingo::ZoneGraph graph;
+  Time expire = Seconds (10);
+  NS_TEST_EXPECT_MSG_EQ (graph.Update (a, 0, na, expire), true, "New node not reported as a change");
+  graph.Update (b, 1, nb, expire);
+  graph.Update (c, 1, nc, expire);
+  graph.Update (e, 1, ne, expire);
+  NS_TEST_EXPECT_MSG_EQ (graph.Update (c, 2, nc, expire), false, "Same neighbors reported as a change");
+  NS_TEST_EXPECT_MSG_EQ (graph.IsNewer (c, 2), false, "Old sequence number taken as newer");
+  NS_TEST_EXPECT_MSG_EQ (graph.IsNewer (c, 3), true, "New sequence number not taken as newer");
+  NS_TEST_EXPECT_MSG_EQ (graph.GetSeqNo (c), 2, "Wrong sequence number of c");
+  NS_TEST_EXPECT_MSG_EQ (graph.GetSeqNo (d), 0, "Sequence number of a node never heard");
+
+  std::map<Ipv4Address, shingo::ZoneRoute> routes;
+  graph.ComputeRoutes (a, 2, routes);
+  NS_TEST_EXPECT_MSG_EQ (routes.size (), 2, "Wrong zone size");
+  NS_TEST_EXPECT_MSG_EQ (routes[b].m_hops, 1, "Wrong hop count to b");
+  NS_TEST_EXPECT_MSG_EQ (routes[c].m_hops, 2, "Wrong hop count to c");
+  NS_TEST_EXPECT_MSG_EQ (routes[c].m_nextHop, b, "Wrong next hop to c");
+  NS_TEST_EXPECT_MSG_EQ (routes.count (e), 0, "Unidirectional link used");
+
+  // d has not advertised yet, the link from c is usable
+  graph.ComputeRoutes (a, 3, routes);
+  NS_TEST_EXPECT_MSG_EQ (routes[d].m_hops, 3, "Wrong hop count to d");
+  NS_TEST_EXPECT_MSG_EQ (routes[d].m_nextHop, b, "Wrong next hop to d");
+}
+
+// Query detection cache: relayers per query, forgotten after the lifetime
+class QueryDetectionTestCase : public TestCase
+{
+public:
+  QueryDetectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check that the records expired
+  void CheckExpired ();
+  /// Cache under test
+  shingo::QueryDetectionCache m_cache;
+};
+
+QueryDetectionTestCase::QueryDetectionTestCase ()
+  : TestCase ("Shingo query detection cache"),
+    m_cache (Seconds (1))
+{
+}
+
+void
+QueryDetectionTestCase::DoRun (void)
+{
+  Ipv4Address origin ("10.0.0.1"), a ("10.0.0.2"), b ("10.0.0.3");
+  m_cache.Record (origin, 1, a);
+  m_cache.Record (origin, 1, a);
+  m_cache.Record (origin, 1, b);
+  m_cache.Record (origin, 2, b);
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 2, "Wrong number of queries");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetRelayerCount (origin, 1), 2, "Relayer counted twice");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.HasRelayed (origin, 1, a), true, "Relayer not recorded");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.HasRelayed (origin, 2, a), false, "Relayer recorded for another query");
+  NS_TEST_EXPECT_MSG_EQ (m_cache.HasRelayed (a, 1, b), false, "Relayer recorded for another origin");
+  Simulator::Schedule (Seconds (2), &QueryDetectionTestCase::CheckExpired, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+QueryDetectionTestCase::CheckExpired ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_cache.GetSize (), 0, "Queries kept beyond the lifetime");
+}
+
+// Bordercast tree: serialization behind the RREQ
+class BordercastHeaderTestCase : public TestCase
+{
+public:
+  BordercastHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+BordercastHeaderTestCase::BordercastHeaderTestCase ()
+  : TestCase ("Shingo bordercast header")
+{
+}
+
+void
+BordercastHeaderTestCase::DoRun (void)
+{
+  Ipv4Address bordercaster ("10.0.0.1"), t1 ("10.0.0.5"), t2 ("10.0.0.6"), relay ("10.0.0.2");
+  shingo::BordercastHeader h (bordercaster, 1);
+  h.AddTarget (t1);
+  h.AddTarget (t2);
+  h.AddRelay (relay);
+  h.AddRelay (relay);
+  NS_TEST_EXPECT_MSG_EQ (h.GetSerializedSize (), 20, "Relay listed twice");
+
+  shingo::RreqHeader rreqHeader;
+  rreqHeader.SetBordercast (true);
+  rreqHeader.SetTtl (5);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (h);
+  p->AddHeader (rreqHeader);
+  shingo::RreqHeader rreqHeader2;
+  p->RemoveHeader (rreqHeader2);
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetBordercast (), true, "Bordercast flag lost");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) rreqHeader2.GetTtl (), 5, "TTL lost");
+  shingo::BordercastHeader h2;
+  p->RemoveHeader (h2);
+  NS_TEST_EXPECT_MSG_EQ (h2.GetBordercaster (), bordercaster, "Wrong bordercaster");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) h2.GetHopsLeft (), 1, "Wrong hops left");
+  NS_TEST_EXPECT_MSG_EQ (h2.GetTargets ().size (), 2, "Wrong number of targets");
+  NS_TEST_EXPECT_MSG_EQ (h2.IsTarget (t2), true, "Target lost");
+  NS_TEST_EXPECT_MSG_EQ (h2.IsRelay (relay), true, "Relay lost");
+  NS_TEST_EXPECT_MSG_EQ (h2.IsRelay (t1), false, "Target taken as relay");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+}
+
+// Multi-destination RREQ: the destinations besides the main one and their flags
+class MultiDestinationRreqTestCase : public TestCase
+{
+public:
+  MultiDestinationRreqTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MultiDestinationRreqTestCase::MultiDestinationRreqTestCase ()
+  : TestCase ("Shingo multi-destination RREQ")
+{
+}
+
+void
+MultiDestinationRreqTestCase::DoRun (void)
+{
+  shingo::RreqHeader rreqHeader (/*flags=*/ 0, /*reserved=*/ 0, /*hopCount=*/ 0, /*requestID=*/ 1, Ipv4Address ("10.0.0.5"));
+  rreqHeader.SetMprFlood (true);
+  rreqHeader.SetFirstHop (Ipv4Address ("10.0.0.9"));
+  rreqHeader.AddDestination (Ipv4Address ("10.0.0.6"), 7, false, false);
+  rreqHeader.AddDestination (Ipv4Address ("10.0.0.7"), 0, true, true);
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader.GetSerializedSize (), 29 + 4 + 2 * 12, "Wrong size");
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (rreqHeader);
+  shingo::RreqHeader rreqHeader2;
+  p->RemoveHeader (rreqHeader2);
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2 == rreqHeader, true, "RREQ changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetMprFlood (), true, "Multipoint relay flag lost");
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetFirstHop (), Ipv4Address ("10.0.0.9"), "First hop lost");
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetDestinations ()[0].m_dstSeqNo, 7, "Wrong sequence number");
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetDestinations ()[1].m_destinationOnly, true, "Destination only flag lost");
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader2.GetDestinations ()[1].m_unknownSeqNo, true, "Unknown sequence number flag lost");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+
+  // A single destination RREQ keeps the plain format
+  rreqHeader.SetDestinations (std::vector<shingo::RreqHeader::Destination> ());
+  NS_TEST_EXPECT_MSG_EQ (rreqHeader.GetSerializedSize (), 29, "Destination list sent when empty");
+}
+
+// Multipoint relays: sole coverers first, then the greedy choice
+class MprSelectionTestCase : public TestCase
+{
+public:
+  MprSelectionTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MprSelectionTestCase::MprSelectionTestCase ()
+  : TestCase ("Shingo multipoint relay selection")
+{
+}
+
+void
+MprSelectionTestCase::DoRun (void)
+{
+  Ipv4Address a ("10.0.0.2"), b ("10.0.0.3"), c ("10.0.0.4"), x ("10.0.0.5"), y ("10.0.0.6"), z ("10.0.0.7");
+  std::set<Ipv4Address> neighbors;
+  neighbors.insert (a);
+  neighbors.insert (b);
+  neighbors.insert (c);
+  std::map<Ipv4Address, Ipv4Address> twoHops;
+  twoHops[x] = a;
+  twoHops[y] = b;
+  twoHops[z] = c;
+  shingo::MprSelection selection;
+  Time expire = Seconds (10);
+  selection.AddLink (b, x, expire);
+  selection.AddLink (b, y, expire);
+  selection.AddLink (c, z, expire);
+  std::set<Ipv4Address> mprs = selection.Compute (neighbors, twoHops);
+  NS_TEST_EXPECT_MSG_EQ (mprs.size (), 2, "Wrong number of relays");
+  NS_TEST_EXPECT_MSG_EQ (mprs.count (b), 1, "Relay covering x and y not selected");
+  NS_TEST_EXPECT_MSG_EQ (mprs.count (c), 1, "Sole relay to z not selected");
+
+  // b no longer hears x: only a reaches it
+  selection.RemoveLink (b, x);
+  mprs = selection.Compute (neighbors, twoHops);
+  NS_TEST_EXPECT_MSG_EQ (mprs.size (), 3, "Selection not updated on a lost link");
+  NS_TEST_EXPECT_MSG_EQ (mprs.count (a), 1, "Sole relay to x not selected");
+
+  // A two-hop node that became a neighbor needs no relay
+  neighbors.insert (z);
+  mprs = selection.Compute (neighbors, twoHops);
+  NS_TEST_EXPECT_MSG_EQ (mprs.count (c), 0, "Relay selected for a neighbor");
+}
+
+// Destination popularity: decayed counts ranked against the cache size
+class PopularityTestCase : public TestCase
+{
+public:
+  PopularityTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the scores after one half-life
+  void CheckHalfLife ();
+
+  shingo::DestinationPopularity m_popularity;
+  Ipv4Address m_sink;
+  Ipv4Address m_other;
+};
+
+PopularityTestCase::PopularityTestCase ()
+  : TestCase ("Shingo destination popularity"),
+    m_popularity (Seconds (30), 1, 3),
+    m_sink ("10.0.0.1"),
+    m_other ("10.0.0.2")
+{
+}
+
+void
+PopularityTestCase::DoRun (void)
+{
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_popularity.Record (m_sink);
+    }
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      m_popularity.Record (m_other);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_popularity.IsHot (m_sink), true, "Most popular destination not hot");
+  NS_TEST_EXPECT_MSG_EQ (m_popularity.GetRank (m_other), 1, "Wrong rank");
+  NS_TEST_EXPECT_MSG_EQ (m_popularity.IsHot (m_other), false, "Hot beyond the cache size");
+  Simulator::Schedule (Seconds (30), &PopularityTestCase::CheckHalfLife, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+PopularityTestCase::CheckHalfLife ()
+{
+  NS_TEST_EXPECT_MSG_EQ_TOL (m_popularity.GetScore (m_sink), 2, 1e-6, "Score not halved after one half-life");
+  NS_TEST_EXPECT_MSG_EQ (m_popularity.IsHot (m_sink), false, "Hot below the threshold");
+}
+
+// Discovery merging: RREQs held behind a discovery in flight, answered or released
+class DiscoveryMergeTestCase : public TestCase
+{
+public:
+  DiscoveryMergeTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the release once the discovery expired
+  void CheckRelease ();
+
+  shingo::DiscoveryMerge m_merge;
+  Ipv4Address m_dst;
+};
+
+DiscoveryMergeTestCase::DiscoveryMergeTestCase ()
+  : TestCase ("Shingo discovery merging"),
+    m_dst ("10.0.0.1")
+{
+}
+
+void
+DiscoveryMergeTestCase::DoRun (void)
+{
+  shingo::RreqHeader first (0, 0, 0, 1, m_dst, 0, Ipv4Address ("10.0.0.10"));
+  first.SetTtl (6);
+  first.SetUnknownSeqno (true);
+  m_merge.Record (first, Seconds (1));
+
+  shingo::RreqHeader retry = first;
+  retry.SetId (2);
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Hold (retry), false, "Retry of the same origin held");
+  shingo::RreqHeader wider (0, 0, 0, 1, m_dst, 0, Ipv4Address ("10.0.0.11"));
+  wider.SetTtl (8);
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Hold (wider), false, "RREQ for a wider ring held");
+  shingo::RreqHeader fresh (0, 0, 0, 1, m_dst, 5, Ipv4Address ("10.0.0.12"));
+  fresh.SetTtl (4);
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Hold (fresh), true, "RREQ not held");
+  shingo::RreqHeader stale (0, 0, 0, 1, m_dst, 9, Ipv4Address ("10.0.0.13"));
+  stale.SetTtl (4);
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Hold (stale), true, "RREQ not held");
+
+  std::vector<shingo::RreqHeader> answered = m_merge.TakeAnswered (m_dst, 7);
+  NS_TEST_EXPECT_MSG_EQ (answered.size (), 1, "Wrong number of RREQs answered");
+  NS_TEST_EXPECT_MSG_EQ (answered.front ().GetOrigin (), Ipv4Address ("10.0.0.12"), "Wrong RREQ answered");
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Hold (fresh), false, "RREQ held after the RREP");
+  NS_TEST_EXPECT_MSG_EQ (m_merge.Release (m_dst).size (), 0, "Released before the discovery expired");
+  Simulator::Schedule (Seconds (1), &DiscoveryMergeTestCase::CheckRelease, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+DiscoveryMergeTestCase::CheckRelease ()
+{
+  std::vector<shingo::RreqHeader> released = m_merge.Release (m_dst);
+  NS_TEST_EXPECT_MSG_EQ (released.size (), 1, "RREQ too fresh for the RREP not released");
+  NS_TEST_EXPECT_MSG_EQ (m_merge.GetSize (), 0, "Discovery kept after the release");
+}
+
+// Route error: every destination of a link break in one message
+class RerrHeaderTestCase : public TestCase
+{
+public:
+  RerrHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RerrHeaderTestCase::RerrHeaderTestCase ()
+  : TestCase ("Shingo RERR header")
+{
+}
+
+void
+RerrHeaderTestCase::DoRun (void)
+{
+  shingo::RerrHeader rerrHeader;
+  rerrHeader.SetNoDelete (true);
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader.AddUnDestination (Ipv4Address ("10.0.0.6"), 7), true, "Destination refused");
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader.AddUnDestination (Ipv4Address ("10.0.0.7"), 3), true, "Destination refused");
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader.AddUnDestination (Ipv4Address ("10.0.0.7"), 3), true, "Duplicate refused");
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader.GetDestCount (), 2, "Duplicate destination added");
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader.GetSerializedSize (), 3 + 2 * 8, "Wrong size");
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (rerrHeader);
+  shingo::RerrHeader rerrHeader2;
+  p->RemoveHeader (rerrHeader2);
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader2 == rerrHeader, true, "RERR changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader2.GetNoDelete (), true, "No delete flag lost");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+
+  std::pair<Ipv4Address, uint32_t> un;
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader2.RemoveUnDestination (un), true, "No destination to remove");
+  NS_TEST_EXPECT_MSG_EQ (un.first, Ipv4Address ("10.0.0.6"), "Wrong destination removed");
+  NS_TEST_EXPECT_MSG_EQ (un.second, 7, "Wrong sequence number");
+  rerrHeader2.Clear ();
+  NS_TEST_EXPECT_MSG_EQ (rerrHeader2.RemoveUnDestination (un), false, "Destination left after clear");
+}
+
+// Unidirectional link blacklist: timeouts and clearing
+class LinkBlacklistTestCase : public TestCase
+{
+public:
+  LinkBlacklistTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Check the blacklist after the first timeout
+  void CheckExpired ();
+  /// Blacklist under test
+  shingo::LinkBlacklist m_blacklist;
+};
+
+LinkBlacklistTestCase::LinkBlacklistTestCase ()
+  : TestCase ("Shingo unidirectional link blacklist")
+{
+}
+
+void
+LinkBlacklistTestCase::DoRun (void)
+{
+  Ipv4Address a ("10.0.0.1"), b ("10.0.0.2"), c ("10.0.0.3");
+  m_blacklist.Insert (a, Seconds (1));
+  m_blacklist.Insert (b, Seconds (3));
+  m_blacklist.Insert (b, Seconds (1));
+  m_blacklist.Insert (c, Seconds (3));
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.GetSize (), 3, "Wrong number of neighbors");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.IsBlacklisted (a), true, "Neighbor not blacklisted");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.Remove (c), true, "Neighbor not cleared");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.IsBlacklisted (c), false, "Cleared neighbor still blacklisted");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.Remove (c), false, "Neighbor cleared twice");
+  Simulator::Schedule (Seconds (2), &LinkBlacklistTestCase::CheckExpired, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+LinkBlacklistTestCase::CheckExpired ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.IsBlacklisted (Ipv4Address ("10.0.0.1")), false, "Neighbor kept beyond its timeout");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.IsBlacklisted (Ipv4Address ("10.0.0.2")), true, "Timeout shortened by a later insert");
+  NS_TEST_EXPECT_MSG_EQ (m_blacklist.GetSize (), 1, "Wrong number of neighbors");
+}
+
+// Link quality: delivery ratio against the hello intervals, ETX cost
+class LinkQualityTestCase : public TestCase
+{
+public:
+  LinkQualityTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /// Hear a broadcast from a neighbor
+  void Hear (Ipv4Address neighbor);
+  /// Check the links once the window is full
+  void CheckCosts ();
+  /// Link quality under test
+  shingo::LinkQuality m_linkQuality;
+};
+
+LinkQualityTestCase::LinkQualityTestCase ()
+  : TestCase ("Shingo link quality")
+{
+}
+
+void
+LinkQualityTestCase::DoRun (void)
+{
+  // a is heard every hello interval, twice within the same one sometimes; b every other interval
+  for (uint32_t t = 0; t <= 10; ++t)
+    {
+      Simulator::Schedule (Seconds (t), &LinkQualityTestCase::Hear, this, Ipv4Address ("10.0.0.1"));
+      Simulator::Schedule (Seconds (t + 0.1), &LinkQualityTestCase::Hear, this, Ipv4Address ("10.0.0.1"));
+      if (t % 2 == 0)
+        {
+          Simulator::Schedule (Seconds (t), &LinkQualityTestCase::Hear, this, Ipv4Address ("10.0.0.2"));
+        }
+    }
+  Simulator::Schedule (Seconds (10.5), &LinkQualityTestCase::CheckCosts, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_EXPECT_MSG_EQ (shingo::LinkQuality::Accumulate (0xfff0, 400), 0xffff, "Path metric wrapped around");
+}
+
+void
+LinkQualityTestCase::Hear (Ipv4Address neighbor)
+{
+  m_linkQuality.Receive (neighbor, Seconds (1));
+}
+
+void
+LinkQualityTestCase::CheckCosts ()
+{
+  NS_TEST_EXPECT_MSG_EQ (m_linkQuality.GetLinkCost (Ipv4Address ("10.0.0.1")), 100, "Perfect link penalized");
+  NS_TEST_EXPECT_MSG_EQ (m_linkQuality.GetLinkCost (Ipv4Address ("10.0.0.2")), 400, "Wrong ETX of a half lossy link");
+  NS_TEST_EXPECT_MSG_EQ (m_linkQuality.GetLinkCost (Ipv4Address ("10.0.0.3")), 100, "Unknown neighbor penalized");
+  m_linkQuality.Remove (Ipv4Address ("10.0.0.2"));
+  NS_TEST_EXPECT_MSG_EQ (m_linkQuality.GetSize (), 1, "Lost neighbor kept");
+}
+
+// Link expiration: nodes on straight lines leave the range when predicted
+class LinkExpirationTestCase : public TestCase
+{
+public:
+  LinkExpirationTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LinkExpirationTestCase::LinkExpirationTestCase ()
+  : TestCase ("Shingo link expiration prediction")
+{
+}
+
+void
+LinkExpirationTestCase::DoRun (void)
+{
+  Vector still (0, 0, 0);
+  NS_TEST_EXPECT_MSG_EQ (shingo::LinkExpiration::Predict (still, still, Vector (50, 0, 0), Vector (10, 0, 0), 100),
+                         Seconds (5), "Wrong break of a neighbor moving away");
+  NS_TEST_EXPECT_MSG_EQ (shingo::LinkExpiration::Predict (still, Vector (5, 0, 0), Vector (50, 0, 0), Vector (-5, 0, 0), 100),
+                         Seconds (15), "Break predicted before the nodes passed each other");
+  NS_TEST_EXPECT_MSG_EQ (shingo::LinkExpiration::Predict (still, Vector (3, 4, 0), Vector (50, 0, 0), Vector (3, 4, 0), 100),
+                         Time::Max (), "Break predicted between nodes moving together");
+
+  shingo::LinkExpiration linkExpiration (100);
+  linkExpiration.Update (Ipv4Address ("10.0.0.1"), Vector (0, 60, 0), Vector (0, 8, 0));
+  NS_TEST_EXPECT_MSG_EQ (linkExpiration.GetExpirationTime (Ipv4Address ("10.0.0.1"), still, still), Seconds (5),
+                         "Wrong break of a known neighbor");
+  NS_TEST_EXPECT_MSG_EQ (linkExpiration.GetExpirationTime (Ipv4Address ("10.0.0.2"), still, still), Time::Max (),
+                         "Break predicted for an unknown neighbor");
+
+  // The hellos advertise the motion to the centimeter
+  shingo::PositionHeader h (Vector (12.34, -56.78, 9), Vector (-1.5, 20, 0));
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (h);
+  shingo::PositionHeader h2;
+  p->RemoveHeader (h2);
+  NS_TEST_EXPECT_MSG_EQ_TOL (h2.GetPosition ().y, -56.78, 0.01, "Position changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ_TOL (h2.GetVelocity ().x, -1.5, 0.01, "Velocity changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+}
+
+// Link disjoint paths, flows spread over them and failover
+class MultipathTestCase : public TestCase
+{
+public:
+  MultipathTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+MultipathTestCase::MultipathTestCase ()
+  : TestCase ("Shingo multipath table")
+{
+}
+
+void
+MultipathTestCase::DoRun (void)
+{
+  Ipv4Address dst ("10.0.0.1");
+  Ipv4Address a ("10.0.0.2");
+  Ipv4Address b ("10.0.0.3");
+  Ipv4Address c ("10.0.0.4");
+  shingo::MultipathTable table (3);
+  table.SetPrimary (dst, a, Ipv4Address ("10.0.1.1"));
+  shingo::MultipathTable::Path path;
+  path.m_nextHop = a;
+  path.m_lastHop = Ipv4Address ("10.0.1.2");
+  path.m_hops = 3;
+  path.m_metric = 300;
+  path.m_expire = Seconds (10);
+  NS_TEST_EXPECT_MSG_EQ (table.AddPath (dst, path), false, "Path kept through the next hop of the primary path");
+  path.m_nextHop = b;
+  path.m_lastHop = Ipv4Address ("10.0.1.1");
+  NS_TEST_EXPECT_MSG_EQ (table.AddPath (dst, path), false, "Path kept through the last hop of the primary path");
+  path.m_lastHop = Ipv4Address ("10.0.1.2");
+  NS_TEST_EXPECT_MSG_EQ (table.AddPath (dst, path), true, "Disjoint path dropped");
+  path.m_nextHop = c;
+  path.m_lastHop = Ipv4Address ("10.0.1.3");
+  path.m_metric = 320;
+  NS_TEST_EXPECT_MSG_EQ (table.AddPath (dst, path), true, "Disjoint path dropped");
+  path.m_nextHop = Ipv4Address ("10.0.0.5");
+  path.m_lastHop = Ipv4Address ("10.0.1.4");
+  path.m_metric = 400;
+  NS_TEST_EXPECT_MSG_EQ (table.AddPath (dst, path), false, "Worst path kept beyond the maximum");
+  NS_TEST_EXPECT_MSG_EQ (table.GetPathCount (dst), 2, "Wrong number of paths");
+
+  // A flow sticks to its path, the flows spread over all of them
+  std::map<Ipv4Address, uint32_t> load;
+  for (uint32_t flow = 0; flow < 300; ++flow)
+    {
+      Ipv4Address nextHop = table.Select (dst, a, flow);
+      NS_TEST_EXPECT_MSG_EQ (table.Select (dst, a, flow), nextHop, "Flow moved between paths");
+      load[nextHop]++;
+    }
+  NS_TEST_EXPECT_MSG_EQ (load.size (), 3, "Flows not spread over every path");
+  uint32_t flowOverC = 0;
+  while (flowOverC < 300 && table.Select (dst, a, flowOverC) != c)
+    {
+      ++flowOverC;
+    }
+
+  // The flows of a lost neighbor move, the others stay
+  table.RemoveNextHop (b);
+  NS_TEST_EXPECT_MSG_EQ (table.GetPathCount (dst), 1, "Path through a lost neighbor kept");
+  NS_TEST_EXPECT_MSG_EQ (table.Select (dst, a, flowOverC), c, "Flow moved off a path still there");
+  NS_TEST_EXPECT_MSG_EQ (table.TakeBestPath (dst, path), true, "No path to fail over to");
+  NS_TEST_EXPECT_MSG_EQ (path.m_nextHop, c, "Wrong path to fail over to");
+  NS_TEST_EXPECT_MSG_EQ (table.TakeBestPath (dst, path), false, "Path failed over to twice");
+
+  path.m_nextHop = b;
+  path.m_lastHop = Ipv4Address ("10.0.1.2");
+  path.m_expire = Seconds (-1);
+  table.AddPath (dst, path);
+  NS_TEST_EXPECT_MSG_EQ (table.GetPathCount (dst), 0, "Expired path kept");
+}
+
+// IARP update: hold time and load of the sender
+class IarpUpdateHeaderTestCase : public TestCase
+{
+public:
+  IarpUpdateHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IarpUpdateHeaderTestCase::IarpUpdateHeaderTestCase ()
+  : TestCase ("Shingo IARP update header")
+{
+}
+
+void
+IarpUpdateHeaderTestCase::DoRun (void)
+{
+  shingo::IarpUpdateHeader updateHeader (MilliSeconds (7500), 200);
+  NS_TEST_EXPECT_MSG_EQ (updateHeader.GetSerializedSize (), 8, "Wrong size");
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (updateHeader);
+  shingo::IarpUpdateHeader updateHeader2;
+  p->RemoveHeader (updateHeader2);
+  NS_TEST_EXPECT_MSG_EQ (updateHeader2.GetHoldTime (), MilliSeconds (7500), "Hold time changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (updateHeader2.GetLoad ()), 200, "Load changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+
+  updateHeader2.SetLoad (0);
+  NS_TEST_EXPECT_MSG_EQ (uint32_t (updateHeader2.GetLoad ()), 0, "Load not set");
+}
+
+// Hello interval: halved on churn, doubled when stable, skipped after another broadcast
+class HelloScheduleTestCase : public TestCase
+{
+public:
+  HelloScheduleTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+HelloScheduleTestCase::HelloScheduleTestCase ()
+  : TestCase ("Shingo hello interval adaptation")
+{
+}
+
+void
+HelloScheduleTestCase::DoRun (void)
+{
+  shingo::HelloSchedule schedule (Seconds (1), MilliSeconds (400), Seconds (3), 2, 2);
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetLifetime (), Seconds (2), "Lifetime is the allowed loss times the interval");
+
+  // Below the churn threshold the interval stays
+  schedule.RecordChange ();
+  NS_TEST_EXPECT_MSG_EQ (schedule.Adapt (), false, "Interval grew on little churn");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), Seconds (1), "Interval changed on little churn");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetChanges (), 0, "Changes not restarted");
+
+  // Churn halves the interval down to the minimum
+  schedule.RecordChange ();
+  schedule.RecordChange ();
+  NS_TEST_EXPECT_MSG_EQ (schedule.Adapt (), false, "Interval grew on churn");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), MilliSeconds (500), "Interval not halved");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetLifetime (), Seconds (1), "Lifetime does not follow the interval");
+  schedule.RecordChange ();
+  schedule.RecordChange ();
+  schedule.RecordChange ();
+  schedule.Adapt ();
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), MilliSeconds (400), "Interval below the minimum");
+
+  // A stable neighborhood doubles it up to the maximum
+  NS_TEST_EXPECT_MSG_EQ (schedule.Adapt (), true, "Interval did not grow when stable");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), MilliSeconds (800), "Interval not doubled");
+  schedule.Adapt ();
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), MilliSeconds (1600), "Interval not doubled");
+  NS_TEST_EXPECT_MSG_EQ (schedule.Adapt (), true, "Interval did not grow to the maximum");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), Seconds (3), "Interval above the maximum");
+  NS_TEST_EXPECT_MSG_EQ (schedule.Adapt (), false, "Interval grew past the maximum");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetInterval (), Seconds (3), "Interval above the maximum");
+
+  // A broadcast less than one interval ago stands in for the hello
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetSuppressDelay (Seconds (10), Seconds (11), false), Seconds (2), "Hello not skipped");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetSuppressDelay (Seconds (10), Seconds (13), false), Seconds (0), "Hello skipped after one interval");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetSuppressDelay (Seconds (0), Seconds (1), false), Seconds (0), "Hello skipped without any broadcast");
+  NS_TEST_EXPECT_MSG_EQ (schedule.GetSuppressDelay (Seconds (10), Seconds (11), true), Seconds (0), "Urgent hello skipped");
+}
+
+// Zone radius: shrinks on IARP load, grows on RREQ load, within its bounds
+class ZoneRadiusTestCase : public TestCase
+{
+public:
+  ZoneRadiusTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+ZoneRadiusTestCase::ZoneRadiusTestCase ()
+  : TestCase ("Shingo zone radius adaptation")
+{
+}
+
+void
+ZoneRadiusTestCase::DoRun (void)
+{
+  shingo::ZoneRadiusAdaptation adaptation (1, 3, 2.0);
+
+  // Within the ratio the radius stays
+  adaptation.RecordIarp (1500);
+  adaptation.RecordRreq (1000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (2), 2, "Radius changed within the ratio");
+  NS_TEST_EXPECT_MSG_EQ (adaptation.GetIarpBytes (), 0, "IARP bytes not restarted");
+  NS_TEST_EXPECT_MSG_EQ (adaptation.GetRreqBytes (), 0, "RREQ bytes not restarted");
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (2), 2, "Radius changed without any load");
+
+  // IARP load shrinks the radius down to the minimum
+  adaptation.RecordIarp (2001);
+  adaptation.RecordRreq (1000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (2), 1, "Radius not shrunk on IARP load");
+  adaptation.RecordIarp (5000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (1), 1, "Radius below the minimum");
+
+  // RREQ load grows it up to the maximum
+  adaptation.RecordRreq (2001);
+  adaptation.RecordIarp (1000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (2), 3, "Radius not grown on RREQ load");
+  adaptation.RecordRreq (5000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (3), 3, "Radius above the maximum");
+
+  // Pure reactive routing is the floor when the minimum radius is 0
+  adaptation.SetMinRadius (0);
+  adaptation.RecordIarp (5000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (1), 0, "Radius not shrunk to 0");
+  adaptation.RecordIarp (5000);
+  NS_TEST_EXPECT_MSG_EQ (adaptation.Adapt (0), 0, "Radius 0 did not stay at 0");
+
+  // Shrinking the zone drops the members beyond the new radius
+  shingo::RoutingTable table;
+  for (uint32_t hops = 1; hops <= 3; ++hops)
+    {
+      // 10.0.0.<hops>
+      shingo::RoutingTableEntry rt (/*device=*/ 0, /*dst=*/ Ipv4Address (0x0a000000 + hops), /*seqno=*/ 0,
+                                    /*iface=*/ Ipv4InterfaceAddress (), /*hops=*/ hops, /*next hop=*/ Ipv4Address ("10.0.0.1"));
+      rt.SetFlag (shingo::VALID);
+      table.AddRoute (rt);
+    }
+  table.DeleteRoutesBeyond (2);
+  shingo::RoutingTableEntry rt;
+  NS_TEST_EXPECT_MSG_EQ (table.RoutingTableSize (), 2, "Wrong number of members kept");
+  NS_TEST_EXPECT_MSG_EQ (table.LookupRoute (Ipv4Address ("10.0.0.2"), rt), true, "Member within the radius dropped");
+  NS_TEST_EXPECT_MSG_EQ (table.LookupRoute (Ipv4Address ("10.0.0.3"), rt), false, "Member beyond the radius kept");
+  table.DeleteRoutesBeyond (0);
+  NS_TEST_EXPECT_MSG_EQ (table.RoutingTableSize (), 0, "Members kept at radius 0");
+}
+
+// IARP entry: RecvIarp walks the entries 12 bytes at a time
+class IarpHeaderTestCase : public TestCase
+{
+public:
+  IarpHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+IarpHeaderTestCase::IarpHeaderTestCase ()
+  : TestCase ("Shingo IARP entry header")
+{
+}
+
+void
+IarpHeaderTestCase::DoRun (void)
+{
+  shingo::IarpHeader iarpHeader (Ipv4Address ("10.0.0.7"), 3, 42, 700);
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader.GetSerializedSize (), 12, "Wrong size");
+
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (iarpHeader);
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 12, "Wrong serialized size");
+  shingo::IarpHeader iarpHeader2;
+  p->RemoveHeader (iarpHeader2);
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetDst (), Ipv4Address ("10.0.0.7"), "Destination changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetHopCount (), 3, "Hop count changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetDstSeqno (), 42, "Sequence number changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetMetric (), 700, "Metric changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 0, "Unexpected bytes left");
+
+  // The hop count is 16 bits on the wire
+  shingo::IarpHeader farHeader (Ipv4Address ("10.0.0.8"), 65535, 1, 65535);
+  p->AddHeader (farHeader);
+  p->RemoveHeader (iarpHeader2);
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetHopCount (), 65535, "Largest hop count changed by the serialization");
+  NS_TEST_EXPECT_MSG_EQ (iarpHeader2.GetMetric (), 65535, "Largest metric changed by the serialization");
+}
+
+// Type header: every message type is dispatched on its first byte
+class TypeHeaderTestCase : public TestCase
+{
+public:
+  TypeHeaderTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TypeHeaderTestCase::TypeHeaderTestCase ()
+  : TestCase ("Shingo type header")
+{
+}
+
+void
+TypeHeaderTestCase::DoRun (void)
+{
+  shingo::MessageType types[] = { shingo::SHINGO_IARP, shingo::SHINGO_RREQ, shingo::SHINGO_RREP,
+                                  shingo::SHINGO_RREP_ACK, shingo::SHINGO_ZONE_SOLICIT, shingo::SHINGO_NEIGHBOR_SET,
+                                  shingo::SHINGO_SINK_BEACON, shingo::SHINGO_RERR };
+  for (uint32_t t = 0; t < sizeof (types) / sizeof (types[0]); ++t)
+    {
+      shingo::TypeHeader tHeader (types[t]);
+      NS_TEST_EXPECT_MSG_EQ (tHeader.GetSerializedSize (), 1, "Wrong size");
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (tHeader);
+      shingo::TypeHeader tHeader2 (shingo::SHINGO_RREQ);
+      p->RemoveHeader (tHeader2);
+      NS_TEST_EXPECT_MSG_EQ (tHeader2.IsValid (), true, "Type " << uint32_t (types[t]) << " not valid");
+      NS_TEST_EXPECT_MSG_EQ (tHeader2.Get (), types[t], "Type changed by the serialization");
+      NS_TEST_EXPECT_MSG_EQ (tHeader2 == tHeader, true, "Headers differ");
+    }
+
+  // A type no sender uses is refused
+  shingo::TypeHeader unknown ((shingo::MessageType) 9);
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (unknown);
+  shingo::TypeHeader tHeader3;
+  p->RemoveHeader (tHeader3);
+  NS_TEST_EXPECT_MSG_EQ (tHeader3.IsValid (), false, "Unknown type accepted");
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +979,24 @@ ShingoTestSuite::ShingoTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new ShingoTestCase1, TestCase::QUICK);
+  AddTestCase (new FlapDampingTestCase, TestCase::QUICK);
+  AddTestCase (new ZoneGraphTestCase, TestCase::QUICK);
+  AddTestCase (new QueryDetectionTestCase, TestCase::QUICK);
+  AddTestCase (new BordercastHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new MultiDestinationRreqTestCase, TestCase::QUICK);
+  AddTestCase (new MprSelectionTestCase, TestCase::QUICK);
+  AddTestCase (new PopularityTestCase, TestCase::QUICK);
+  AddTestCase (new DiscoveryMergeTestCase, TestCase::QUICK);
+  AddTestCase (new RerrHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new LinkBlacklistTestCase, TestCase::QUICK);
+  AddTestCase (new LinkQualityTestCase, TestCase::QUICK);
+  AddTestCase (new LinkExpirationTestCase, TestCase::QUICK);
+  AddTestCase (new MultipathTestCase, TestCase::QUICK);
+  AddTestCase (new IarpUpdateHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new IarpHeaderTestCase, TestCase::QUICK);
+  AddTestCase (new HelloScheduleTestCase, TestCase::QUICK);
+  AddTestCase (new ZoneRadiusTestCase, TestCase::QUICK);
+  AddTestCase (new TypeHeaderTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite